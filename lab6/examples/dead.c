@@ -0,0 +1,42 @@
+/* dead.c */
+
+int printf(char *s, ...);
+
+int dead(void)
+{
+    printf("dead\n");
+    return 0;
+}
+
+int count(int n)
+{
+    int i;
+
+    i = 0;
+
+    while (i < n) {
+	i = i + 1;
+	break;
+	dead();
+    }
+
+    if (0)
+	dead();
+    else
+	printf("%d\n", i);
+
+    if (1)
+	printf("%d\n", n);
+    else
+	dead();
+
+    return i;
+    dead();
+    i = i + n;
+}
+
+int main(void)
+{
+    printf("%d\n", count(10));
+    return 0;
+}
@@ -0,0 +1,52 @@
+/* nan.c */
+
+int printf(char *s, ...);
+
+double zero(void)
+{
+    return 0.0;
+}
+
+int main(void)
+{
+    double x, y, z;
+    int n;
+
+    z = zero();
+    x = z / z;
+    y = 1.0;
+
+    printf("%d %d %d %d %d %d %d\n", x != x, x == x, x < y, x <= y, x > y, x >= y, !x);
+    printf("%d %d %d %d\n", y < x, y <= x, y > x, y >= x);
+    printf("%d %d %d %d\n", y != y, y == y, !y, !z);
+
+    n = 0;
+    if (x != x) n = n + 1;
+    if (x == x) n = n + 10;
+    if (x < y) n = n + 100;
+    if (x <= y) n = n + 1000;
+    if (x > y) n = n + 10000;
+    if (x >= y) n = n + 100000;
+    if (x) n = n + 1000000;
+    printf("%d\n", n);
+
+    n = 0;
+    if (!(x != x)) n = n + 1;
+    if (!(x == x)) n = n + 10;
+    if (!(x < y)) n = n + 100;
+    if (!(x <= y)) n = n + 1000;
+    if (!(x > y)) n = n + 10000;
+    if (!(x >= y)) n = n + 100000;
+    if (!x) n = n + 1000000;
+    printf("%d\n", n);
+
+    n = 0;
+    while (x < y && n < 5) n = n + 1;
+    while (x == x && n < 10) n = n + 1;
+    while (!(x != x) && n < 20) n = n + 1;
+    printf("%d\n", n);
+
+    n = (x == x || x != x) + 2 * (x < y || y < x) + 4 * (x != x && y == y);
+    printf("%d\n", n);
+    return 0;
+}
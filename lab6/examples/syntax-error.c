@@ -0,0 +1,15 @@
+int f(void)
+{
+    return 1;
+}
+
+int g(void)
+{
+    int x;
+
+    x = f();
+    return x;
+}
+
+int h( {
+}
@@ -0,0 +1,180 @@
+/*
+ * File:	Arena.cpp
+ *
+ * Description:	This file contains the member function definitions for
+ *		arenas.
+ *
+ *		Memory is obtained in fixed-size blocks, and allocations
+ *		larger than a block get a block of their own.  Resetting an
+ *		arena destroys its objects in the reverse order of their
+ *		allocation, frees any large blocks, and keeps the others
+ *		for reuse, so an arena only ever grows to the size needed
+ *		for the largest function.
+ */
+
+# include <cstdlib>
+# include <new>
+# include "Arena.h"
+
+using namespace std;
+
+static const size_t BLOCK_SIZE = 1 << 16;
+static const size_t ALIGNMENT = alignof(max_align_t);
+
+Arena Arena::global;
+Arena *Arena::current = &Arena::global;
+thread_local Arena *Arena::Object::_pending = nullptr;
+
+
+/*
+ * Function:	Arena::Object::operator new
+ *
+ * Description:	Allocate an object from the current arena.
+ */
+
+void *Arena::Object::operator new(size_t size)
+{
+    return operator new(size, *current);
+}
+
+
+/*
+ * Function:	Arena::Object::operator new
+ *
+ * Description:	Allocate an object from the given arena, which becomes
+ *		responsible for destroying it.  The object is registered
+ *		with the arena once it is being constructed, since only
+ *		then is the address of its Object part known.
+ */
+
+void *Arena::Object::operator new(size_t size, Arena &arena)
+{
+    void *ptr = arena.allocate(size);
+
+    _pending = &arena;
+    return ptr;
+}
+
+
+/*
+ * Function:	Arena::Object::Object (constructor)
+ *
+ * Description:	Initialize this object, registering it with the arena
+ *		from which it was just allocated, if any.  Objects that
+ *		are not allocated from an arena are not registered.
+ */
+
+Arena::Object::Object()
+{
+    if (_pending != nullptr) {
+	_pending->_objects.push_back(this);
+	_pending = nullptr;
+    }
+}
+
+
+/*
+ * Function:	Arena::Object::Object (copy constructor)
+ *
+ * Description:	Initialize this object as a copy of another, which only
+ *		requires registering it like any other object.
+ */
+
+Arena::Object::Object(const Object &that)
+    : Object()
+{
+}
+
+
+/*
+ * Function:	Arena::Arena (constructor)
+ *
+ * Description:	Initialize this arena.  No memory is obtained until the
+ *		first allocation.
+ */
+
+Arena::Arena()
+    : _block(0), _next(nullptr), _limit(nullptr)
+{
+}
+
+
+/*
+ * Function:	Arena::~Arena (destructor)
+ *
+ * Description:	Destroy all objects in this arena and free its memory.
+ */
+
+Arena::~Arena()
+{
+    reset();
+
+    for (auto block : _blocks)
+	free(block);
+}
+
+
+/*
+ * Function:	Arena::allocate
+ *
+ * Description:	Allocate the given number of bytes, suitably aligned for
+ *		any object.
+ */
+
+void *Arena::allocate(size_t size)
+{
+    char *ptr;
+
+
+    size = (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+
+    if (size > BLOCK_SIZE) {
+	if ((ptr = static_cast<char *>(malloc(size))) == nullptr)
+	    throw bad_alloc();
+
+	_large.push_back(ptr);
+	return ptr;
+    }
+
+    if (size > size_t(_limit - _next)) {
+	if (_next != nullptr)
+	    _block ++;
+
+	if (_block == _blocks.size()) {
+	    if ((ptr = static_cast<char *>(malloc(BLOCK_SIZE))) == nullptr)
+		throw bad_alloc();
+
+	    _blocks.push_back(ptr);
+	}
+
+	_next = _blocks[_block];
+	_limit = _next + BLOCK_SIZE;
+    }
+
+    ptr = _next;
+    _next += size;
+    return ptr;
+}
+
+
+/*
+ * Function:	Arena::reset
+ *
+ * Description:	Destroy all objects in this arena and make its memory
+ *		available for reuse.
+ */
+
+void Arena::reset()
+{
+    while (!_objects.empty()) {
+	_objects.back()->~Object();
+	_objects.pop_back();
+    }
+
+    for (auto block : _large)
+	free(block);
+
+    _large.clear();
+    _block = 0;
+    _next = _limit = nullptr;
+}
@@ -0,0 +1,55 @@
+/*
+ * File:	Arena.h
+ *
+ * Description:	This file contains the class definition for arenas.  An
+ *		arena is a region of memory from which objects are carved
+ *		sequentially and then released all at once.  Objects of any
+ *		class derived from Arena::Object are allocated from the
+ *		current arena unless another arena is explicitly given.
+ *
+ *		The global arena holds anything that must outlive the
+ *		function being compiled, such as global symbols and their
+ *		scope.  The abstract syntax tree, scopes, and symbols of a
+ *		function are allocated from a separate arena that is reset
+ *		once the function has been generated.
+ */
+
+# ifndef ARENA_H
+# define ARENA_H
+# include <cstddef>
+# include <vector>
+
+class Arena {
+public:
+    class Object {
+	static thread_local Arena *_pending;
+
+    public:
+	Object();
+	Object(const Object &that);
+	virtual ~Object() {}
+
+	static void *operator new(size_t size);
+	static void *operator new(size_t size, Arena &arena);
+	static void operator delete(void *ptr) {}
+	static void operator delete(void *ptr, Arena &arena) {}
+    };
+
+    static Arena global;
+    static Arena *current;
+
+private:
+    std::vector<char *> _blocks, _large;
+    std::vector<Object *> _objects;
+    unsigned _block;
+    char *_next, *_limit;
+
+public:
+    Arena();
+    ~Arena();
+
+    void *allocate(size_t size);
+    void reset();
+};
+
+# endif /* ARENA_H */
@@ -0,0 +1,239 @@
+/*
+ * File:	Cache.cpp
+ *
+ * Description:	This file contains the member function definitions for
+ *		digests and the compilation cache.  Entries are written to a
+ *		temporary file and then renamed, so a reader never sees a
+ *		partial entry even if several compilers, or several threads
+ *		of one compiler, store entries at once.  The cache is only
+ *		an optimization, so any failure to use it is ignored.
+ */
+
+# include <cerrno>
+# include <cstdio>
+# include <cstring>
+# include <iostream>
+# include <fcntl.h>
+# include <sys/stat.h>
+# include <unistd.h>
+# include "Cache.h"
+# include "Timer.h"
+
+using namespace std;
+
+Cache cache;
+
+static const unsigned __int128 OFFSET_BASIS =
+    (unsigned __int128) 0x6c62272e07bb0142ULL << 64 | 0x62b821756295c58dULL;
+
+static const unsigned __int128 PRIME =
+    (unsigned __int128) 0x0000000001000000ULL << 64 | 0x000000000000013bULL;
+
+
+/*
+ * Function:	Digest::Digest (constructor)
+ *
+ * Description:	Initialize this digest as the digest of nothing.
+ */
+
+Digest::Digest()
+    : _value(OFFSET_BASIS)
+{
+}
+
+
+/*
+ * Function:	Digest::add
+ *
+ * Description:	Add the given bytes to this digest.
+ */
+
+Digest &Digest::add(const void *data, size_t length)
+{
+    const unsigned char *p = static_cast<const unsigned char *>(data);
+
+
+    while (length -- > 0) {
+	_value ^= *p ++;
+	_value *= PRIME;
+    }
+
+    return *this;
+}
+
+
+/*
+ * Function:	Digest::add
+ *
+ * Description:	Add the given text to this digest, preceded by its length
+ *		so that adjacent pieces of text cannot run together.
+ */
+
+Digest &Digest::add(const string &text)
+{
+    return add(text.size()).add(text.data(), text.size());
+}
+
+
+/*
+ * Function:	Digest::add
+ *
+ * Description:	Add the given number to this digest.
+ */
+
+Digest &Digest::add(unsigned long value)
+{
+    return add(&value, sizeof(value));
+}
+
+
+/*
+ * Function:	Digest::str
+ *
+ * Description:	Return this digest as a string of hexadecimal digits.
+ */
+
+string Digest::str() const
+{
+    char buf[33];
+
+
+    snprintf(buf, sizeof(buf), "%016llx%016llx",
+	     (unsigned long long) (_value >> 64), (unsigned long long) _value);
+
+    return buf;
+}
+
+
+/*
+ * Function:	Cache::enabled
+ *
+ * Description:	Return whether the cache has been opened.
+ */
+
+bool Cache::enabled() const
+{
+    return !_directory.empty();
+}
+
+
+/*
+ * Function:	Cache::open
+ *
+ * Description:	Use the given directory for the cache, creating it if
+ *		necessary.  The size and modification time of the running
+ *		compiler stand in for its identity.
+ */
+
+void Cache::open(const string &directory, const string &options)
+{
+    struct stat st;
+
+
+    if (mkdir(directory.c_str(), 0777) < 0 && errno != EEXIST) {
+	cerr << "scc: cannot create cache " << directory << ": ";
+	cerr << strerror(errno) << endl;
+	return;
+    }
+
+    if (stat("/proc/self/exe", &st) == 0) {
+	_salt.add(st.st_size);
+	_salt.add(st.st_mtime);
+    }
+
+    _salt.add(options);
+    _directory = directory;
+}
+
+
+/*
+ * Function:	Cache::path (private)
+ *
+ * Description:	Return the name of the file holding the entry for the
+ *		given key.
+ */
+
+string Cache::path(const Digest &key) const
+{
+    return _directory + "/" + Digest(_salt).add(key.str()).str();
+}
+
+
+/*
+ * Function:	Cache::fetch
+ *
+ * Description:	Read the entry for the given key, if there is one.
+ */
+
+bool Cache::fetch(const Digest &key, string &contents) const
+{
+    Timer::Scope timer(Timer::CACHE);
+    struct stat st;
+    size_t length;
+    ssize_t n;
+    int fd;
+
+
+    if (!enabled() || (fd = ::open(path(key).c_str(), O_RDONLY)) < 0)
+	return false;
+
+    if (fstat(fd, &st) < 0) {
+	close(fd);
+	return false;
+    }
+
+    contents.resize(st.st_size);
+    length = 0;
+
+    while (length < contents.size()) {
+	n = read(fd, &contents[length], contents.size() - length);
+
+	if (n > 0)
+	    length += n;
+	else if (n == 0 || errno != EINTR)
+	    break;
+    }
+
+    close(fd);
+    return length == contents.size();
+}
+
+
+/*
+ * Function:	Cache::store
+ *
+ * Description:	Write the entry for the given key.
+ */
+
+void Cache::store(const Digest &key, const string &contents) const
+{
+    Timer::Scope timer(Timer::CACHE);
+    string temp;
+    size_t length;
+    ssize_t n;
+    int fd;
+
+
+    if (!enabled())
+	return;
+
+    temp = _directory + "/.tmpXXXXXX";
+
+    if ((fd = mkstemp(&temp[0])) < 0)
+	return;
+
+    length = 0;
+
+    while (length < contents.size()) {
+	n = write(fd, contents.data() + length, contents.size() - length);
+
+	if (n > 0)
+	    length += n;
+	else if (errno != EINTR)
+	    break;
+    }
+
+    if (close(fd) < 0 || length < contents.size()
+	    || rename(temp.c_str(), path(key).c_str()) < 0)
+	unlink(temp.c_str());
+}
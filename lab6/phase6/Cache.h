@@ -0,0 +1,48 @@
+/*
+ * File:	Cache.h
+ *
+ * Description:	This file contains the class definitions for the
+ *		compilation cache.  A digest is a 128-bit FNV-1a hash of
+ *		everything added to it.  The cache maps the digest of some
+ *		input to the assembly code generated from it, with one file
+ *		for each entry in a directory.  The identity of the
+ *		compiler and its options are mixed into every key, so
+ *		entries are never shared between different compilers or
+ *		different options.
+ */
+
+# ifndef CACHE_H
+# define CACHE_H
+# include <cstddef>
+# include <string>
+
+class Digest {
+    unsigned __int128 _value;
+
+public:
+    Digest();
+
+    Digest &add(const void *data, size_t length);
+    Digest &add(const std::string &text);
+    Digest &add(unsigned long value);
+
+    std::string str() const;
+};
+
+class Cache {
+    std::string _directory;
+    Digest _salt;
+
+    std::string path(const Digest &key) const;
+
+public:
+    bool enabled() const;
+    void open(const std::string &directory, const std::string &options);
+
+    bool fetch(const Digest &key, std::string &contents) const;
+    void store(const Digest &key, const std::string &contents) const;
+};
+
+extern Cache cache;
+
+# endif /* CACHE_H */
@@ -0,0 +1,295 @@
+/*
+ * File:	Emitter.cpp
+ *
+ * Description:	This file contains the member function definitions for
+ *		the assembly emitter.
+ */
+
+# include <cerrno>
+# include <cstdlib>
+# include <iostream>
+# include <unistd.h>
+# include "Emitter.h"
+
+using namespace std;
+
+static const size_t BUFFER_SIZE = 1 << 16;
+
+
+/*
+ * Function:	Emitter::Buffer::Buffer (constructor)
+ *
+ * Description:	Initialize this buffer to write to the given file
+ *		descriptor.  If there is none, the buffer is permanently
+ *		held.
+ */
+
+Emitter::Buffer::Buffer(int fd)
+    : _data(BUFFER_SIZE), _holds(fd < 0), _fd(fd)
+{
+    reset(0);
+}
+
+
+/*
+ * Function:	Emitter::Buffer::take
+ *
+ * Description:	Return the contents of the buffer and empty it.
+ */
+
+string Emitter::Buffer::take()
+{
+    string text(pbase(), pptr());
+
+    reset(0);
+    return text;
+}
+
+
+/*
+ * Function:	Emitter::Buffer::reset (private)
+ *
+ * Description:	Reset the put area to cover all of the buffer storage with
+ *		the given number of characters already written.
+ */
+
+void Emitter::Buffer::reset(size_t length)
+{
+    setp(_data.data(), _data.data() + _data.size());
+    pbump(length);
+}
+
+
+/*
+ * Function:	Emitter::Buffer::overflow (protected)
+ *
+ * Description:	Make room in the buffer for another character by writing
+ *		its contents, or by enlarging it if output is being held.
+ */
+
+Emitter::int_type Emitter::Buffer::overflow(int_type c)
+{
+    size_t length;
+
+
+    if (_holds > 0) {
+	length = pptr() - pbase();
+	_data.resize(_data.size() * 2);
+	reset(length);
+    } else
+	drain();
+
+    if (c != traits_type::eof()) {
+	*pptr() = c;
+	pbump(1);
+    }
+
+    return traits_type::not_eof(c);
+}
+
+
+/*
+ * Function:	Emitter::Buffer::sync (protected)
+ *
+ * Description:	Write the contents of the buffer unless output is being
+ *		held.
+ */
+
+int Emitter::Buffer::sync()
+{
+    if (_holds == 0)
+	drain();
+
+    return 0;
+}
+
+
+/*
+ * Function:	Emitter::Buffer::drain
+ *
+ * Description:	Write the entire contents of the buffer and empty it.
+ */
+
+void Emitter::Buffer::drain()
+{
+    const char *data = pbase();
+    size_t length = pptr() - pbase();
+    ssize_t n;
+
+
+    while (length > 0) {
+	n = ::write(_fd, data, length);
+
+	if (n < 0) {
+	    if (errno == EINTR)
+		continue;
+
+	    perror("write");
+	    exit(EXIT_FAILURE);
+	}
+
+	data += n;
+	length -= n;
+    }
+
+    reset(0);
+}
+
+
+/*
+ * Function:	Emitter::Buffer::hold
+ *
+ * Description:	Keep all further output in the buffer until it is
+ *		released, and return the current position in the buffer.
+ */
+
+size_t Emitter::Buffer::hold()
+{
+    _holds ++;
+    return pptr() - pbase();
+}
+
+
+/*
+ * Function:	Emitter::Buffer::splice
+ *
+ * Description:	Insert the given text into the buffer at a position
+ *		previously returned by hold.
+ */
+
+void Emitter::Buffer::splice(size_t position, const string &text)
+{
+    size_t length = pptr() - pbase();
+
+    _data.resize(length);
+    _data.insert(_data.begin() + position, text.begin(), text.end());
+    _data.resize(max(_data.size() * 2, BUFFER_SIZE));
+    reset(length + text.size());
+}
+
+
+/*
+ * Function:	Emitter::Buffer::release
+ *
+ * Description:	Undo a previous hold.  Once nothing is being held, the
+ *		contents of the buffer are written if it has grown large.
+ */
+
+void Emitter::Buffer::release()
+{
+    if (-- _holds == 0 && size_t(pptr() - pbase()) >= BUFFER_SIZE)
+	drain();
+}
+
+
+/*
+ * Function:	Emitter::Emitter (constructor)
+ *
+ * Description:	Initialize this emitter to write to the given file
+ *		descriptor.  Debugging comments are initially disabled.
+ */
+
+Emitter::Emitter(int fd)
+    : ostream(nullptr), _buffer(fd), _comments(false)
+{
+    rdbuf(&_buffer);
+}
+
+
+/*
+ * Function:	Emitter::take
+ *
+ * Description:	Return everything held by this emitter and empty it.
+ */
+
+string Emitter::take()
+{
+    return _buffer.take();
+}
+
+
+/*
+ * Function:	Emitter::~Emitter (destructor)
+ *
+ * Description:	Write anything remaining in the buffer, unless it is held.
+ */
+
+Emitter::~Emitter()
+{
+    _buffer.pubsync();
+}
+
+
+/*
+ * Function:	Emitter::comments (accessor)
+ *
+ * Description:	Return whether debugging comments are enabled.
+ */
+
+bool Emitter::comments() const
+{
+    return _comments;
+}
+
+
+/*
+ * Function:	Emitter::comments (mutator)
+ *
+ * Description:	Enable or disable the writing of debugging comments.
+ */
+
+void Emitter::comments(bool enable)
+{
+    _comments = enable;
+}
+
+
+/*
+ * Function:	Emitter::comment
+ *
+ * Description:	Write the given text as a comment line if debugging
+ *		comments are enabled.
+ */
+
+void Emitter::comment(const string &text)
+{
+    if (_comments)
+	*this << "#" << text << '\n';
+}
+
+
+/*
+ * Function:	Emitter::hold
+ *
+ * Description:	Keep all further output in memory until it is released,
+ *		and return a position for use with splice.
+ */
+
+size_t Emitter::hold()
+{
+    return _buffer.hold();
+}
+
+
+/*
+ * Function:	Emitter::splice
+ *
+ * Description:	Insert the given text at a position returned by hold.
+ */
+
+void Emitter::splice(size_t position, const string &text)
+{
+    _buffer.splice(position, text);
+}
+
+
+/*
+ * Function:	Emitter::release
+ *
+ * Description:	Undo a previous hold.
+ */
+
+void Emitter::release()
+{
+    _buffer.release();
+}
@@ -0,0 +1,62 @@
+/*
+ * File:	Emitter.h
+ *
+ * Description:	This file contains the class definition for the assembly
+ *		emitter.  An emitter is an output stream that collects the
+ *		generated code in a large memory buffer and writes it to a
+ *		file descriptor in a few large pieces rather than flushing
+ *		every line.  Output may be held in the buffer so that text
+ *		can later be spliced in before it, as is needed for a
+ *		function prologue that depends upon the body.  Debugging
+ *		comments are only written if they are enabled.
+ *
+ *		An emitter without a file descriptor holds everything it
+ *		is given until its contents are taken.
+ */
+
+# ifndef EMITTER_H
+# define EMITTER_H
+# include <ostream>
+# include <string>
+# include <vector>
+
+class Emitter : public std::ostream {
+    class Buffer : public std::streambuf {
+	std::vector<char> _data;
+	unsigned _holds;
+	int _fd;
+
+	void reset(size_t length);
+
+    protected:
+	virtual int_type overflow(int_type c);
+	virtual int sync();
+
+    public:
+	Buffer(int fd);
+	std::string take();
+	size_t hold();
+	void splice(size_t position, const std::string &text);
+	void release();
+	void drain();
+    };
+
+    Buffer _buffer;
+    bool _comments;
+
+public:
+    Emitter(int fd = -1);
+    ~Emitter();
+
+    std::string take();
+
+    bool comments() const;
+    void comments(bool enable);
+    void comment(const std::string &text);
+
+    size_t hold();
+    void splice(size_t position, const std::string &text);
+    void release();
+};
+
+# endif /* EMITTER_H */
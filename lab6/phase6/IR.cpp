@@ -0,0 +1,528 @@
+/*
+ * File:	IR.cpp
+ *
+ * Description:	This file contains the member function definitions for the
+ *		intermediate representation of Simple C.
+ *
+ *		The blocks of a procedure are analyzed together: blocks
+ *		that cannot be reached are removed, the rest are put in
+ *		reverse postorder, and the predecessors and immediate
+ *		dominator of each are found.  Dominators are computed with
+ *		the iterative algorithm of Cooper, Harvey, and Kennedy,
+ *		which needs nothing more than the reverse postorder.
+ */
+
+# include <algorithm>
+# include <cassert>
+# include <set>
+# include "IR.h"
+
+using namespace std;
+
+static const char *opcodes[] = {
+    "const", "fconst", "string", "global", "frame",
+    "get", "set", "load", "store",
+    "add", "sub", "mul", "div", "rem", "neg", "shl", "sar",
+    "cmp", "extend", "itof", "ftoi",
+    "call", "copy", "phi",
+    "jump", "branch", "return"
+};
+
+static const char *kinds[] = {
+    "", "int", "ptr", "real"
+};
+
+static const char *conditions[] = {
+    "eq", "ne", "lt", "gt", "le", "ge"
+};
+
+
+/*
+ * Function:	Instruction::Instruction (constructor)
+ *
+ * Description:	Initialize an instruction with the given opcode and kind of
+ *		value, and which defines the given virtual register.
+ */
+
+Instruction::Instruction(Opcode opcode, Kind kind, unsigned number)
+    : opcode(opcode), kind(kind), size(0), condition(EQ), value(0),
+      real(0), symbol(nullptr), block(nullptr), number(number)
+{
+}
+
+
+/*
+ * Function:	Instruction::pure
+ *
+ * Description:	Return whether this instruction does nothing but compute
+ *		its value, so that it may be removed if its value is not
+ *		used or reused if the same value is computed again.  A
+ *		load is not pure since the memory it reads may change.
+ */
+
+bool Instruction::pure() const
+{
+    switch (opcode) {
+    case GET: case SET: case LOAD: case STORE: case CALL: case PHI:
+    case JUMP: case BRANCH: case RETURN:
+	return false;
+
+    default:
+	return true;
+    }
+}
+
+
+/*
+ * Function:	Instruction::constant
+ *
+ * Description:	Return whether the value of this instruction is known
+ *		without executing any code.  Such instructions belong to
+ *		no block.
+ */
+
+bool Instruction::constant() const
+{
+    return opcode <= FRAME;
+}
+
+
+/*
+ * Function:	Instruction::terminates
+ *
+ * Description:	Return whether this instruction ends a basic block.
+ */
+
+bool Instruction::terminates() const
+{
+    return opcode == JUMP || opcode == BRANCH || opcode == RETURN;
+}
+
+
+/*
+ * Function:	Instruction::swap
+ *
+ * Description:	Return the condition that holds when the operands of a
+ *		comparison are exchanged.
+ */
+
+Instruction::Condition Instruction::swap(Condition condition)
+{
+    static const Condition swapped[] = {EQ, NE, GT, LT, GE, LE};
+    return swapped[condition];
+}
+
+
+/*
+ * Function:	Instruction::negate
+ *
+ * Description:	Return the condition that holds when the given one does
+ *		not.
+ */
+
+Instruction::Condition Instruction::negate(Condition condition)
+{
+    static const Condition negated[] = {NE, EQ, GE, LE, GT, LT};
+    return negated[condition];
+}
+
+
+/*
+ * Function:	Instruction::write
+ *
+ * Description:	Write this instruction to the specified stream.
+ */
+
+void Instruction::write(ostream &ostr) const
+{
+    if (kind != NONE)
+	ostr << this << " = ";
+
+    ostr << opcodes[opcode];
+
+    if (kind != NONE)
+	ostr << "." << kinds[kind];
+
+    if (size != 0)
+	ostr << "." << size;
+
+    if (opcode == CMP || opcode == BRANCH)
+	ostr << " " << conditions[condition];
+
+    if (symbol != nullptr && !constant())
+	ostr << " " << symbol->name();
+
+    for (unsigned i = 0; i < operands.size(); i ++) {
+	ostr << (i > 0 ? ", " : " ") << operands[i];
+
+	if (opcode == PHI)
+	    ostr << " [" << blocks[i]->label << "]";
+    }
+
+    if (opcode != PHI)
+	for (unsigned i = 0; i < blocks.size(); i ++)
+	    ostr << (i > 0 ? ", " : " -> ") << blocks[i]->label;
+}
+
+
+/*
+ * Function:	operator <<
+ *
+ * Description:	Write an instruction as an operand to the specified stream:
+ *		a constant is written as its value and anything else as
+ *		the virtual register it defines.
+ */
+
+ostream &operator <<(ostream &ostr, const Instruction *instruction)
+{
+    switch (instruction->opcode) {
+    case Instruction::CONST:
+	return ostr << "$" << instruction->value;
+
+    case Instruction::FCONST:
+	return ostr << "$" << instruction->real;
+
+    case Instruction::STRING:
+	return ostr << "$\"" << instruction->text << "\"";
+
+    case Instruction::GLOBAL:
+	return ostr << "@" << instruction->symbol->name();
+
+    case Instruction::FRAME:
+	return ostr << "&" << instruction->symbol->name();
+
+    default:
+	return ostr << "%" << instruction->number;
+    }
+}
+
+
+/*
+ * Function:	BasicBlock::BasicBlock (constructor)
+ *
+ * Description:	Initialize an empty basic block with a new label.
+ */
+
+BasicBlock::BasicBlock()
+    : dominator(nullptr), number(0)
+{
+}
+
+
+/*
+ * Function:	BasicBlock::terminator
+ *
+ * Description:	Return the instruction ending this block, or null if the
+ *		block is not yet complete.
+ */
+
+Instruction *BasicBlock::terminator() const
+{
+    if (instructions.empty() || !instructions.back()->terminates())
+	return nullptr;
+
+    return instructions.back();
+}
+
+
+/*
+ * Function:	BasicBlock::successors
+ *
+ * Description:	Return the blocks to which this block may transfer
+ *		control, each listed once.
+ */
+
+vector<BasicBlock *> BasicBlock::successors() const
+{
+    Instruction *last = terminator();
+    vector<BasicBlock *> result;
+
+
+    if (last != nullptr)
+	for (auto block : last->blocks)
+	    if (find(result.begin(), result.end(), block) == result.end())
+		result.push_back(block);
+
+    return result;
+}
+
+
+/*
+ * Function:	BasicBlock::dominates
+ *
+ * Description:	Return whether every path to the given block passes
+ *		through this block.  A block dominates itself.
+ */
+
+bool BasicBlock::dominates(const BasicBlock *block) const
+{
+    for (; block != nullptr; block = block->dominator)
+	if (block == this)
+	    return true;
+
+    return false;
+}
+
+
+/*
+ * Function:	BasicBlock::retarget
+ *
+ * Description:	Make the terminator of this block transfer control to one
+ *		block instead of another.
+ */
+
+void BasicBlock::retarget(BasicBlock *from, BasicBlock *to)
+{
+    for (auto &block : terminator()->blocks)
+	if (block == from)
+	    block = to;
+}
+
+
+/*
+ * Function:	Procedure::Procedure (constructor)
+ *
+ * Description:	Initialize an empty procedure for the given function,
+ *		whose locals have been allocated down to the given offset.
+ */
+
+Procedure::Procedure(const Symbol *function, const Symbols &parameters,
+		     int frame)
+    : _count(0), function(function), parameters(parameters), frame(frame)
+{
+}
+
+
+/*
+ * Function:	Procedure::count
+ *
+ * Description:	Return the number of virtual registers defined so far.
+ */
+
+unsigned Procedure::count() const
+{
+    return _count;
+}
+
+
+/*
+ * Function:	Procedure::block
+ *
+ * Description:	Create a new, empty block at the end of this procedure.
+ */
+
+BasicBlock *Procedure::block()
+{
+    BasicBlock *block = new (_arena) BasicBlock();
+
+    blocks.push_back(block);
+    return block;
+}
+
+
+/*
+ * Function:	Procedure::create
+ *
+ * Description:	Create a new instruction that is not yet in any block.
+ */
+
+Instruction *Procedure::create(Instruction::Opcode opcode,
+			       Instruction::Kind kind)
+{
+    return new (_arena) Instruction(opcode, kind, _count ++);
+}
+
+
+/*
+ * Function:	Procedure::constant
+ *
+ * Description:	Create a new integer constant.
+ */
+
+Instruction *Procedure::constant(int value, Instruction::Kind kind)
+{
+    Instruction *result = create(Instruction::CONST, kind);
+
+    result->value = value;
+    return result;
+}
+
+
+/*
+ * Function:	Procedure::analyze
+ *
+ * Description:	Remove the blocks that cannot be reached from the entry,
+ *		put the rest in reverse postorder, and find the
+ *		predecessors and immediate dominator of each.  Phi
+ *		instructions lose the values from removed predecessors.
+ */
+
+void Procedure::analyze()
+{
+    vector<pair<BasicBlock *, unsigned>> stack;
+    vector<BasicBlock *> order, successors;
+    set<BasicBlock *> visited;
+    BasicBlock *block, *dominator;
+    bool changed;
+
+
+    /* Find the reachable blocks in postorder. */
+
+    stack.push_back({blocks[0], 0});
+    visited.insert(blocks[0]);
+
+    while (!stack.empty()) {
+	block = stack.back().first;
+	successors = block->successors();
+
+	if (stack.back().second < successors.size()) {
+	    BasicBlock *next = successors[stack.back().second ++];
+
+	    if (visited.insert(next).second)
+		stack.push_back({next, 0});
+
+	} else {
+	    order.push_back(block);
+	    stack.pop_back();
+	}
+    }
+
+    reverse(order.begin(), order.end());
+    blocks = order;
+
+    for (unsigned i = 0; i < blocks.size(); i ++) {
+	blocks[i]->number = i;
+	blocks[i]->predecessors.clear();
+	blocks[i]->dominator = nullptr;
+    }
+
+    for (auto block : blocks)
+	for (auto successor : block->successors())
+	    successor->predecessors.push_back(block);
+
+
+    /* Phi instructions only have values for remaining predecessors. */
+
+    for (auto block : blocks)
+	for (auto phi : block->instructions) {
+	    if (phi->opcode != Instruction::PHI)
+		break;
+
+	    for (unsigned i = phi->blocks.size(); i -- > 0; )
+		if (!visited.count(phi->blocks[i]) ||
+			find(block->predecessors.begin(),
+			     block->predecessors.end(),
+			     phi->blocks[i]) == block->predecessors.end()) {
+		    phi->blocks.erase(phi->blocks.begin() + i);
+		    phi->operands.erase(phi->operands.begin() + i);
+		}
+	}
+
+
+    /* Compute the immediate dominators. */
+
+    blocks[0]->dominator = blocks[0];
+
+    do {
+	changed = false;
+
+	for (unsigned i = 1; i < blocks.size(); i ++) {
+	    dominator = nullptr;
+
+	    for (auto pred : blocks[i]->predecessors) {
+		if (pred->dominator == nullptr)
+		    continue;
+
+		if (dominator == nullptr) {
+		    dominator = pred;
+		    continue;
+		}
+
+		BasicBlock *other = pred;
+
+		while (other != dominator) {
+		    while (other->number > dominator->number)
+			other = other->dominator;
+
+		    while (dominator->number > other->number)
+			dominator = dominator->dominator;
+		}
+	    }
+
+	    if (blocks[i]->dominator != dominator) {
+		blocks[i]->dominator = dominator;
+		changed = true;
+	    }
+	}
+    } while (changed);
+
+    blocks[0]->dominator = nullptr;
+}
+
+
+/*
+ * Function:	Procedure::replace
+ *
+ * Description:	Replace each of the given instructions everywhere it is
+ *		used, and remove it from its block.  A replacement may
+ *		itself be replaced.
+ */
+
+void Procedure::replace(const Replacements &replacements)
+{
+    Replacements::const_iterator it;
+
+
+    if (replacements.empty())
+	return;
+
+    for (auto block : blocks) {
+	vector<Instruction *> kept;
+
+	for (auto instruction : block->instructions) {
+	    if (replacements.count(instruction) > 0)
+		continue;
+
+	    for (auto &operand : instruction->operands)
+		while ((it = replacements.find(operand)) != replacements.end())
+		    operand = it->second;
+
+	    kept.push_back(instruction);
+	}
+
+	block->instructions = kept;
+    }
+}
+
+
+/*
+ * Function:	Procedure::write
+ *
+ * Description:	Write this procedure to the specified stream.
+ */
+
+void Procedure::write(ostream &ostr) const
+{
+    ostr << function->name() << ":" << endl;
+
+    for (auto block : blocks) {
+	ostr << block->label << ":";
+
+	if (!block->predecessors.empty()) {
+	    ostr << "\t\t# from";
+
+	    for (auto pred : block->predecessors)
+		ostr << " " << pred->label;
+	}
+
+	ostr << endl;
+
+	for (auto instruction : block->instructions) {
+	    ostr << "\t";
+	    instruction->write(ostr);
+	    ostr << endl;
+	}
+    }
+
+    ostr << endl;
+}
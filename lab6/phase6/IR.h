@@ -0,0 +1,122 @@
+/*
+ * File:	IR.h
+ *
+ * Description:	This file contains the class definitions for the
+ *		intermediate representation of Simple C, which lies between
+ *		the abstract syntax tree and the assembly code.
+ *
+ *		A procedure is a control-flow graph of basic blocks, each
+ *		a list of instructions ending in a jump, a branch, or a
+ *		return.  An instruction that has a value defines a virtual
+ *		register of the kind of that value: an integer, a pointer,
+ *		or a double.  Once its local variables have been promoted,
+ *		a procedure is in static single assignment form: every
+ *		virtual register is defined by exactly one instruction,
+ *		which dominates its uses, and phi instructions at the
+ *		start of a block merge the values that reach it from its
+ *		predecessors.
+ *
+ *		Constants, and the addresses of globals, locals, and
+ *		literals, are instructions too, but are cheap enough that
+ *		the code for them is generated wherever they are used.
+ *
+ *		The instructions, blocks, and everything they refer to are
+ *		allocated from an arena that belongs to the procedure.
+ */
+
+# ifndef IR_H
+# define IR_H
+# include <map>
+# include <ostream>
+# include <string>
+# include <vector>
+# include "Arena.h"
+# include "Label.h"
+# include "Scope.h"
+
+class BasicBlock;
+
+class Instruction : public Arena::Object {
+public:
+    enum Opcode {
+	CONST, FCONST, STRING, GLOBAL, FRAME,
+	GET, SET, LOAD, STORE,
+	ADD, SUB, MUL, DIV, REM, NEG, SHL, SAR,
+	CMP, EXTEND, ITOF, FTOI,
+	CALL, COPY, PHI,
+	JUMP, BRANCH, RETURN
+    };
+
+    enum Kind {
+	NONE, INT, PTR, REAL
+    };
+
+    enum Condition {
+	EQ, NE, LT, GT, LE, GE
+    };
+
+    Opcode opcode;
+    Kind kind;
+    unsigned size;
+    Condition condition;
+    int value;
+    double real;
+    std::string text;
+    const Symbol *symbol;
+    std::vector<Instruction *> operands;
+    std::vector<BasicBlock *> blocks;
+    BasicBlock *block;
+    unsigned number;
+
+    Instruction(Opcode opcode, Kind kind, unsigned number);
+    bool pure() const;
+    bool constant() const;
+    bool terminates() const;
+    void write(std::ostream &ostr) const;
+
+    static Condition swap(Condition condition);
+    static Condition negate(Condition condition);
+};
+
+class BasicBlock : public Arena::Object {
+public:
+    Label label;
+    std::vector<Instruction *> instructions;
+    std::vector<BasicBlock *> predecessors;
+    BasicBlock *dominator;
+    unsigned number;
+
+    BasicBlock();
+    Instruction *terminator() const;
+    std::vector<BasicBlock *> successors() const;
+    bool dominates(const BasicBlock *block) const;
+    void retarget(BasicBlock *from, BasicBlock *to);
+};
+
+typedef std::map<Instruction *, Instruction *> Replacements;
+
+class Procedure {
+    Arena _arena;
+    unsigned _count;
+
+public:
+    const Symbol *function;
+    Symbols parameters;
+    int frame;
+    std::vector<BasicBlock *> blocks;
+
+    Procedure(const Symbol *function, const Symbols &parameters, int frame);
+    unsigned count() const;
+
+    BasicBlock *block();
+    Instruction *create(Instruction::Opcode opcode, Instruction::Kind kind);
+    Instruction *constant(int value, Instruction::Kind kind = Instruction::INT);
+
+    void analyze();
+    void replace(const Replacements &replacements);
+    void write(std::ostream &ostr) const;
+};
+
+std::ostream &operator <<(std::ostream &ostr, const Instruction *instruction);
+
+# endif /* IR_H */
@@ -2,9 +2,13 @@
 
 using namespace std;
 
-unsigned Label::_counter = 0;
+static const string global;
+
+thread_local unsigned Label::_counter = 0;
+thread_local const string *Label::_current = &global;
 
 Label::Label() {
+  _scope = _current;
   _number = _counter++;
 }
 
@@ -12,6 +16,17 @@ unsigned Label::number() const {
   return _number;
 }
 
+const string &Label::scope() const {
+  return *_scope;
+}
+
+// Start numbering labels for the named function.  The name must outlive
+// the labels, as interned names do.
+void Label::begin(const string &scope) {
+  _current = &scope;
+  _counter = 0;
+}
+
 ostream &operator <<(ostream &ostr, const Label &label) {
-  return ostr << ".L" << label.number();
+  return ostr << ".L" << label.scope() << "." << label.number();
 }
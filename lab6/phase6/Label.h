@@ -1,14 +1,24 @@
-
 # ifndef LABEL_H
 # define LABEL_H
 #include <ostream>
+#include <string>
+
+/*
+ * Labels are numbered separately within each function and carry the
+ * function's name, so the labels of a function do not depend on any
+ * other function and functions can be generated in any order.
+ */
 
 class Label {
-  static unsigned _counter;
+  static thread_local unsigned _counter;
+  static thread_local const std::string *_current;
+  const std::string *_scope;
   unsigned _number;
 public:
   Label();
   unsigned number() const;
+  const std::string &scope() const;
+  static void begin(const std::string &scope);
 };
 
 std::ostream &operator <<(std::ostream &ostr, const Label &label);
@@ -0,0 +1,115 @@
+/*
+ * File:	Name.cpp
+ *
+ * Description:	This file contains the member function definitions for
+ *		names.  The elements of an unordered set are never moved,
+ *		so the address of each string in the table is a stable
+ *		handle for its text.
+ */
+
+# include <unordered_set>
+# include "Name.h"
+
+using namespace std;
+
+
+/*
+ * Function:	intern (private)
+ *
+ * Description:	Return the unique copy of the given text in the table of
+ *		names, adding it if necessary.
+ */
+
+static const string *intern(const string &text)
+{
+    static unordered_set<string> table;
+
+    return &*table.insert(text).first;
+}
+
+
+/*
+ * Function:	Name::Name (constructor)
+ *
+ * Description:	Initialize this name as the empty name.
+ */
+
+Name::Name()
+{
+    static const string *empty = intern("");
+
+    _text = empty;
+}
+
+
+/*
+ * Function:	Name::Name (constructor)
+ *
+ * Description:	Initialize this name with the given text.
+ */
+
+Name::Name(const string &text)
+    : _text(intern(text))
+{
+}
+
+
+/*
+ * Function:	Name::Name (constructor)
+ *
+ * Description:	Initialize this name with the given text, which need not
+ *		be null terminated.
+ */
+
+Name::Name(const char *text, size_t length)
+    : _text(intern(string(text, length)))
+{
+}
+
+
+/*
+ * Function:	Name::str (accessor)
+ *
+ * Description:	Return the text of this name.
+ */
+
+const string &Name::str() const
+{
+    return *_text;
+}
+
+
+/*
+ * Function:	Name::operator ==
+ *
+ * Description:	Return whether another name is the same as this name.
+ */
+
+bool Name::operator ==(const Name &rhs) const
+{
+    return _text == rhs._text;
+}
+
+
+/*
+ * Function:	Name::operator !=
+ *
+ * Description:	Return whether another name is different from this name.
+ */
+
+bool Name::operator !=(const Name &rhs) const
+{
+    return _text != rhs._text;
+}
+
+
+/*
+ * Function:	operator <<
+ *
+ * Description:	Write the text of a name to the specified stream.
+ */
+
+ostream &operator <<(ostream &ostr, const Name &name)
+{
+    return ostr << name.str();
+}
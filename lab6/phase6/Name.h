@@ -0,0 +1,42 @@
+/*
+ * File:	Name.h
+ *
+ * Description:	This file contains the class definition for names.  A name
+ *		is a handle to a unique copy of an identifier kept in a
+ *		global table, so names are compared and hashed by pointer
+ *		rather than by their text.  The lexical analyzer creates a
+ *		name for each identifier it recognizes.
+ */
+
+# ifndef NAME_H
+# define NAME_H
+# include <cstddef>
+# include <functional>
+# include <ostream>
+# include <string>
+
+class Name {
+    const std::string *_text;
+
+public:
+    Name();
+    explicit Name(const std::string &text);
+    Name(const char *text, size_t length);
+
+    const std::string &str() const;
+
+    bool operator ==(const Name &rhs) const;
+    bool operator !=(const Name &rhs) const;
+};
+
+std::ostream &operator <<(std::ostream &ostr, const Name &name);
+
+namespace std {
+    template<> struct hash<Name> {
+	size_t operator ()(const Name &name) const {
+	    return hash<const string *>()(&name.str());
+	}
+    };
+}
+
+# endif /* NAME_H */
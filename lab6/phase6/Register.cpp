@@ -0,0 +1,65 @@
+/*
+ * File:	Register.cpp
+ *
+ * Description:	This file contains the member function definitions for
+ *		registers of the target machine.
+ */
+
+# include "Register.h"
+# include "Target.h"
+
+using namespace std;
+
+
+/*
+ * Function:	Register::Register (constructor)
+ *
+ * Description:	Initialize this register object.  The register initially
+ *		holds no value.
+ */
+
+Register::Register(const string &quad, const string &name, const string &byte,
+		   bool callee)
+    : _quad(quad), _name(name), _byte(byte), _callee(callee), node(nullptr)
+{
+}
+
+
+/*
+ * Function:	Register::name (accessor)
+ *
+ * Description:	Return the name of this register for an operand of the
+ *		given size.  The name is empty if the register cannot hold
+ *		an operand of that size.
+ */
+
+const string &Register::name(unsigned size) const
+{
+    return size == 1 ? _byte : size == 8 ? _quad : _name;
+}
+
+
+/*
+ * Function:	Register::callee (accessor)
+ *
+ * Description:	Return whether this register must be preserved across a
+ *		function call by the called function.
+ */
+
+bool Register::callee() const
+{
+    return _callee;
+}
+
+
+/*
+ * Function:	operator <<
+ *
+ * Description:	Write the name of a register as wide as the registers of
+ *		the target machine to the specified output stream.
+ */
+
+ostream &operator <<(ostream &ostr, const Register *reg)
+{
+    return ostr << reg->name(target->sizeofRegister);
+}
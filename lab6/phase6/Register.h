@@ -0,0 +1,35 @@
+/*
+ * File:	Register.h
+ *
+ * Description:	This file contains the class definition for registers of
+ *		the target machine.  A register has a name for each size
+ *		of operand it can hold (on i386, esi and edi have no byte
+ *		forms and no register has a quadword form), knows whether
+ *		the callee must preserve it, and records the expression
+ *		whose value it currently holds, if any.
+ */
+
+# ifndef REGISTER_H
+# define REGISTER_H
+# include <string>
+# include <ostream>
+
+class Expression;
+
+class Register {
+    typedef std::string string;
+    string _quad, _name, _byte;
+    bool _callee;
+
+public:
+    Expression *node;
+
+    Register(const string &quad, const string &name, const string &byte,
+	     bool callee = false);
+    const string &name(unsigned size = 4) const;
+    bool callee() const;
+};
+
+std::ostream &operator <<(std::ostream &ostr, const Register *reg);
+
+# endif /* REGISTER_H */
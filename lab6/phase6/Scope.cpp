@@ -16,6 +16,8 @@
 # include <cassert>
 # include "Scope.h"
 
+static const unsigned INDEX_THRESHOLD = 16;
+
 
 /*
  * Function:	Scope::Scope (constructor)
@@ -33,14 +35,24 @@ Scope::Scope(Scope *enclosing)
  * Function:	Scope::insert
  *
  * Description:	Insert the given symbol into this scope.  It had better not
- *		already be inserted, or we fail big time.
+ *		already be inserted, or we fail big time.  The index is
+ *		built once the scope reaches a certain size, and is kept
+ *		up to date afterwards.
  */
 
-
 void Scope::insert(Symbol *symbol)
 {
     assert(find(symbol->name()) == nullptr);
     _symbols.push_back(symbol);
+
+    if (_symbols.size() == INDEX_THRESHOLD) {
+	_index.reserve(INDEX_THRESHOLD * 2);
+
+	for (auto other : _symbols)
+	    _index.emplace(other->name(), other);
+
+    } else if (_symbols.size() > INDEX_THRESHOLD)
+	_index.emplace(symbol->name(), symbol);
 }
 
 
@@ -51,8 +63,13 @@ void Scope::insert(Symbol *symbol)
  *		scope.  If no such symbol is found, return a null pointer.
  */
 
-Symbol *Scope::find(const string &name) const
+Symbol *Scope::find(const Name &name) const
 {
+    if (_symbols.size() >= INDEX_THRESHOLD) {
+	auto it = _index.find(name);
+	return it != _index.end() ? it->second : nullptr;
+    }
+
     for (auto symbol : _symbols)
 	if (name == symbol->name())
 	    return symbol;
@@ -70,7 +87,7 @@ Symbol *Scope::find(const string &name) const
  *		null pointer.
  */
 
-Symbol *Scope::lookup(const string &name) const
+Symbol *Scope::lookup(const Name &name) const
 {
     Symbol *symbol;
 
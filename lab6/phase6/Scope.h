@@ -12,28 +12,37 @@
  *		scope.  The find function searches only the given scope,
  *		whereas the lookup function searches the given scope and
  *		all enclosing scopes.
+ *
+ *		Most scopes are small and are searched linearly, but once
+ *		a scope grows large (such as the global scope of a big
+ *		program), its symbols are also indexed by name in a hash
+ *		table.  Names are interned, so symbols are found by
+ *		comparing and hashing pointers.  The vector is still kept
+ *		so that the symbols can be visited in insertion order.
  */
 
 # ifndef SCOPE_H
 # define SCOPE_H
+# include "Arena.h"
 # include "Symbol.h"
-# include <string>
+# include <unordered_map>
 # include <vector>
 
 typedef std::vector<Symbol *> Symbols;
 
-class Scope {
-    typedef std::string string;
+class Scope : public Arena::Object {
+    typedef std::unordered_map<Name, Symbol *> Index;
 
     Scope *_enclosing;
     Symbols _symbols;
+    Index _index;
 
 public:
     Scope(Scope *enclosing = nullptr);
 
     void insert(Symbol *symbol);
-    Symbol *find(const string &name) const;
-    Symbol *lookup(const string &name) const;
+    Symbol *find(const Name &name) const;
+    Symbol *lookup(const Name &name) const;
 
     Scope *enclosing() const;
     const Symbols &symbols() const;
@@ -8,8 +8,6 @@
 
 # include "Symbol.h"
 
-using std::string;
-
 
 /*
  * Function:	Symbol::Symbol (constructor)
@@ -17,7 +15,7 @@ using std::string;
  * Description:	Initialize a symbol object.
  */
 
-Symbol::Symbol(const string &name, const Type &type)
+Symbol::Symbol(const Name &name, const Type &type)
     : _name(name), _type(type), offset(0)
 {
 }
@@ -29,7 +27,7 @@ Symbol::Symbol(const string &name, const Type &type)
  * Description:	Return the name of this symbol.
  */
 
-const string &Symbol::name() const
+const Name &Symbol::name() const
 {
     return _name;
 }
@@ -9,18 +9,19 @@
 # ifndef SYMBOL_H
 # define SYMBOL_H
 # include <string>
+# include "Arena.h"
+# include "Name.h"
 # include "Type.h"
 
-class Symbol {
-    typedef std::string string;
-    string _name;
+class Symbol : public Arena::Object {
+    Name _name;
     Type _type;
 
 public:
     int offset;
 
-    Symbol(const string &name, const Type &type);
-    const string &name() const;
+    Symbol(const Name &name, const Type &type);
+    const Name &name() const;
     const Type &type() const;
 };
 
@@ -0,0 +1,32 @@
+/*
+ * File:	Target.cpp
+ *
+ * Description:	This file contains the descriptions of the target machines.
+ *		Global names are decorated as on the host, which must be
+ *		an x86 running Linux or macOS.
+ */
+
+# include "Target.h"
+
+# if defined (__linux__) && (defined(__i386__) || defined(__x86_64__))
+
+# define GLOBAL_PREFIX ""
+
+# elif defined (__APPLE__) && (defined(__i386__) || defined(__x86_64__))
+
+# define GLOBAL_PREFIX "_"
+
+# else
+
+# error Unsupported architecture
+# endif
+
+const Target Target::i386 = {
+    "i386", 1, 4, 8, 4, 4, 16, 0, 0, GLOBAL_PREFIX
+};
+
+const Target Target::x86_64 = {
+    "x86-64", 1, 4, 8, 8, 8, 16, 6, 8, GLOBAL_PREFIX
+};
+
+const Target *target = &Target::i386;
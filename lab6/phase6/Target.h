@@ -0,0 +1,27 @@
+/*
+ * File:	Target.h
+ *
+ * Description:	This file contains the definition of the target machine
+ *		description.  A target gives the sizes of the types and of
+ *		a register, the alignment of the stack at a call, and how
+ *		many integer and floating-point arguments are passed in
+ *		registers.  The i386 target passes every argument on the
+ *		stack; the x86-64 target follows the System V ABI.
+ */
+
+# ifndef TARGET_H
+# define TARGET_H
+
+struct Target {
+    const char *name;
+    unsigned sizeofChar, sizeofInt, sizeofDouble, sizeofPointer;
+    unsigned sizeofRegister, stackAlignment;
+    unsigned integerArguments, realArguments;
+    const char *globalPrefix;
+
+    static const Target i386, x86_64;
+};
+
+extern const Target *target;
+
+# endif /* TARGET_H */
@@ -0,0 +1,335 @@
+/*
+ * File:	Timer.cpp
+ *
+ * Description:	This file contains the member function definitions for
+ *		the phase timer.  Each thread keeps its current phase and
+ *		function, and the time at which it last charged anything,
+ *		so entering or leaving a scope reads the clock only once.
+ *		The totals of each phase are shared by all threads.  Each
+ *		thread records its trace events into a buffer of its own,
+ *		and the buffers are kept until the trace is written.  The
+ *		main thread enters the first scope, so its buffer comes
+ *		first.
+ */
+
+# include <algorithm>
+# include <atomic>
+# include <chrono>
+# include <cstdio>
+# include <deque>
+# include <fstream>
+# include <iomanip>
+# include <iostream>
+# include <mutex>
+# include <unordered_map>
+# include <vector>
+# include "Timer.h"
+
+using namespace std;
+
+struct Timer::Record {
+    string name;
+    unsigned long long times[PHASES];
+};
+
+struct Event {
+    Timer::Phase phase;
+    const Timer::Record *record;
+    unsigned long long start, end;
+};
+
+struct Buffer {
+    unsigned thread;
+    vector<Event> events;
+};
+
+static const char *names[Timer::PHASES] = {
+    "idle", "lex", "parse", "check", "allocate", "generate", "optimize",
+    "peephole", "output", "cache"
+};
+
+bool Timer::_enabled = false;
+
+static string tracefile;
+static bool reporting;
+static unsigned long long origin;
+static atomic<unsigned long long> totals[Timer::PHASES];
+
+static mutex registry;
+static unordered_map<string, Timer::Record *> table;
+static deque<Timer::Record> records;
+static deque<Buffer> buffers;
+
+static thread_local Timer::Phase phase = Timer::IDLE;
+static thread_local Timer::Record *record;
+static thread_local unsigned long long mark;
+static thread_local Buffer *buffer;
+
+
+/*
+ * Function:	now (private)
+ *
+ * Description:	Return the current time in nanoseconds.
+ */
+
+static unsigned long long now()
+{
+    return chrono::duration_cast<chrono::nanoseconds>
+	(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+/*
+ * Function:	charge (private)
+ *
+ * Description:	Charge the time since the last charge on this thread to
+ *		its current phase and function.
+ */
+
+static void charge(unsigned long long time)
+{
+    if (phase != Timer::IDLE) {
+	totals[phase] += time - mark;
+
+	if (record != nullptr)
+	    record->times[phase] += time - mark;
+    }
+
+    mark = time;
+}
+
+
+/*
+ * Function:	lookup (private)
+ *
+ * Description:	Return the record for the named function, creating it if
+ *		necessary.
+ */
+
+static Timer::Record *lookup(const string &name)
+{
+    lock_guard<mutex> guard(registry);
+    Timer::Record *&entry = table[name];
+
+
+    if (entry == nullptr) {
+	records.push_back(Timer::Record());
+	entry = &records.back();
+	entry->name = name;
+    }
+
+    return entry;
+}
+
+
+/*
+ * Function:	Timer::Scope::Scope (constructor)
+ *
+ * Description:	Enter the given phase, and if a function is given, start
+ *		charging time to it.
+ */
+
+Timer::Scope::Scope(Phase phase, const string *function)
+    : _active(_enabled)
+{
+    unsigned long long time;
+
+
+    if (!_active)
+	return;
+
+    if (!tracefile.empty() && buffer == nullptr) {
+	lock_guard<mutex> guard(registry);
+
+	buffers.push_back(Buffer());
+	buffer = &buffers.back();
+	buffer->thread = buffers.size() - 1;
+    }
+
+    time = now();
+    charge(time);
+
+    _phase = phase;
+    _outer = ::phase;
+    _record = ::record;
+    _start = time;
+
+    ::phase = phase;
+
+    if (function != nullptr)
+	::record = lookup(*function);
+}
+
+
+/*
+ * Function:	Timer::Scope::~Scope (destructor)
+ *
+ * Description:	Leave the phase of this scope, recording an event for it
+ *		unless it is a phase entered too often to trace.
+ */
+
+Timer::Scope::~Scope()
+{
+    unsigned long long time;
+
+
+    if (!_active)
+	return;
+
+    time = now();
+    charge(time);
+
+    if (!tracefile.empty() && _phase != LEX && _phase != CHECK)
+	buffer->events.push_back({_phase, ::record, _start, time});
+
+    ::phase = _outer;
+    ::record = _record;
+}
+
+
+/*
+ * Function:	Timer::start
+ *
+ * Description:	Enable timing if a report or a trace is wanted.
+ */
+
+void Timer::start(bool report, const string &trace)
+{
+    reporting = report;
+    tracefile = trace;
+    _enabled = report || !trace.empty();
+    origin = now();
+}
+
+
+/*
+ * Function:	format (private)
+ *
+ * Description:	Write a time in nanoseconds in the given unit.
+ */
+
+static string format(unsigned long long time, double unit)
+{
+    char buf[32];
+
+
+    snprintf(buf, sizeof(buf), "%10.4f", time / unit);
+    return buf;
+}
+
+
+/*
+ * Function:	Timer::finish
+ *
+ * Description:	Write the report to the standard error and the trace to
+ *		its file.  The report gives the total of each phase, which
+ *		may exceed the elapsed time if functions are generated on
+ *		several threads, and then the slowest functions.
+ */
+
+void Timer::finish()
+{
+    unsigned long long elapsed, sum;
+    vector<const Record *> slowest;
+    ofstream trace;
+    bool first;
+    unsigned i;
+
+
+    if (!_enabled)
+	return;
+
+    elapsed = now() - origin;
+    _enabled = false;
+
+    if (reporting) {
+	cerr << "phase       seconds  percent" << endl;
+	sum = 0;
+
+	for (i = 1; i < PHASES; i ++)
+	    sum += totals[i];
+
+	for (i = 1; i < PHASES; i ++) {
+	    cerr << left << setw(8) << names[i] << right << format(totals[i], 1e9);
+	    cerr << fixed << setprecision(1) << setw(8);
+	    cerr << (sum > 0 ? 100.0 * totals[i] / sum : 0) << "%" << endl;
+	}
+
+	cerr << left << setw(8) << "total" << right << format(sum, 1e9) << endl;
+	cerr << left << setw(8) << "elapsed" << right << format(elapsed, 1e9);
+	cerr << endl;
+
+	for (auto &record : records)
+	    slowest.push_back(&record);
+
+	sort(slowest.begin(), slowest.end(),
+	    [](const Record *a, const Record *b) {
+		unsigned long long x = 0, y = 0;
+
+		for (unsigned i = 1; i < PHASES; i ++) {
+		    x += a->times[i];
+		    y += b->times[i];
+		}
+
+		return x > y;
+	    });
+
+	if (slowest.size() > 10)
+	    slowest.resize(10);
+
+	if (!slowest.empty()) {
+	    cerr << endl << "slowest of " << records.size() << " functions";
+	    cerr << " (milliseconds)" << endl << setw(20) << left << "function";
+
+	    for (i = 1; i < PHASES; i ++)
+		cerr << right << setw(10) << names[i];
+
+	    cerr << endl;
+
+	    for (auto record : slowest) {
+		cerr << left << setw(20) << record->name << right;
+
+		for (i = 1; i < PHASES; i ++)
+		    cerr << format(record->times[i], 1e6);
+
+		cerr << endl;
+	    }
+	}
+    }
+
+    if (!tracefile.empty()) {
+	trace.open(tracefile.c_str());
+
+	if (!trace) {
+	    cerr << "scc: cannot write trace " << tracefile << endl;
+	    return;
+	}
+
+	trace << fixed << setprecision(3);
+	trace << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+	first = true;
+
+	for (auto &buffer : buffers) {
+	    trace << (first ? "\n" : ",\n");
+	    trace << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, ";
+	    trace << "\"tid\": " << buffer.thread << ", \"args\": {\"name\": \"";
+	    trace << (buffer.thread == 0 ? "main" : "worker") << "\"}}";
+	    first = false;
+
+	    for (auto &event : buffer.events) {
+		trace << ",\n{\"name\": \"" << names[event.phase] << "\", ";
+		trace << "\"cat\": \"scc\", \"ph\": \"X\", \"pid\": 1, ";
+		trace << "\"tid\": " << buffer.thread << ", ";
+		trace << "\"ts\": " << (event.start - origin) / 1e3 << ", ";
+		trace << "\"dur\": " << (event.end - event.start) / 1e3;
+
+		if (event.record != nullptr)
+		    trace << ", \"args\": {\"function\": \"" << event.record->name << "\"}";
+
+		trace << "}";
+	    }
+	}
+
+	trace << "\n]}" << endl;
+    }
+}
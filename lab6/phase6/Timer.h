@@ -0,0 +1,47 @@
+/*
+ * File:	Timer.h
+ *
+ * Description:	This file contains the class definition for the phase
+ *		timer.  A scope charges the time spent within it, less the
+ *		time spent in any scope nested within it, to its phase and
+ *		to the function being compiled, so the phases of a thread
+ *		always add up to its running time.  The scopes of the
+ *		coarser phases are also recorded as trace events.
+ *
+ *		When timing is disabled, a scope costs only a test of a
+ *		flag, so the scopes are always compiled in.
+ */
+
+# ifndef TIMER_H
+# define TIMER_H
+# include <string>
+
+class Timer {
+public:
+    enum Phase {
+	IDLE, LEX, PARSE, CHECK, ALLOCATE, GENERATE, OPTIMIZE, PEEPHOLE, OUTPUT,
+	CACHE,
+	PHASES
+    };
+
+    struct Record;
+
+    class Scope {
+	bool _active;
+	Phase _phase, _outer;
+	Record *_record;
+	unsigned long long _start;
+
+    public:
+	Scope(Phase phase, const std::string *function = nullptr);
+	~Scope();
+    };
+
+    static void start(bool report, const std::string &trace);
+    static void finish();
+
+private:
+    static bool _enabled;
+};
+
+# endif /* TIMER_H */
@@ -21,8 +21,6 @@
 
 # include "Tree.h"
 # include "tokens.h"
-# include <sstream>
-# include <cstdlib>
 
 using namespace std;
 
@@ -35,7 +33,7 @@ using namespace std;
  */
 
 Expression::Expression(const Type &type)
-    : _type(type), _lvalue(false), offset(0)
+    : _type(type), _lvalue(false), offset(0), reg(nullptr)
 {
 }
 
@@ -146,23 +144,7 @@ const Symbol *Identifier::symbol() const
  * Description:	Initialize an integer literal, which always has type int.
  */
 
-Integer::Integer(unsigned value)
-    : Expression(Type(INT))
-{
-    stringstream ss;
-
-    ss << value;
-    _value = ss.str();
-}
-
-
-/*
- * Function:	Integer::Integer (constructor)
- *
- * Description:	Initialize an integer literal, which always has type int.
- */
-
-Integer::Integer(const string &value)
+Integer::Integer(int value)
     : Expression(Type(INT)), _value(value)
 {
 }
@@ -174,7 +156,7 @@ Integer::Integer(const string &value)
  * Description:	Return the value of this integer.
  */
 
-const string &Integer::value() const
+int Integer::value() const
 {
     return _value;
 }
@@ -187,22 +169,6 @@ const string &Integer::value() const
  */
 
 Real::Real(double value)
-    : Expression(Type(DOUBLE))
-{
-    stringstream ss;
-
-    ss << value;
-    _value = ss.str();
-}
-
-
-/*
- * Function:	Real::Real (constructor)
- *
- * Description:	Initialize a real literal, which always has type double.
- */
-
-Real::Real(const string &value)
     : Expression(Type(DOUBLE)), _value(value)
 {
 }
@@ -214,7 +180,7 @@ Real::Real(const string &value)
  * Description:	Return the value of this real.
  */
 
-const string &Real::value() const
+double Real::value() const
 {
     return _value;
 }
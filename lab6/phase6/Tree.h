@@ -21,6 +21,7 @@
  *		Tree.cpp - constructors and accessors
  *		allocator.cpp - member functions to do storage allocation
  *		generator.cpp - member functions to do code generation
+ *		lowerer.cpp - member functions to build the intermediate code
  *		writer.cpp - member functions to write the tree to a stream
  */
 
@@ -29,16 +30,22 @@
 # include <string>
 # include <vector>
 # include <ostream>
+# include "Arena.h"
 # include "Scope.h"
 # include "Label.h"
+# include "Register.h"
 
 typedef std::vector<class Statement *> Statements;
 typedef std::vector<class Expression *> Expressions;
 
+class BasicBlock;
+class Instruction;
+class Procedure;
+
 
 /* The base class */
 
-class Node {
+class Node : public Arena::Object {
 protected:
     typedef std::string string;
     typedef std::ostream ostream;
@@ -57,6 +64,9 @@ public:
 class Statement : public Node {
 protected:
     Statement() {}
+
+public:
+    virtual void lower() {}
 };
 
 
@@ -70,10 +80,15 @@ protected:
 
 public:
     int offset;
+    Register *reg;
     const Type &type() const;
     bool lvalue() const;
     virtual void operand(ostream &ostr) const;
-    void test(const Label &label, bool ifTrue);
+    virtual void test(const Label &label, bool ifTrue);
+
+    virtual void lower();
+    virtual Instruction *evaluate();
+    virtual void decide(BasicBlock *ifTrue, BasicBlock *ifFalse);
 
     virtual Expression * isDereference();
 };
@@ -106,6 +121,7 @@ public:
     String(const string &value);
     const string &value() const;
     virtual void operand(ostream &ostr) const;
+    virtual Instruction *evaluate();
     virtual void write(ostream &ostr) const;
 };
 
@@ -118,6 +134,7 @@ class Identifier : public Expression {
 public:
     Identifier(const Symbol *symbol);
     const Symbol *symbol() const;
+    virtual Instruction *evaluate();
     virtual void write(ostream &ostr) const;
     virtual void operand(ostream &ostr) const;
 };
@@ -126,12 +143,12 @@ public:
 /* An integer literal */
 
 class Integer : public Expression {
-    string _value;
+    int _value;
 
 public:
-    Integer(unsigned value);
-    Integer(const string &value);
-    const string &value() const;
+    Integer(int value);
+    int value() const;
+    virtual Instruction *evaluate();
     virtual void write(ostream &ostr) const;
     virtual void operand(ostream &ostr) const;
 };
@@ -140,12 +157,12 @@ public:
 /* A real literal */
 
 class Real : public Expression {
-    string _value;
+    double _value;
 
 public:
     Real(double value);
-    Real(const string &value);
-    const string &value() const;
+    double value() const;
+    virtual Instruction *evaluate();
     virtual void write(ostream &ostr) const;
     virtual void operand(ostream &ostr) const;
 };
@@ -159,6 +176,7 @@ class Call : public Expression {
 
 public:
     Call(const Symbol *id, const Expressions &args, const Type &type);
+    virtual Instruction *evaluate();
     virtual void write(ostream &ostr) const;
     virtual void generate();
 };
@@ -170,6 +188,9 @@ class Not : public Unary {
 public:
     Not(Expression *expr, const Type &type);
     virtual void generate();
+    virtual void test(const Label &label, bool ifTrue);
+    virtual Instruction *evaluate();
+    virtual void decide(BasicBlock *ifTrue, BasicBlock *ifFalse);
     virtual void write(ostream &ostr) const;
 };
 
@@ -180,6 +201,7 @@ class Negate : public Unary {
 public:
     Negate(Expression *expr, const Type &type);
     virtual void generate();
+    virtual Instruction *evaluate();
     virtual void write(ostream &ostr) const;
 };
 
@@ -191,6 +213,7 @@ public:
     Dereference(Expression *expr, const Type &type);
     virtual Expression * isDereference();
     virtual void generate();
+    virtual Instruction *evaluate();
     virtual void write(ostream &ostr) const;
 };
 
@@ -201,6 +224,7 @@ class Address : public Unary {
 public:
     Address(Expression *expr, const Type &type);
     virtual void generate();
+    virtual Instruction *evaluate();
     virtual void write(ostream &ostr) const;
 };
 
@@ -213,6 +237,7 @@ public:
 
     Increment(Expression *expr, const Type &type);
     virtual void generate();
+    virtual Instruction *evaluate();
     virtual void write(ostream &ostr) const;
 };
 
@@ -225,6 +250,7 @@ public:
 
     Decrement(Expression *expr, const Type &type);
     virtual void generate();
+    virtual Instruction *evaluate();
     virtual void write(ostream &ostr) const;
 };
 
@@ -235,6 +261,7 @@ class Cast : public Unary {
 public:
     Cast(const Type &type, Expression *expr);
     virtual void generate();
+    virtual Instruction *evaluate();
     virtual void write(ostream &ostr) const;
 };
 
@@ -245,6 +272,7 @@ class Multiply : public Binary {
 public:
     Multiply(Expression *left, Expression *right, const Type &type);
     virtual void generate();
+    virtual Instruction *evaluate();
     virtual void write(ostream &ostr) const;
 };
 
@@ -255,6 +283,7 @@ class Divide : public Binary {
 public:
     Divide(Expression *left, Expression *right, const Type &type);
     virtual void generate();
+    virtual Instruction *evaluate();
     virtual void write(ostream &ostr) const;
 };
 
@@ -265,6 +294,7 @@ class Remainder : public Binary {
 public:
     Remainder(Expression *left, Expression *right, const Type &type);
     virtual void generate();
+    virtual Instruction *evaluate();
     virtual void write(ostream &ostr) const;
 };
 
@@ -277,6 +307,7 @@ public:
 
     Add(Expression *left, Expression *right, const Type &type);
     virtual void generate();
+    virtual Instruction *evaluate();
     virtual void write(ostream &ostr) const;
 };
 
@@ -289,6 +320,7 @@ public:
 
     Subtract(Expression *left, Expression *right, const Type &type);
     virtual void generate();
+    virtual Instruction *evaluate();
     virtual void write(ostream &ostr) const;
 };
 
@@ -299,6 +331,9 @@ class LessThan : public Binary {
 public:
     LessThan(Expression *left, Expression *right, const Type &type);
     virtual void generate();
+    virtual void test(const Label &label, bool ifTrue);
+    virtual Instruction *evaluate();
+    virtual void decide(BasicBlock *ifTrue, BasicBlock *ifFalse);
     virtual void write(ostream &ostr) const;
 };
 
@@ -309,6 +344,9 @@ class GreaterThan : public Binary {
 public:
     GreaterThan(Expression *left, Expression *right, const Type &type);
     virtual void generate();
+    virtual void test(const Label &label, bool ifTrue);
+    virtual Instruction *evaluate();
+    virtual void decide(BasicBlock *ifTrue, BasicBlock *ifFalse);
     virtual void write(ostream &ostr) const;
 };
 
@@ -319,6 +357,9 @@ class LessOrEqual : public Binary {
 public:
     LessOrEqual(Expression *left, Expression *right, const Type &type);
     virtual void generate();
+    virtual void test(const Label &label, bool ifTrue);
+    virtual Instruction *evaluate();
+    virtual void decide(BasicBlock *ifTrue, BasicBlock *ifFalse);
     virtual void write(ostream &ostr) const;
 };
 
@@ -329,6 +370,9 @@ class GreaterOrEqual : public Binary {
 public:
     GreaterOrEqual(Expression *left, Expression *right, const Type &type);
     virtual void generate();
+    virtual void test(const Label &label, bool ifTrue);
+    virtual Instruction *evaluate();
+    virtual void decide(BasicBlock *ifTrue, BasicBlock *ifFalse);
     virtual void write(ostream &ostr) const;
 };
 
@@ -339,6 +383,9 @@ class Equal : public Binary {
 public:
     Equal(Expression *left, Expression *right, const Type &type);
     virtual void generate();
+    virtual void test(const Label &label, bool ifTrue);
+    virtual Instruction *evaluate();
+    virtual void decide(BasicBlock *ifTrue, BasicBlock *ifFalse);
     virtual void write(ostream &ostr) const;
 };
 
@@ -349,6 +396,9 @@ class NotEqual : public Binary {
 public:
     NotEqual(Expression *left, Expression *right, const Type &type);
     virtual void generate();
+    virtual void test(const Label &label, bool ifTrue);
+    virtual Instruction *evaluate();
+    virtual void decide(BasicBlock *ifTrue, BasicBlock *ifFalse);
     virtual void write(ostream &ostr) const;
 };
 
@@ -359,6 +409,9 @@ class LogicalAnd: public Binary {
 public:
     LogicalAnd(Expression *left, Expression *right, const Type &type);
     virtual void generate();
+    virtual void test(const Label &label, bool ifTrue);
+    virtual Instruction *evaluate();
+    virtual void decide(BasicBlock *ifTrue, BasicBlock *ifFalse);
     virtual void write(ostream &ostr) const;
 };
 
@@ -369,6 +422,9 @@ class LogicalOr : public Binary {
 public:
     LogicalOr(Expression *left, Expression *right, const Type &type);
     virtual void generate();
+    virtual void test(const Label &label, bool ifTrue);
+    virtual Instruction *evaluate();
+    virtual void decide(BasicBlock *ifTrue, BasicBlock *ifFalse);
     virtual void write(ostream &ostr) const;
 };
 
@@ -380,6 +436,7 @@ class Assignment : public Statement {
 
 public:
     Assignment(Expression *left, Expression *right);
+    virtual void lower();
     virtual void write(ostream &ostr) const;
     virtual void generate();
 };
@@ -391,6 +448,7 @@ class Break : public Statement {
 public:
     Break();
     virtual void generate();
+    virtual void lower();
     virtual void write(ostream &ostr) const;
 };
 
@@ -402,6 +460,7 @@ class Return : public Statement {
 
 public:
     Return(Expression *expr);
+    virtual void lower();
     virtual void write(ostream &ostr) const;
     virtual void generate();
 };
@@ -416,6 +475,7 @@ class Block : public Statement {
 public:
     Block(Scope *decls, const Statements &stmts);
     Scope *declarations() const;
+    virtual void lower();
     virtual void write(ostream &ostr) const;
     virtual void allocate(int &offset) const;
     virtual void generate();
@@ -430,6 +490,7 @@ class While : public Statement {
 
 public:
     While(Expression *expr, Statement *stmt);
+    virtual void lower();
     virtual void write(ostream &ostr) const;
     virtual void generate();
     virtual void allocate(int &offset) const;
@@ -446,6 +507,7 @@ class For : public Statement {
 
 public:
     For(Statement *init, Expression *expr, Statement *incr, Statement *stmt);
+    virtual void lower();
     virtual void write(ostream &ostr) const;
     virtual void generate();
     virtual void allocate(int &offset) const;
@@ -460,6 +522,7 @@ class If : public Statement {
 
 public:
     If(Expression *expr, Statement *thenStmt, Statement *elseStmt);
+    virtual void lower();
     virtual void write(ostream &ostr) const;
     virtual void generate();
     virtual void allocate(int &offset) const;
@@ -474,6 +537,7 @@ class Function : public Node {
 
 public:
     Function(const Symbol *id, Block *body);
+    Procedure *lower();
     virtual void write(ostream &ostr) const;
     virtual void allocate(int &offset) const;
     virtual void generate();
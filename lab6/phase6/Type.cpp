@@ -20,12 +20,166 @@
  */
 
 # include <cassert>
+# include <mutex>
+# include <unordered_set>
 # include "tokens.h"
 # include "Type.h"
 
 using namespace std;
 
 
+/*
+ * Structure:	Type::Entry
+ *
+ * Description:	The description of a distinct type in the table of types.
+ *		The promoted and dereferenced types are computed when the
+ *		entry is added, so entries are never written afterwards.
+ */
+
+struct Type::Entry {
+    short declarator, specifier;
+    unsigned indirection;
+    unsigned length;
+    mutable const Parameters *parameters;
+
+    mutable const Entry *promoted, *dereferenced;
+
+    Entry(short declarator, short specifier = 0, unsigned indirection = 0,
+	  unsigned length = 0, const Parameters *parameters = nullptr);
+    bool operator ==(const Entry &rhs) const;
+};
+
+
+/*
+ * Structure:	Type::Hash
+ *
+ * Description:	The hash function for the table of types.  Since the
+ *		parameter types are themselves handles, hashing a function
+ *		type only needs to combine their addresses.
+ */
+
+struct Type::Hash {
+    size_t operator ()(const Entry &entry) const;
+};
+
+
+/*
+ * Function:	Type::Entry::Entry (constructor)
+ *
+ * Description:	Initialize a table entry.
+ */
+
+Type::Entry::Entry(short declarator, short specifier, unsigned indirection,
+		   unsigned length, const Parameters *parameters)
+    : declarator(declarator), specifier(specifier), indirection(indirection),
+      length(length), parameters(parameters), promoted(nullptr),
+      dereferenced(nullptr)
+{
+}
+
+
+/*
+ * Function:	Type::Entry::operator ==
+ *
+ * Description:	Return whether two table entries describe the same type.
+ *		This is the only place where parameter lists are compared,
+ *		and the parameter types are compared as handles.
+ */
+
+bool Type::Entry::operator ==(const Entry &rhs) const
+{
+    if (declarator != rhs.declarator)
+	return false;
+
+    if (declarator == ERROR)
+	return true;
+
+    if (specifier != rhs.specifier || indirection != rhs.indirection)
+	return false;
+
+    if (declarator == SCALAR)
+	return true;
+
+    if (declarator == ARRAY)
+	return length == rhs.length;
+
+    if (parameters->variadic != rhs.parameters->variadic)
+	return false;
+
+    return parameters->types == rhs.parameters->types;
+}
+
+
+/*
+ * Function:	Type::Hash::operator ()
+ *
+ * Description:	Return the hash value of a table entry.
+ */
+
+size_t Type::Hash::operator ()(const Entry &entry) const
+{
+    size_t value;
+
+
+    value = entry.declarator;
+    value = value * 31 + entry.specifier;
+    value = value * 31 + entry.indirection;
+    value = value * 31 + entry.length;
+
+    if (entry.parameters != nullptr) {
+	value = value * 31 + entry.parameters->variadic;
+
+	for (auto &type : entry.parameters->types)
+	    value = value * 31 + hash<const void *>()(type._entry);
+    }
+
+    return value;
+}
+
+
+/*
+ * Function:	Type::intern (private)
+ *
+ * Description:	Return the unique table entry for the given description of
+ *		a type, adding it if necessary.  The elements of an
+ *		unordered set are never moved, so the entries are stable.
+ *		Functions are generated on several threads, so the table
+ *		is guarded by a lock; the lock is recursive since adding an
+ *		entry adds the types to which it promotes and dereferences.
+ *		The parameter list of a new function type is copied, since
+ *		the given entry only refers to the caller's list.
+ */
+
+const Type::Entry *Type::intern(const Entry &entry)
+{
+    static unordered_set<Entry, Hash> table;
+    static recursive_mutex lock;
+    lock_guard<recursive_mutex> guard(lock);
+    auto result = table.insert(entry);
+    const Entry *e = &*result.first;
+
+
+    if (result.second) {
+	if (e->declarator == FUNCTION)
+	    e->parameters = new Parameters(*e->parameters);
+
+	if (e->declarator == SCALAR && e->indirection == 0 && e->specifier == CHAR)
+	    e->promoted = intern(Entry(SCALAR, INT));
+
+	else if (e->declarator == ARRAY)
+	    e->promoted = intern(Entry(SCALAR, e->specifier, e->indirection + 1));
+
+	else
+	    e->promoted = e;
+
+	if (e->declarator == SCALAR && e->indirection > 0)
+	    e->dereferenced = intern(Entry(SCALAR, e->specifier, e->indirection - 1));
+    }
+
+    return e;
+}
+
+
 /*
  * Function:	Type::Type (constructor)
  *
@@ -33,8 +187,10 @@ using namespace std;
  */
 
 Type::Type()
-    : _declarator(ERROR)
 {
+    static const Entry *error = intern(Entry(ERROR));
+
+    _entry = error;
 }
 
 
@@ -45,9 +201,8 @@ Type::Type()
  */
 
 Type::Type(int specifier, unsigned indirection)
-    : _specifier(specifier), _indirection(indirection)
+    : _entry(intern(Entry(SCALAR, specifier, indirection)))
 {
-    _declarator = SCALAR;
 }
 
 
@@ -58,57 +213,48 @@ Type::Type(int specifier, unsigned indirection)
  */
 
 Type::Type(int specifier, unsigned indirection, unsigned length)
-    : _specifier(specifier), _indirection(indirection), _length(length)
+    : _entry(intern(Entry(ARRAY, specifier, indirection, length)))
 {
-    _declarator = ARRAY;
 }
 
 
 /*
  * Function:	Type::Type (constructor)
  *
- * Description:	Initialize this type object as a function type.
+ * Description:	Initialize this type object as a function type.  If the
+ *		same function type already exists, its parameter list is
+ *		shared and the given one is simply not used.
  */
 
-Type::Type(int specifier, unsigned indirection, Parameters *parameters)
-    : _specifier(specifier), _indirection(indirection), _parameters(parameters)
+Type::Type(int specifier, unsigned indirection, const Parameters &parameters)
+    : _entry(intern(Entry(FUNCTION, specifier, indirection, 0, &parameters)))
 {
-    _declarator = FUNCTION;
 }
 
 
 /*
- * Function:	Type::operator ==
+ * Function:	Type::Type (constructor)
  *
- * Description:	Return whether another type is equal to this type.  The
- *		parameter lists are checked for function types, which C++
- *		makes so easy.  (At least, it makes something easy!)
+ * Description:	Initialize this type object from its table entry.
  */
 
-bool Type::operator ==(const Type &rhs) const
+Type::Type(const Entry *entry)
+    : _entry(entry)
 {
-    if (_declarator != rhs._declarator)
-	return false;
-
-    if (_declarator == ERROR)
-	return true;
-
-    if (_specifier != rhs._specifier)
-	return false;
-
-    if (_indirection != rhs._indirection)
-	return false;
-
-    if (_declarator == SCALAR)
-	return true;
+}
 
-    if (_declarator == ARRAY)
-	return _length == rhs._length;
 
-    if (_parameters->variadic != rhs._parameters->variadic)
-	return false;
+/*
+ * Function:	Type::operator ==
+ *
+ * Description:	Return whether another type is equal to this type.  The
+ *		parameter lists were already checked for function types
+ *		when the types were entered in the table.
+ */
 
-    return _parameters->types == rhs._parameters->types;
+bool Type::operator ==(const Type &rhs) const
+{
+    return _entry == rhs._entry;
 }
 
 
@@ -122,7 +268,7 @@ bool Type::operator ==(const Type &rhs) const
 
 bool Type::operator !=(const Type &rhs) const
 {
-    return !operator ==(rhs);
+    return _entry != rhs._entry;
 }
 
 
@@ -134,7 +280,7 @@ bool Type::operator !=(const Type &rhs) const
 
 bool Type::isArray() const
 {
-    return _declarator == ARRAY;
+    return _entry->declarator == ARRAY;
 }
 
 
@@ -146,7 +292,7 @@ bool Type::isArray() const
 
 bool Type::isScalar() const
 {
-    return _declarator == SCALAR;
+    return _entry->declarator == SCALAR;
 }
 
 
@@ -158,7 +304,7 @@ bool Type::isScalar() const
 
 bool Type::isFunction() const
 {
-    return _declarator == FUNCTION;
+    return _entry->declarator == FUNCTION;
 }
 
 
@@ -170,7 +316,7 @@ bool Type::isFunction() const
 
 bool Type::isError() const
 {
-    return _declarator == ERROR;
+    return _entry->declarator == ERROR;
 }
 
 
@@ -182,7 +328,7 @@ bool Type::isError() const
 
 int Type::specifier() const
 {
-    return _specifier;
+    return _entry->specifier;
 }
 
 
@@ -194,7 +340,7 @@ int Type::specifier() const
 
 unsigned Type::indirection() const
 {
-    return _indirection;
+    return _entry->indirection;
 }
 
 
@@ -208,8 +354,8 @@ unsigned Type::indirection() const
 
 unsigned Type::length() const
 {
-    assert(_declarator == ARRAY);
-    return _length;
+    assert(_entry->declarator == ARRAY);
+    return _entry->length;
 }
 
 
@@ -220,10 +366,10 @@ unsigned Type::length() const
  *		function type.
  */
 
-Parameters *Type::parameters() const
+const Parameters *Type::parameters() const
 {
-    assert(_declarator == FUNCTION);
-    return _parameters;
+    assert(_entry->declarator == FUNCTION);
+    return _entry->parameters;
 }
 
 
@@ -235,7 +381,8 @@ Parameters *Type::parameters() const
 
 bool Type::isReal() const
 {
-    return _declarator == SCALAR && _specifier == DOUBLE && _indirection == 0;
+    const Entry *e = _entry;
+    return e->declarator == SCALAR && e->specifier == DOUBLE && e->indirection == 0;
 }
 
 
@@ -248,7 +395,8 @@ bool Type::isReal() const
 
 bool Type::isInteger() const
 {
-    return _declarator == SCALAR && _specifier != DOUBLE && _indirection == 0;
+    const Entry *e = _entry;
+    return e->declarator == SCALAR && e->specifier != DOUBLE && e->indirection == 0;
 }
 
 
@@ -260,7 +408,8 @@ bool Type::isInteger() const
 
 bool Type::isPointer() const
 {
-    return (_declarator == SCALAR && _indirection > 0) || _declarator == ARRAY;
+    const Entry *e = _entry;
+    return (e->declarator == SCALAR && e->indirection > 0) || e->declarator == ARRAY;
 }
 
 
@@ -274,7 +423,7 @@ bool Type::isPointer() const
 
 bool Type::isNumeric() const
 {
-    return _declarator == SCALAR && _indirection == 0;
+    return _entry->declarator == SCALAR && _entry->indirection == 0;
 }
 
 
@@ -317,13 +466,7 @@ bool Type::isCompatibleWith(const Type &that) const
 
 Type Type::promote() const
 {
-    if (_declarator == SCALAR && _indirection == 0 && _specifier == CHAR)
-	return Type(INT, 0);
-
-    if (_declarator == ARRAY)
-	return Type(_specifier, _indirection + 1);
-
-    return *this;
+    return Type(_entry->promoted);
 }
 
 
@@ -336,8 +479,11 @@ Type Type::promote() const
 
 Type Type::deref() const
 {
-    assert(_declarator == SCALAR && _indirection > 0);
-    return Type(_specifier, _indirection - 1);
+    const Entry *e = _entry;
+
+
+    assert(e->declarator == SCALAR && e->indirection > 0);
+    return Type(e->dereferenced);
 }
 
 
@@ -16,6 +16,14 @@
  *		As we've designed them, types are essentially immutable,
  *		since we haven't included any mutators.  In practice, we'll
  *		be creating new types rather than changing existing types.
+ *
+ *		Since they are immutable, each distinct type is kept only
+ *		once in a global table, and a type object is just a handle
+ *		to its entry.  Two types are therefore equal exactly when
+ *		their handles are, and the results of promoting and
+ *		dereferencing a type are remembered in its entry.  The
+ *		parameter list of a function type is copied into the
+ *		table only when the type is first seen.
  */
 
 # ifndef TYPE_H
@@ -31,16 +39,18 @@ struct Parameters {
 class Type {
     enum {ARRAY, ERROR, FUNCTION, SCALAR};
 
-    short _declarator, _specifier;
-    unsigned _indirection;
-    unsigned _length;
-    Parameters *_parameters;
+    struct Entry;
+    struct Hash;
+    const Entry *_entry;
+
+    explicit Type(const Entry *entry);
+    static const Entry *intern(const Entry &entry);
 
 public:
     Type();
     Type(int specifier, unsigned indirection = 0);
     Type(int specifier, unsigned indirection, unsigned length);
-    Type(int specifier, unsigned indirection, Parameters *parameters);
+    Type(int specifier, unsigned indirection, const Parameters &parameters);
 
     bool operator ==(const Type &rhs) const;
     bool operator !=(const Type &rhs) const;
@@ -53,7 +63,7 @@ public:
     int specifier() const;
     unsigned indirection() const;
     unsigned length() const;
-    Parameters *parameters() const;
+    const Parameters *parameters() const;
 
     bool isReal() const;
     bool isInteger() const;
@@ -13,8 +13,9 @@
 # include <cassert>
 # include <iostream>
 # include "checker.h"
-# include "machine.h"
+# include "Target.h"
 # include "tokens.h"
+# include "Timer.h"
 # include "Tree.h"
 
 using namespace std;
@@ -23,7 +24,7 @@ using namespace std;
 /*
  * Function:	Type::size
  *
- * Description:	Return the size of a type in bytes.
+ * Description:	Return the size of a type in bytes on the target machine.
  */
 
 unsigned Type::size() const
@@ -31,20 +32,20 @@ unsigned Type::size() const
     unsigned count;
 
 
-    assert(_declarator != FUNCTION && _declarator != ERROR);
-    count = (_declarator == ARRAY ? _length : 1);
+    assert(isScalar() || isArray());
+    count = (isArray() ? length() : 1);
 
-    if (_indirection > 0)
-	return count * SIZEOF_PTR;
+    if (indirection() > 0)
+	return count * target->sizeofPointer;
 
-    if (_specifier == DOUBLE)
-	return count * SIZEOF_DOUBLE;
+    if (specifier() == DOUBLE)
+	return count * target->sizeofDouble;
 
-    if (_specifier == INT)
-	return count * SIZEOF_INT;
+    if (specifier() == INT)
+	return count * target->sizeofInt;
 
-    if (_specifier == CHAR)
-	return count * SIZEOF_CHAR;
+    if (specifier() == CHAR)
+	return count * target->sizeofChar;
 
     return 0;
 }
@@ -143,23 +144,43 @@ void If::allocate(int &offset) const
  *
  * Description:	Allocate storage for this function and return the number of
  *		bytes required.  The parameters are allocated offsets as
- *		well, starting with the given offset.
+ *		well, starting with the given offset.  On a target that
+ *		passes arguments in registers, those parameters are
+ *		instead given slots below the frame pointer, where the
+ *		prologue stores them, and each parameter passed on the
+ *		stack takes a whole register's worth of space.
  */
 
 void Function::allocate(int &offset) const
 {
-    Parameters *params;
+    Timer::Scope timer(Timer::ALLOCATE);
+    unsigned integers, reals;
+    const Parameters *params;
     Symbols symbols;
+    int local;
 
 
     params = _id->type().parameters();
     symbols = _body->declarations()->symbols();
+    integers = reals = 0;
+    local = 0;
 
     for (unsigned i = 0; i < params->types.size(); i ++) {
-	symbols[i]->offset = offset;
-	offset += params->types[i].promote().size();
+	if (params->types[i].isReal() ? reals ++ < target->realArguments
+		: integers ++ < target->integerArguments) {
+	    local -= target->sizeofRegister;
+	    symbols[i]->offset = local;
+
+	} else if (target->integerArguments > 0) {
+	    symbols[i]->offset = offset;
+	    offset += target->sizeofRegister;
+
+	} else {
+	    symbols[i]->offset = offset;
+	    offset += params->types[i].promote().size();
+	}
     }
 
-    offset = 0;
+    offset = local;
     _body->allocate(offset);
 }
@@ -0,0 +1,152 @@
+#!/bin/sh
+#
+# File:		benchmark.sh
+#
+# Description:	Measure how fast the code generated by scc runs.  Each
+#		example program is first compiled, assembled, linked, and
+#		run on its own input, and its output is checked against
+#		the expected output, ignoring trailing blanks.  The program
+#		is then run repeatedly on a scaled-up workload and the
+#		median, minimum, and maximum times are reported.  Programs
+#		that read their size are given a larger input; qsort has
+#		its array size raised in the source; the others have no
+#		size to scale and mostly measure the cost of starting a
+#		program.
+#
+#		The results are written as CSV so that two versions of the
+#		compiler can be compared, and a previous results file may
+#		be given to print the speedup of each program.
+#
+# Usage:	benchmark.sh [-r runs] [-o results] [-c baseline] [-- scc-options]
+#
+#		The CC environment variable gives the command used to
+#		assemble and link, by default "gcc -m32", or "gcc" if
+#		scc is given -m64.
+
+PATH=/bin:/usr/bin:$PATH
+SCC=${SCC:-./scc}
+case " $* " in
+    *" -m64 "*) CC=${CC:-gcc} ;;
+    *) CC=${CC:-"gcc -m32"} ;;
+esac
+EXAMPLES=${EXAMPLES:-../examples}
+RUNS=11
+RESULTS=benchmark.csv
+BASELINE=
+
+while getopts r:o:c: OPTION; do
+    case $OPTION in
+	r) RUNS=$OPTARG ;;
+	o) RESULTS=$OPTARG ;;
+	c) BASELINE=$OPTARG ;;
+	*) echo "usage: $0 [-r runs] [-o results] [-c baseline] [-- scc-options]" 1>&2
+	   exit 1 ;;
+    esac
+done
+
+shift `expr $OPTIND - 1`
+WORKDIR=`mktemp -d` || exit 1
+trap 'rm -rf $WORKDIR' 0 2
+
+
+#
+# The workloads: the program, the input to give it or "-" for its own
+# input, and a sed script that scales its source or "-" for none.
+#
+
+WORKLOADS='
+fib	32	-
+matrix	600	-
+qsort	-	s/\<20\>/200000/g
+tree	-	-
+double	-	-
+mixed	-	-
+'
+
+
+#
+# Function:	build
+#
+# Description:	Compile the given source file into the given program,
+#		passing any remaining arguments to scc.
+#
+
+build() {
+    SRC=$1 OUT=$2
+    shift 2
+    (ulimit -t 10; $SCC "$@") < $SRC > $OUT.s 2> $OUT.err && $CC -o $OUT $OUT.s
+}
+
+
+echo "program,scale,runs,median_ms,min_ms,max_ms,checksum,status" > $RESULTS
+printf "%-8s %8s %10s %10s %10s  %s\n" program scale median min max status
+
+echo "$WORKLOADS" | while read -r NAME INPUT SCRIPT; do
+    test -z "$NAME" && continue
+    SOURCE=$EXAMPLES/$NAME.c
+    PROGRAM=$WORKDIR/$NAME
+    STATUS=ok
+    sed 's/ *$//' $EXAMPLES/$NAME.out > $WORKDIR/$NAME.out
+
+    if ! build $SOURCE $PROGRAM "$@"; then
+	STATUS=compile-failed
+    elif ! (ulimit -t 10; $PROGRAM < $EXAMPLES/$NAME.in) 2> /dev/null |
+	    sed 's/ *$//' | cmp -s - $WORKDIR/$NAME.out; then
+	STATUS=wrong-output
+    fi
+
+    SCALE=none
+
+    if test "$SCRIPT" != -; then
+	SCALE=`echo "$SCRIPT" | sed 's/.*\/\(.*\)\/.*/\1/'`
+	sed "$SCRIPT" $SOURCE > $WORKDIR/$NAME.big.c
+	build $WORKDIR/$NAME.big.c $PROGRAM "$@" || STATUS=compile-failed
+    fi
+
+    if test "$INPUT" != -; then
+	SCALE=$INPUT
+	echo $INPUT > $WORKDIR/$NAME.in
+    else
+	cp $EXAMPLES/$NAME.in $WORKDIR/$NAME.in 2> /dev/null ||
+	    : > $WORKDIR/$NAME.in
+    fi
+
+    if test $STATUS != ok; then
+	echo "$NAME,$SCALE,0,,,,,$STATUS" >> $RESULTS
+	printf "%-8s %8s %10s %10s %10s  %s\n" $NAME $SCALE - - - $STATUS
+	continue
+    fi
+
+    CHECKSUM=`$PROGRAM < $WORKDIR/$NAME.in | cksum | awk '{ print $1 }'`
+    I=0
+
+    while test $I -lt $RUNS; do
+	START=`date +%s%N`
+	$PROGRAM < $WORKDIR/$NAME.in > /dev/null
+	END=`date +%s%N`
+	echo $START $END
+	I=`expr $I + 1`
+    done | awk '{ print ($2 - $1) / 1e6 }' | sort -n > $WORKDIR/$NAME.times
+
+    awk '{ t[NR] = $1 } END {
+	m = NR % 2 ? t[(NR + 1) / 2] : (t[NR / 2] + t[NR / 2 + 1]) / 2
+	printf "%.3f %.3f %.3f\n", m, t[1], t[NR] }' $WORKDIR/$NAME.times \
+	> $WORKDIR/$NAME.stats
+
+    read MEDIAN MIN MAX < $WORKDIR/$NAME.stats
+    echo "$NAME,$SCALE,$RUNS,$MEDIAN,$MIN,$MAX,$CHECKSUM,$STATUS" >> $RESULTS
+    printf "%-8s %8s %10s %10s %10s  %s\n" $NAME $SCALE $MEDIAN $MIN $MAX $STATUS
+done
+
+echo "results written to $RESULTS"
+
+if test -n "$BASELINE"; then
+    echo
+    printf "%-8s %10s %10s %8s\n" program baseline current speedup
+    awk -F, 'NR == FNR { if (FNR > 1) { old[$1] = $4; sum[$1] = $7 }; next }
+	FNR > 1 && old[$1] != "" && $4 != "" {
+	    printf "%-8s %10.3f %10.3f %7.2fx%s\n", $1, old[$1], $4,
+		($4 > 0 ? old[$1] / $4 : 0),
+		(sum[$1] != $7 ? "  (output differs)" : "")
+	}' $BASELINE $RESULTS
+fi
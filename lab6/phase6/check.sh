@@ -0,0 +1,59 @@
+#!/bin/sh
+#
+# File:		check.sh
+#
+# Description:	Check that scc rejects the erroneous example programs,
+#		and that the optimizer removes dead code.
+#
+#		Each example with an expected error file is compiled with
+#		several jobs, so that functions are still being generated
+#		when the error is found, and must fail within the time
+#		limit with the expected diagnostics.  The abstract syntax
+#		trees that scc writes to standard error are ignored.
+#
+#		Each example with a file of absent lines is compiled with
+#		-O1, and none of those lines may appear in its code.
+#
+# Usage:	check.sh [scc-options]
+
+PATH=/bin:/usr/bin:$PATH
+SCC=${SCC:-./scc}
+EXAMPLES=${EXAMPLES:-../examples}
+STATUS=0
+ERRORS=`mktemp` || exit 1
+CODE=`mktemp` || exit 1
+trap 'rm -f $ERRORS $CODE' 0 2
+
+for FILE in $EXAMPLES/*.err; do
+    BASE=`basename $FILE .err`
+    printf "%s ... " $BASE
+    timeout 10 $SCC -j4 "$@" < $EXAMPLES/$BASE.c > /dev/null 2> $ERRORS
+
+    case $? in
+	0) echo "failed (no error)"; STATUS=1 ;;
+	124) echo "failed (timed out)"; STATUS=1 ;;
+	*) if sed -n 's/.*\(line [0-9]*:\)/\1/p' $ERRORS | cmp -s - $FILE; then
+	       echo ok
+	   else
+	       echo "failed (wrong diagnostics)"
+	       STATUS=1
+	   fi ;;
+    esac
+done
+
+for FILE in $EXAMPLES/*.absent; do
+    BASE=`basename $FILE .absent`
+    printf "%s ... " $BASE
+
+    if ! timeout 10 $SCC -O1 "$@" < $EXAMPLES/$BASE.c > $CODE 2> /dev/null; then
+	echo "failed (compile failed)"
+	STATUS=1
+    elif grep -F -f $FILE $CODE > /dev/null; then
+	echo "failed (dead code remains)"
+	STATUS=1
+    else
+	echo ok
+    fi
+done
+
+exit $STATUS
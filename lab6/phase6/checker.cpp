@@ -8,8 +8,10 @@
  *		- inserting an undeclared symbol with the error type
  *		- scaling the operands and results of pointer arithmetic
  *		- explicit type conversions and promotions
+ *		- folding constant expressions and algebraic identities
  */
 
+# include <climits>
 # include <iostream>
 # include <unordered_set>
 # include "lexer.h"
@@ -18,11 +20,12 @@
 # include "Symbol.h"
 # include "Scope.h"
 # include "Type.h"
+# include "Timer.h"
 
 
 using namespace std;
 
-static unordered_set<string> defined;
+static unordered_set<Name> defined;
 static Scope *outermost, *toplevel;
 static const Type error, character(CHAR), integer(INT), real(DOUBLE);
 
@@ -53,6 +56,276 @@ static void debug(const string &str, const Type &t1, const Type &t2)
 }
 
 
+/*
+ * Function:	literal
+ *
+ * Description:	Return whether the given expression is an integer literal,
+ *		and if so, its value.
+ */
+
+static bool literal(Expression *expr, int &value)
+{
+    Integer *integer = dynamic_cast<Integer *>(expr);
+
+    if (integer == nullptr)
+	return false;
+
+    value = integer->value();
+    return true;
+}
+
+
+/*
+ * Function:	literal
+ *
+ * Description:	Return whether the given expression is a real literal, and
+ *		if so, its value.
+ */
+
+static bool literal(Expression *expr, double &value)
+{
+    Real *real = dynamic_cast<Real *>(expr);
+
+    if (real == nullptr)
+	return false;
+
+    value = real->value();
+    return true;
+}
+
+
+/*
+ * Function:	truth
+ *
+ * Description:	Return whether the given expression is a literal, and if
+ *		so, whether it is nonzero.
+ */
+
+static bool truth(Expression *expr, bool &value)
+{
+    int i;
+    double d;
+
+
+    if (literal(expr, i))
+	value = i != 0;
+    else if (literal(expr, d))
+	value = d != 0;
+    else
+	return false;
+
+    return true;
+}
+
+
+/*
+ * Function:	identity
+ *
+ * Description:	Return whether the given expression is a literal with the
+ *		given value.
+ */
+
+static bool identity(Expression *expr, int value)
+{
+    int i;
+    double d;
+
+    return (literal(expr, i) && i == value) || (literal(expr, d) && d == value);
+}
+
+
+/*
+ * Function:	rvalue
+ *
+ * Description:	Return the given expression, but as something that is not
+ *		an lvalue.  When an operator is folded away to one of its
+ *		operands, "x + 0 = y" must still be rejected.
+ */
+
+static Expression *rvalue(Expression *expr)
+{
+    return expr->lvalue() ? new Cast(expr->type(), expr) : expr;
+}
+
+
+/*
+ * Function:	fold
+ *
+ * Description:	Attempt to evaluate a binary operator at compile time.  If
+ *		both operands are literals, the result is a new literal.
+ *		If one operand is an identity for the operator, the result
+ *		is the other operand.  Otherwise, a null pointer is
+ *		returned and the caller builds the operator node.  Integer
+ *		arithmetic wraps, and division by zero is left for the
+ *		program to discover at run time.
+ */
+
+static Expression *fold(int op, Expression *left, Expression *right,
+			const Type &type)
+{
+    int i1, i2;
+    double d1, d2;
+    bool b1, b2;
+
+
+    if (type == error)
+	return nullptr;
+
+    if (op == AND || op == OR) {
+	if (truth(left, b1)) {
+	    if (op == AND && !b1)
+		return new Integer(0);
+
+	    if (op == OR && b1)
+		return new Integer(1);
+
+	    if (truth(right, b2))
+		return new Integer(b2);
+	}
+
+	return nullptr;
+    }
+
+    if (literal(left, i1) && literal(right, i2)) {
+	unsigned u1 = i1, u2 = i2;
+
+	switch (op) {
+	case '*':
+	    return new Integer(u1 * u2);
+
+	case '/':
+	    if (i2 != 0 && (i1 != INT_MIN || i2 != -1))
+		return new Integer(i1 / i2);
+	    break;
+
+	case '%':
+	    if (i2 != 0 && (i1 != INT_MIN || i2 != -1))
+		return new Integer(i1 % i2);
+	    break;
+
+	case '+':
+	    return new Integer(u1 + u2);
+
+	case '-':
+	    return new Integer(u1 - u2);
+
+	case '<':
+	    return new Integer(i1 < i2);
+
+	case '>':
+	    return new Integer(i1 > i2);
+
+	case LEQ:
+	    return new Integer(i1 <= i2);
+
+	case GEQ:
+	    return new Integer(i1 >= i2);
+
+	case EQL:
+	    return new Integer(i1 == i2);
+
+	case NEQ:
+	    return new Integer(i1 != i2);
+	}
+
+    } else if (literal(left, d1) && literal(right, d2)) {
+	switch (op) {
+	case '*':
+	    return new Real(d1 * d2);
+
+	case '/':
+	    if (d2 != 0)
+		return new Real(d1 / d2);
+	    break;
+
+	case '+':
+	    return new Real(d1 + d2);
+
+	case '-':
+	    return new Real(d1 - d2);
+
+	case '<':
+	    return new Integer(d1 < d2);
+
+	case '>':
+	    return new Integer(d1 > d2);
+
+	case LEQ:
+	    return new Integer(d1 <= d2);
+
+	case GEQ:
+	    return new Integer(d1 >= d2);
+
+	case EQL:
+	    return new Integer(d1 == d2);
+
+	case NEQ:
+	    return new Integer(d1 != d2);
+	}
+    }
+
+    /* Adding a real zero is not an identity, since -0.0 + 0.0 is 0.0. */
+
+    if (op == '*' && identity(right, 1))
+	return rvalue(left);
+
+    if (op == '*' && identity(left, 1))
+	return rvalue(right);
+
+    if (op == '/' && identity(right, 1))
+	return rvalue(left);
+
+    if (op == '+' && !type.isReal() && identity(right, 0))
+	return rvalue(left);
+
+    if (op == '+' && !type.isReal() && identity(left, 0))
+	return rvalue(right);
+
+    if (op == '-' && identity(right, 0))
+	return rvalue(left);
+
+    return nullptr;
+}
+
+
+/*
+ * Function:	add
+ *
+ * Description:	Build an addition expression.  A literal operand of
+ *		pointer arithmetic is scaled here rather than at run time,
+ *		which may leave the entire expression constant.
+ */
+
+static Expression *add(Expression *left, Expression *right, const Type &type,
+		       unsigned scaleLeft, unsigned scaleRight)
+{
+    Expression *expr;
+    int value;
+    Add *node;
+
+
+    if (scaleLeft != 0 && literal(left, value)) {
+	left = new Integer(value * scaleLeft);
+	scaleLeft = 0;
+    }
+
+    if (scaleRight != 0 && literal(right, value)) {
+	right = new Integer(value * scaleRight);
+	scaleRight = 0;
+    }
+
+    if (scaleLeft == 0 && scaleRight == 0)
+	if ((expr = fold('+', left, right, type)) != nullptr)
+	    return expr;
+
+    node = new Add(left, right, type);
+    node->scaleLeft = scaleLeft;
+    node->scaleRight = scaleRight;
+
+    return node;
+}
+
+
 /*
  * Function:	promote
  *
@@ -111,6 +384,9 @@ static Type extend(Expression *&expr, Type type)
 
 static Type convert(Expression *&expr, Type type)
 {
+    double value;
+
+
     if (expr->type() == integer && type == character) {
 	debug("truncating", expr->type(), type);
 	expr = new Cast(type, expr);
@@ -119,7 +395,13 @@ static Type convert(Expression *&expr, Type type)
 
     if (expr->type() == real && (type == integer || type == character)) {
 	debug("truncating", expr->type(), type);
-	expr = new Cast(type, expr);
+
+	if (type == integer && literal(expr, value) &&
+		value > INT_MIN - 1.0 && value < INT_MAX + 1.0)
+	    expr = new Integer((int) value);
+	else
+	    expr = new Cast(type, expr);
+
 	return type;
     }
 
@@ -135,6 +417,9 @@ static Type convert(Expression *&expr, Type type)
 
 Scope *openScope()
 {
+    Timer::Scope timer(Timer::CHECK);
+
+
     toplevel = new Scope(toplevel);
 
     if (outermost == nullptr)
@@ -153,6 +438,7 @@ Scope *openScope()
 
 Scope *closeScope()
 {
+    Timer::Scope timer(Timer::CHECK);
     Scope *old = toplevel;
     toplevel = toplevel->enclosing();
     return old;
@@ -166,10 +452,13 @@ Scope *closeScope()
  *		function is always defined in the outermost scope.
  */
 
-Symbol *defineFunction(const string &name, const Type &type)
+Symbol *defineFunction(const Name &name, const Type &type)
 {
+    Timer::Scope timer(Timer::CHECK);
+
+
     if (defined.count(name) > 0) {
-	report(redefined, name);
+	report(redefined, name.str());
 	return outermost->find(name);
     }
 
@@ -182,24 +471,22 @@ Symbol *defineFunction(const string &name, const Type &type)
  * Function:	declareFunction
  *
  * Description:	Declare a function with the specified NAME and TYPE.  A
- *		function is always declared in the outermost scope.  Any
+ *		function is always declared in the outermost scope, and so
+ *		its symbol is allocated in the global arena.  Any
  *		redeclaration is discarded.
  */
 
-Symbol *declareFunction(const string &name, const Type &type)
+Symbol *declareFunction(const Name &name, const Type &type)
 {
+    Timer::Scope timer(Timer::CHECK);
     Symbol *symbol = outermost->find(name);
 
     if (symbol == nullptr) {
-	symbol = new Symbol(name, type);
+	symbol = new (Arena::global) Symbol(name, type);
 	outermost->insert(symbol);
 
-    } else if (type != symbol->type()) {
-	report(conflicting, name);
-	delete type.parameters();
-
-    } else
-	delete type.parameters();
+    } else if (type != symbol->type())
+	report(conflicting, name.str());
 
     return symbol;
 }
@@ -212,8 +499,9 @@ Symbol *declareFunction(const string &name, const Type &type)
  *		redeclaration is discarded.
  */
 
-Symbol *declareVariable(const string &name, const Type &type)
+Symbol *declareVariable(const Name &name, const Type &type)
 {
+    Timer::Scope timer(Timer::CHECK);
     Symbol *symbol = toplevel->find(name);
 
     if (symbol == nullptr) {
@@ -221,10 +509,10 @@ Symbol *declareVariable(const string &name, const Type &type)
 	toplevel->insert(symbol);
 
     } else if (outermost != toplevel)
-	report(redeclared, name);
+	report(redeclared, name.str());
 
     else if (type != symbol->type())
-	report(conflicting, name);
+	report(conflicting, name.str());
 
     return symbol;
 }
@@ -238,12 +526,13 @@ Symbol *declareVariable(const string &name, const Type &type)
  *		future error messages.
  */
 
-Symbol *checkIdentifier(const string &name)
+Symbol *checkIdentifier(const Name &name)
 {
+    Timer::Scope timer(Timer::CHECK);
     Symbol *symbol = toplevel->lookup(name);
 
     if (symbol == nullptr) {
-	report(undeclared, name);
+	report(undeclared, name.str());
 	symbol = new Symbol(name, error);
 	toplevel->insert(symbol);
     }
@@ -262,6 +551,7 @@ Symbol *checkIdentifier(const string &name)
 
 Expression *checkCall(Symbol *id, Expressions &args)
 {
+    Timer::Scope timer(Timer::CHECK);
     const Type &t = id->type();
     Type result = error;
 
@@ -271,7 +561,7 @@ Expression *checkCall(Symbol *id, Expressions &args)
 	    report(invalid_function);
 
 	else {
-	    Parameters *params = t.parameters();
+	    const Parameters *params = t.parameters();
 	    result = Type(t.specifier(), t.indirection());
 
 	    for (auto &arg : args)
@@ -312,6 +602,7 @@ Expression *checkCall(Symbol *id, Expressions &args)
 
 Expression *checkArray(Expression *left, Expression *right)
 {
+    Timer::Scope timer(Timer::CHECK);
     const Type &t1 = promote(left);
     const Type &t2 = promote(right);
     Type result = error;
@@ -319,8 +610,7 @@ Expression *checkArray(Expression *left, Expression *right)
 
     if (t1 != error && t2 != error) {
 	if (t1.isPointer() && t2 == integer) {
-	    left = new Add(left, right, t1);
-	    static_cast<Add *>(left)->scaleRight = t1.deref().size();
+	    left = add(left, right, t1, 0, t1.deref().size());
 	    result = t1.deref();
 
 	} else
@@ -340,9 +630,12 @@ Expression *checkArray(Expression *left, Expression *right)
 
 Expression *checkNot(Expression *expr)
 {
+    Timer::Scope timer(Timer::CHECK);
     const Type &t = promote(expr);
     Type result = error;
 
+    bool value;
+
 
     if (t != error) {
 	if (t.isPredicate())
@@ -351,6 +644,9 @@ Expression *checkNot(Expression *expr)
 	    report(invalid_operand, "!");
     }
 
+    if (result != error && truth(expr, value))
+	return new Integer(!value);
+
     return new Not(expr, result);
 }
 
@@ -364,8 +660,11 @@ Expression *checkNot(Expression *expr)
 
 Expression *checkNegate(Expression *expr)
 {
+    Timer::Scope timer(Timer::CHECK);
     const Type &t = promote(expr);
     Type result = error;
+    double d;
+    int i;
 
 
     if (t != error) {
@@ -375,6 +674,12 @@ Expression *checkNegate(Expression *expr)
 	    report(invalid_operand, "-");
     }
 
+    if (result != error && literal(expr, i))
+	return new Integer(-(unsigned) i);
+
+    if (result != error && literal(expr, d))
+	return new Real(-d);
+
     return new Negate(expr, result);
 }
 
@@ -388,6 +693,7 @@ Expression *checkNegate(Expression *expr)
 
 Expression *checkDereference(Expression *expr)
 {
+    Timer::Scope timer(Timer::CHECK);
     const Type &t = promote(expr);
     Type result = error;
 
@@ -413,6 +719,7 @@ Expression *checkDereference(Expression *expr)
 
 Expression *checkAddress(Expression *expr)
 {
+    Timer::Scope timer(Timer::CHECK);
     const Type &t = expr->type();
     Type result = error;
 
@@ -437,6 +744,7 @@ Expression *checkAddress(Expression *expr)
 
 Expression *checkIncrement(Expression *expr)
 {
+    Timer::Scope timer(Timer::CHECK);
     const Type &t = expr->type();
     Type result = error;
     unsigned scale = 0;
@@ -467,6 +775,7 @@ Expression *checkIncrement(Expression *expr)
 
 Expression *checkDecrement(Expression *expr)
 {
+    Timer::Scope timer(Timer::CHECK);
     const Type &t = expr->type();
     Type result = error;
     unsigned scale = 0;
@@ -497,6 +806,7 @@ Expression *checkDecrement(Expression *expr)
 
 Expression *checkSizeof(Expression *expr)
 {
+    Timer::Scope timer(Timer::CHECK);
     const Type &t = expr->type();
 
 
@@ -518,6 +828,7 @@ Expression *checkSizeof(Expression *expr)
 
 Expression *checkCast(const Type &type, Expression *expr)
 {
+    Timer::Scope timer(Timer::CHECK);
     const Type &t = expr->type();
     Type result = error;
 
@@ -585,8 +896,11 @@ static Type checkMult(Expression *&left, Expression *&right, const string &op)
 
 Expression *checkMultiply(Expression *left, Expression *right)
 {
+    Timer::Scope timer(Timer::CHECK);
     Type t = checkMult(left, right, "*");
-    return new Multiply(left, right, t);
+    Expression *expr = fold('*', left, right, t);
+
+    return expr != nullptr ? expr : new Multiply(left, right, t);
 }
 
 
@@ -598,8 +912,11 @@ Expression *checkMultiply(Expression *left, Expression *right)
 
 Expression *checkDivide(Expression *left, Expression *right)
 {
+    Timer::Scope timer(Timer::CHECK);
     Type t = checkMult(left, right, "/");
-    return new Divide(left, right, t);
+    Expression *expr = fold('/', left, right, t);
+
+    return expr != nullptr ? expr : new Divide(left, right, t);
 }
 
 
@@ -612,9 +929,11 @@ Expression *checkDivide(Expression *left, Expression *right)
 
 Expression *checkRemainder(Expression *left, Expression *right)
 {
+    Timer::Scope timer(Timer::CHECK);
     const Type &t1 = promote(left);
     const Type &t2 = promote(right);
     Type result = error;
+    Expression *expr;
 
 
     if (t1 != error && t2 != error) {
@@ -624,6 +943,9 @@ Expression *checkRemainder(Expression *left, Expression *right)
 	    report(invalid_operands, "%");
     }
 
+    if ((expr = fold('%', left, right, result)) != nullptr)
+	return expr;
+
     return new Remainder(left, right, result);
 }
 
@@ -640,11 +962,11 @@ Expression *checkRemainder(Expression *left, Expression *right)
 
 Expression *checkAdd(Expression *left, Expression *right)
 {
+    Timer::Scope timer(Timer::CHECK);
     Type t1 = extend(left, right->type());
     Type t2 = extend(right, left->type());
     Type result = error;
     unsigned scaleLeft = 0, scaleRight = 0;
-    Add *add;
 
 
     if (t1 != error && t2 != error) {
@@ -663,11 +985,7 @@ Expression *checkAdd(Expression *left, Expression *right)
 	    report(invalid_operands, "+");
     }
 
-    add = new Add(left, right, result);
-    add->scaleLeft = scaleLeft;
-    add->scaleRight = scaleRight;
-
-    return add;
+    return add(left, right, result, scaleLeft, scaleRight);
 }
 
 
@@ -685,11 +1003,14 @@ Expression *checkAdd(Expression *left, Expression *right)
 
 Expression *checkSubtract(Expression *left, Expression *right)
 {
+    Timer::Scope timer(Timer::CHECK);
     Type t1 = extend(left, right->type());
     Type t2 = extend(right, left->type());
     Type result = error;
     unsigned scaleResult = 0, scaleRight = 0;
+    Expression *expr;
     Subtract *sub;
+    int value;
 
 
     if (t1 != error && t2 != error) {
@@ -708,6 +1029,15 @@ Expression *checkSubtract(Expression *left, Expression *right)
 	    report(invalid_operands, "-");
     }
 
+    if (scaleRight != 0 && literal(right, value)) {
+	right = new Integer(value * scaleRight);
+	scaleRight = 0;
+    }
+
+    if (scaleResult == 0 && scaleRight == 0)
+	if ((expr = fold('-', left, right, result)) != nullptr)
+	    return expr;
+
     sub = new Subtract(left, right, result);
     sub->scaleResult = scaleResult;
     sub->scaleRight = scaleRight;
@@ -751,8 +1081,11 @@ Type checkCompare(Expression *&left, Expression *&right, const string &op)
 
 Expression *checkLessThan(Expression *left, Expression *right)
 {
+    Timer::Scope timer(Timer::CHECK);
     Type t = checkCompare(left, right, "<");
-    return new LessThan(left, right, t);
+    Expression *expr = fold('<', left, right, t);
+
+    return expr != nullptr ? expr : new LessThan(left, right, t);
 }
 
 
@@ -764,8 +1097,11 @@ Expression *checkLessThan(Expression *left, Expression *right)
 
 Expression *checkGreaterThan(Expression *left, Expression *right)
 {
+    Timer::Scope timer(Timer::CHECK);
     Type t = checkCompare(left, right, ">");
-    return new GreaterThan(left, right, t);
+    Expression *expr = fold('>', left, right, t);
+
+    return expr != nullptr ? expr : new GreaterThan(left, right, t);
 }
 
 
@@ -777,8 +1113,11 @@ Expression *checkGreaterThan(Expression *left, Expression *right)
 
 Expression *checkLessOrEqual(Expression *left, Expression *right)
 {
+    Timer::Scope timer(Timer::CHECK);
     Type t = checkCompare(left, right, "<=");
-    return new LessOrEqual(left, right, t);
+    Expression *expr = fold(LEQ, left, right, t);
+
+    return expr != nullptr ? expr : new LessOrEqual(left, right, t);
 }
 
 
@@ -790,8 +1129,11 @@ Expression *checkLessOrEqual(Expression *left, Expression *right)
 
 Expression *checkGreaterOrEqual(Expression *left, Expression *right)
 {
+    Timer::Scope timer(Timer::CHECK);
     Type t = checkCompare(left, right, ">=");
-    return new GreaterOrEqual(left, right, t);
+    Expression *expr = fold(GEQ, left, right, t);
+
+    return expr != nullptr ? expr : new GreaterOrEqual(left, right, t);
 }
 
 
@@ -803,8 +1145,11 @@ Expression *checkGreaterOrEqual(Expression *left, Expression *right)
 
 Expression *checkEqual(Expression *left, Expression *right)
 {
+    Timer::Scope timer(Timer::CHECK);
     Type t = checkCompare(left, right, "==");
-    return new Equal(left, right, t);
+    Expression *expr = fold(EQL, left, right, t);
+
+    return expr != nullptr ? expr : new Equal(left, right, t);
 }
 
 
@@ -816,8 +1161,11 @@ Expression *checkEqual(Expression *left, Expression *right)
 
 Expression *checkNotEqual(Expression *left, Expression *right)
 {
+    Timer::Scope timer(Timer::CHECK);
     Type t = checkCompare(left, right, "!=");
-    return new NotEqual(left, right, t);
+    Expression *expr = fold(NEQ, left, right, t);
+
+    return expr != nullptr ? expr : new NotEqual(left, right, t);
 }
 
 
@@ -856,8 +1204,11 @@ Type checkLogical(Expression *&left, Expression *&right, const string &op)
 
 Expression *checkLogicalAnd(Expression *left, Expression *right)
 {
+    Timer::Scope timer(Timer::CHECK);
     Type t = checkLogical(left, right, "&&");
-    return new LogicalAnd(left, right, t);
+    Expression *expr = fold(AND, left, right, t);
+
+    return expr != nullptr ? expr : new LogicalAnd(left, right, t);
 }
 
 
@@ -869,8 +1220,11 @@ Expression *checkLogicalAnd(Expression *left, Expression *right)
 
 Expression *checkLogicalOr(Expression *left, Expression *right)
 {
+    Timer::Scope timer(Timer::CHECK);
     Type t = checkLogical(left, right, "||");
-    return new LogicalOr(left, right, t);
+    Expression *expr = fold(OR, left, right, t);
+
+    return expr != nullptr ? expr : new LogicalOr(left, right, t);
 }
 
 
@@ -883,6 +1237,7 @@ Expression *checkLogicalOr(Expression *left, Expression *right)
 
 Statement *checkAssignment(Expression *left, Expression *right)
 {
+    Timer::Scope timer(Timer::CHECK);
     const Type &t1 = left->type();
     const Type &t2 = convert(right, left->type());
 
@@ -907,6 +1262,9 @@ Statement *checkAssignment(Expression *left, Expression *right)
 
 void checkBreak(unsigned depth)
 {
+    Timer::Scope timer(Timer::CHECK);
+
+
     if (depth == 0)
 	report(invalid_break);
 }
@@ -922,6 +1280,7 @@ void checkBreak(unsigned depth)
 
 void checkReturn(Expression *&expr, const Type &type)
 {
+    Timer::Scope timer(Timer::CHECK);
     const Type &t = promote(expr);
 
     if (t != error && !t.isCompatibleWith(type))
@@ -939,6 +1298,7 @@ void checkReturn(Expression *&expr, const Type &type)
 
 void checkTest(Expression *&expr)
 {
+    Timer::Scope timer(Timer::CHECK);
     const Type &t = promote(expr);
 
     if (t != error && !t.isPredicate())
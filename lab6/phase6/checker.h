@@ -13,10 +13,10 @@
 Scope *openScope();
 Scope *closeScope();
 
-Symbol *defineFunction(const std::string &name, const Type &type);
-Symbol *declareFunction(const std::string &name, const Type &type);
-Symbol *declareVariable(const std::string &name, const Type &type);
-Symbol *checkIdentifier(const std::string &name);
+Symbol *defineFunction(const Name &name, const Type &type);
+Symbol *declareFunction(const Name &name, const Type &type);
+Symbol *declareVariable(const Name &name, const Type &type);
+Symbol *checkIdentifier(const Name &name);
 
 Expression *checkCall(Symbol *symbol, Expressions &args);
 Expression *checkArray(Expression *left, Expression *right);
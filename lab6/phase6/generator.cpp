@@ -4,32 +4,187 @@
  * Description:	This file contains the public and member function
  *		definitions for the code generator for Simple C.
  *
+ *		Integer and pointer temporaries are kept in registers.
+ *		Since the tree is walked in evaluation order, the live
+ *		range of a temporary starts when its node is generated
+ *		and ends when its parent consumes it, so registers can be
+ *		handed out by a linear scan as the code is emitted.  When
+ *		every register is taken, the value whose range started
+ *		first (and therefore ends last) is spilled to the frame.
+ *		With -fno-regalloc, every temporary is instead written to
+ *		its own stack slot as soon as it is computed.
+ *
+ *		Floating-point arithmetic is done either in the xmm
+ *		registers with SSE2, whose temporaries are allocated just
+ *		as the integer ones are, or on the x87 stack, in which case
+ *		every temporary lives in the frame.  The xmm registers are
+ *		never preserved across a call.
+ *
+ *		Functions are generated in parallel.  Everything that
+ *		changes while generating a function lives in a context
+ *		that belongs to the generating thread, and each function is
+ *		generated into memory.  The code of the functions is then
+ *		written in source order, and their string and real
+ *		literals are merged and written with the globals.
+ *
+ *		Since the labels of a function are named after it, the
+ *		code and literals of a function do not depend on where it
+ *		appears, and with a cache a function whose code was stored
+ *		by an earlier compilation is not generated again.
+ *
+ *		On x86-64, integers are kept in the low halves of the
+ *		registers and operated on with 32-bit instructions, while
+ *		pointers use the full registers.  Arguments are passed as
+ *		the System V ABI requires.
+ *
+ *		The code of each function is rewritten by the peephole
+ *		optimizer before it is kept, unless -fno-peephole is given.
+ *
+ *		When optimizing for i386, a function is instead lowered to
+ *		intermediate code, optimized, and translated by the
+ *		instruction selector.
+ *
  *		Extra functionality:
  *		- putting all the global declarations at the end
+ *		- register allocation for expression temporaries
+ *		- parallel code generation
+ *		- caching the code of each function
+ *		- peephole optimization
+ *		- an optimizer over SSA-form intermediate code
  */
 
+# include <algorithm>
+# include <atomic>
 # include <cassert>
+# include <condition_variable>
+# include <cstdlib>
+# include <deque>
+# include <iomanip>
 # include <iostream>
+# include <limits>
+# include <map>
+# include <mutex>
+# include <sstream>
+# include <thread>
+# include <unordered_map>
+# include <unistd.h>
 # include "generator.h"
-# include "machine.h"
+# include "optimizer.h"
+# include "peephole.h"
+# include "Register.h"
+# include "selector.h"
+# include "Target.h"
+# include "Timer.h"
 # include "Tree.h"
 # include "string.h"
-# include <unordered_map>
 
 # define FP(expr) ((expr)->type().isReal())
 # define BYTE(expr) ((expr)->type().size() == 1)
+# define LONG_MODE (target->sizeofRegister == 8)
 
 using namespace std;
 
-static int offset;
-static unsigned max_args;
+bool regalloc = true;
+bool peephole = true;
+bool wholeProgram = false;
+bool sse = false;
+unsigned jobs = 1;
+Emitter output(STDOUT_FILENO);
+
+/*
+ * The state of generating a single function, including the string and
+ * real literals it uses.
+ */
+
+struct Context {
+  int offset;
+  unsigned max_args;
+  Label globalReturn;
+  vector<Label> breaks;
+  vector<Register *> active;
+  vector<Register *> used;
+  map<string, Label> m1;
+  map<string, Label> m2;
+};
+
+static thread_local Context *context;
+static thread_local Emitter out;
+
+static thread_local Register *eax = new Register("%rax", "%eax", "%al");
+static thread_local Register *ecx = new Register("%rcx", "%ecx", "%cl");
+static thread_local Register *edx = new Register("%rdx", "%edx", "%dl");
+static thread_local Register *ebx = new Register("%rbx", "%ebx", "%bl", true);
+static thread_local Register *esi = new Register("%rsi", "%esi", LONG_MODE ? "%sil" : "", !LONG_MODE);
+static thread_local Register *edi = new Register("%rdi", "%edi", LONG_MODE ? "%dil" : "", !LONG_MODE);
+static thread_local Register *ebp = new Register("%rbp", "%ebp", "");
+static thread_local Register *esp = new Register("%rsp", "%esp", "");
+
+static thread_local Register *r8 = new Register("%r8", "%r8d", "%r8b");
+static thread_local Register *r9 = new Register("%r9", "%r9d", "%r9b");
+static thread_local Register *r10 = new Register("%r10", "%r10d", "%r10b");
+static thread_local Register *r11 = new Register("%r11", "%r11d", "%r11b");
+static thread_local Register *r12 = new Register("%r12", "%r12d", "%r12b", true);
+static thread_local Register *r13 = new Register("%r13", "%r13d", "%r13b", true);
+static thread_local Register *r14 = new Register("%r14", "%r14d", "%r14b", true);
+static thread_local Register *r15 = new Register("%r15", "%r15d", "%r15b", true);
+
+static thread_local vector<Register *> registers = LONG_MODE
+  ? vector<Register *> {r10, r11, r8, r9, ecx, edx, esi, edi, ebx, r12, r13, r14, r15}
+  : vector<Register *> {ecx, edx, ebx, esi, edi};
+
+static thread_local vector<Register *> scratch = LONG_MODE
+  ? vector<Register *> {r10, r11}
+  : vector<Register *> {ecx, edx};
+
+static thread_local vector<Register *> arguments = {edi, esi, edx, ecx, r8, r9};
+
+static thread_local vector<Register *> xmm = [] {
+  vector<Register *> regs;
+
+  for (unsigned i = 0; i < 16; i ++) {
+    string name = "%xmm" + to_string(i);
+    regs.push_back(new Register(name, name, ""));
+  }
+
+  return regs;
+}();
+
+static thread_local vector<Register *> fpregisters = LONG_MODE
+  ? vector<Register *> {xmm[8], xmm[9], xmm[10], xmm[11], xmm[12], xmm[13], xmm[14],
+      xmm[15], xmm[1], xmm[2], xmm[3], xmm[4], xmm[5], xmm[6], xmm[7]}
+  : vector<Register *> (xmm.begin() + 1, xmm.begin() + 8);
 
-static Label globalReturn;
+static thread_local vector<Register *> fpscratch = {xmm[1], xmm[2]};
 
-static unordered_map<string, Label> m1;
-static unordered_map<string, Label> m2;
+/*
+ * A function waiting to be generated or written, and its results.  The
+ * arena holding the function is released once it has been written.  The
+ * literals map each value to the text of its label.  A job with a key
+ * stores its results in the cache.
+ */
 
-static vector<Label> breaks;
+struct Job {
+  Function *function;
+  Arena *arena;
+  Name name;
+  Mentions mentions;
+  Digest key;
+  bool keyed;
+  string code;
+  map<string, string> m1;
+  map<string, string> m2;
+  atomic<bool> done;
+};
+
+static deque<Job *> waiting, pending;
+static vector<Job *> held;
+static vector<thread> workers;
+static mutex queue;
+static condition_variable ready, finished;
+static bool stopping;
+
+static map<string, vector<string>> strings;
+static map<string, vector<string>> reals;
 
 /*
  * Function:	align (private)
@@ -39,10 +194,35 @@ static vector<Label> breaks;
  */
 
 static int align(int offset) {
-  if (offset % STACK_ALIGNMENT == 0)
+  if (offset % target->stackAlignment == 0)
     return 0;
 
-  return STACK_ALIGNMENT - (abs(offset) % STACK_ALIGNMENT);
+  return target->stackAlignment - (abs(offset) % target->stackAlignment);
+}
+
+
+/*
+ * Function:	width (private)
+ *
+ * Description:	Return the size of the value of an integer or pointer
+ *		expression.  Characters are sign-extended to integers, and
+ *		an array stands for its address.
+ */
+
+static unsigned width(Expression *expr) {
+  return expr->type().promote().size();
+}
+
+
+/*
+ * Function:	suffix (private)
+ *
+ * Description:	Return the suffix of an instruction operating on a value of
+ *		the given size.
+ */
+
+static char suffix(unsigned size) {
+  return size == 8 ? 'q' : 'l';
 }
 
 
@@ -50,10 +230,17 @@ static int align(int offset) {
  * Function:	operator << (private)
  *
  * Description:	Convenience function for writing the operand of an
- *		expression using the output stream operator.
+ *		expression using the output stream operator.  An expression
+ *		whose value is in a register is written as that register.
  */
 
 static ostream &operator <<(ostream &ostr, Expression *expr) {
+  if (expr->reg != nullptr)
+    return ostr << expr->reg->name(width(expr));
+
+  if (expr->offset != 0)
+    return ostr << expr->offset << "(" << ebp << ")";
+
   expr->operand(ostr);
   return ostr;
 }
@@ -67,7 +254,19 @@ static ostream &operator <<(ostream &ostr, Expression *expr) {
 
 void Expression::operand(ostream &ostr) const {
   assert(offset != 0);
-  ostr << offset << "(%ebp)";
+  ostr << offset << "(" << ebp << ")";
+}
+
+
+/*
+ * Function:	global (private)
+ *
+ * Description:	Write the rest of the operand for a global name, which on
+ *		x86-64 is addressed relative to the instruction pointer.
+ */
+
+static ostream &global(ostream &ostr) {
+  return LONG_MODE ? ostr << "(%rip)" : ostr;
 }
 
 
@@ -79,9 +278,9 @@ void Expression::operand(ostream &ostr) const {
 
 void Identifier::operand(ostream &ostr) const {
   if (_symbol->offset == 0)
-    ostr << global_prefix << _symbol->name();
+    ostr << target->globalPrefix << _symbol->name() << global;
   else
-    ostr << _symbol->offset << "(%ebp)";
+    ostr << _symbol->offset << "(" << ebp << ")";
 }
 
 
@@ -95,43 +294,495 @@ void Integer::operand(ostream &ostr) const {
   ostr << "$" << _value;
 }
 
+/*
+ * Function:	constant
+ *
+ * Description:	Write the label of a string literal with the given value
+ *		to the specified stream.
+ */
+
+void constant(ostream &ostr, const string &text) {
+  map<string,Label>::const_iterator found = context->m1.find(text);
+
+  if (found == context->m1.end())
+    found = context->m1.insert({text, Label()}).first;
+
+  ostr << found->second << global;
+}
+
 void String::operand(ostream &ostr) const {
-  Label my_string;
-  unordered_map<string,Label>::const_iterator found = m1.find(_value);
-  // Label found = m1.find(_value);
-  if (found!=m1.end()) {  // found
-    my_string = found->second;
+  constant(ostr, _value);
+}
+
+
+/*
+ * Function:	constant
+ *
+ * Description:	Write the label of a real literal with the given value to
+ *		the specified stream.
+ */
+
+void constant(ostream &ostr, double number) {
+  stringstream ss;
+
+  ss << setprecision(numeric_limits<double>::max_digits10) << number;
+  string value = ss.str();
+  map<string,Label>::const_iterator found = context->m2.find(value);
+
+  if (found == context->m2.end())
+    found = context->m2.insert({value, Label()}).first;
+
+  ostr << found->second << global;
+}
+
+void Real::operand(ostream &ostr) const {
+  constant(ostr, _value);
+}
+
+
+/*
+ * Function:	assigntemp (private)
+ *
+ * Description:	Give the expression its own temporary slot in the stack
+ *		frame.  Integer values always occupy a full register's
+ *		worth of space.
+ */
+
+static void assigntemp(Expression *expr) {
+  context->offset -= (FP(expr) ? target->sizeofDouble : target->sizeofRegister);
+  expr->offset = context->offset;
+}
+
+
+/*
+ * Function:	assign (private)
+ *
+ * Description:	Record that the given register holds the value of the
+ *		given expression.  Either may be null to break an existing
+ *		association.
+ */
+
+static void assign(Expression *expr, Register *reg) {
+  if (expr != nullptr && expr->reg != nullptr) {
+    context->active.erase(find(context->active.begin(), context->active.end(), expr->reg));
+    expr->reg->node = nullptr;
   }
-  else {
-    // my_string = Label();
-    m1.insert({_value, my_string});
+
+  if (reg != nullptr && reg->node != nullptr) {
+    context->active.erase(find(context->active.begin(), context->active.end(), reg));
+    reg->node->reg = nullptr;
+  }
+
+  if (expr != nullptr)
+    expr->reg = reg;
+
+  if (reg != nullptr) {
+    reg->node = expr;
+
+    if (expr != nullptr) {
+      context->active.push_back(reg);
+
+      if (reg->callee() && find(context->used.begin(), context->used.end(), reg) == context->used.end())
+        context->used.push_back(reg);
+    }
   }
+}
+
+
+/*
+ * Function:	release (private)
+ *
+ * Description:	End the live range of an expression's value, freeing any
+ *		register holding it.
+ */
 
-  ostr << ".L" <<my_string.number();
-  // ostr << leal << my_string << ", %eax" << endl;
+static void release(Expression *expr) {
+  assign(expr, nullptr);
 }
 
-void Real::operand(ostream &ostr) const {
-  Label my_string;
-  unordered_map<string,Label>::const_iterator found = m2.find(_value);
-  // Label found = m1.find(_value);
-  if (found!=m2.end()) {  // found
-    my_string = found->second;
+
+/*
+ * Function:	spill (private)
+ *
+ * Description:	Write the value held in the given register to a new
+ *		temporary in the stack frame, freeing the register.
+ */
+
+static void spill(Register *reg) {
+  Expression *expr = reg->node;
+
+  if (expr != nullptr) {
+    assigntemp(expr);
+
+    if (FP(expr))
+      out << "\tmovsd\t" << expr << ", ";
+    else
+      out << "\tmov" << suffix(width(expr)) << "\t" << expr << ", ";
+
+    out << expr->offset << "(" << ebp << ")\n";
+    release(expr);
+  }
+}
+
+
+/*
+ * Function:	pool (private)
+ *
+ * Description:	Return the allocatable registers for integers and pointers,
+ *		or for floating-point values.
+ */
+
+static const vector<Register *> &pool(bool fp) {
+  if (fp)
+    return regalloc ? fpregisters : fpscratch;
+
+  return regalloc ? registers : scratch;
+}
+
+
+/*
+ * Function:	findreg (private)
+ *
+ * Description:	Return a free allocatable register, optionally one that
+ *		survives function calls or one for a floating-point value,
+ *		or null if there is none.
+ */
+
+static Register *findreg(bool callee = false, bool fp = false) {
+  for (auto reg : pool(fp))
+    if (reg->node == nullptr && (!callee || reg->callee()))
+      return reg;
+
+  return nullptr;
+}
+
+
+/*
+ * Function:	getreg (private)
+ *
+ * Description:	Return a free allocatable register, by default one for an
+ *		integer or pointer.  If all of them are in use, the value
+ *		of the same kind that has been live the longest is spilled.
+ */
+
+static Register *getreg(bool fp = false) {
+  Register *reg = findreg(false, fp);
+
+  if (reg == nullptr) {
+    for (auto active : context->active)
+      if (FP(active->node) == fp) {
+        reg = active;
+        break;
+      }
+
+    assert(reg != nullptr);
+    spill(reg);
+  }
+
+  return reg;
+}
+
+
+/*
+ * Function:	evict (private)
+ *
+ * Description:	Free the given register so that it can be clobbered.  Its
+ *		value is moved to another free register if one exists and
+ *		otherwise spilled.
+ */
+
+static void evict(Register *reg, bool callee = false) {
+  Expression *expr = reg->node;
+  Register *other;
+
+  if (expr != nullptr) {
+    other = findreg(callee, FP(expr));
+
+    if (other != nullptr) {
+      if (FP(expr))
+        out << "\tmovapd\t" << reg << ", " << other << '\n';
+      else
+        out << "\tmov" << suffix(target->sizeofRegister) << "\t" << reg << ", " << other << '\n';
+
+      assign(expr, other);
+    } else
+      spill(reg);
+  }
+}
+
+
+/*
+ * Function:	move (private)
+ *
+ * Description:	Emit an instruction to copy the value of an expression
+ *		into the given register.  Characters in memory are
+ *		sign-extended; those in registers already are.
+ */
+
+static void move(Expression *expr, Register *reg) {
+  if (expr->reg == reg)
+    return;
+
+  if (FP(expr))
+    out << (expr->reg != nullptr ? "\tmovapd\t" : "\tmovsd\t") << expr << ", " << reg << '\n';
+  else if (BYTE(expr) && expr->reg == nullptr)
+    out << "\tmovsbl\t" << expr << ", " << reg->name(4) << '\n';
+  else
+    out << "\tmov" << suffix(width(expr)) << "\t" << expr << ", " << reg->name(width(expr)) << '\n';
+}
+
+
+/*
+ * Function:	load (private)
+ *
+ * Description:	Make sure the value of an expression is in a register and
+ *		return the register.  If a register is given, the value is
+ *		put there; otherwise any register of the right kind will
+ *		do.
+ */
+
+static Register *load(Expression *expr, Register *reg = nullptr) {
+  if (reg == nullptr) {
+    if (expr->reg != nullptr)
+      return expr->reg;
+
+    reg = getreg(FP(expr));
+  }
+
+  if (expr->reg != reg) {
+    if (reg->node != nullptr)
+      evict(reg);
+
+    move(expr, reg);
+    assign(expr, reg);
+  }
+
+  return reg;
+}
+
+
+/*
+ * Function:	define (private)
+ *
+ * Description:	Start the live range of an expression whose value has just
+ *		been computed into the given register.  Without register
+ *		allocation, the value goes straight to a stack temporary.
+ */
+
+static void define(Expression *expr, Register *reg) {
+  assign(expr, reg);
+
+  if (!regalloc)
+    spill(reg);
+}
+
+
+/*
+ * Function:	byteable (private)
+ *
+ * Description:	Return a register whose low byte holds the low byte of the
+ *		given register.  Since esi and edi have no byte form, their
+ *		value is copied to eax.
+ */
+
+static Register *byteable(Register *reg) {
+  if (reg->name(1).empty()) {
+    out << "\tmovl\t" << reg->name(4) << ", " << eax->name(4) << '\n';
+    return eax;
+  }
+
+  return reg;
+}
+
+
+/*
+ * Function:	compare (private)
+ *
+ * Description:	Compare the value of an expression against zero, leaving
+ *		the result in the flags.  A floating-point value that is
+ *		not a number compares as unordered, which sets the zero
+ *		flag as for equality but also sets the parity flag.
+ */
+
+static void compare(Expression *expr) {
+  if (FP(expr) && sse) {
+    out << "\txorpd\t%xmm0, %xmm0\n";
+    out << "\tucomisd\t" << expr << ", %xmm0\n";
+  }
+  else if (FP(expr)) {
+    out << "\tfldl\t" << expr << '\n';
+    out << "\tftst\t\n";
+    out << "\tfnstsw\t" << "%ax\n";
+    out << "\tfstp\t" << "%st(0)\n";
+    out << "\tsahf\t\n";
+  }
+  else if (expr->reg == nullptr && dynamic_cast<Integer *>(expr) != nullptr) {
+    out << "\tmovl\t" << expr << ", %eax\n";
+    out << "\tcmpl\t$0, %eax\n";
+  }
+  else
+    out << "\tcmp" << suffix(width(expr)) << "\t$0, " << expr << '\n';
+}
+
+
+/*
+ * Function:	fpequal (private)
+ *
+ * Description:	Set %al to whether the last floating-point comparison found
+ *		its operands equal, or unequal, as given.  An unordered
+ *		result is unequal, so the parity flag is combined with the
+ *		zero flag.
+ */
+
+static void fpequal(bool equal) {
+  if (equal) {
+    out << "\tsete\t" << "%al\n";
+    out << "\tsetnp\t" << "%ah\n";
+    out << "\tandb\t" << "%ah, %al\n";
+  }
+  else {
+    out << "\tsetne\t" << "%al\n";
+    out << "\tsetp\t" << "%ah\n";
+    out << "\torb\t" << "%ah, %al\n";
+  }
+}
+
+
+/*
+ * Function:	fpjump (private)
+ *
+ * Description:	Branch to the label if the last floating-point comparison
+ *		found its operands equal, or unequal, as given.  The two
+ *		cases are exact opposites, with an unordered result taken
+ *		as unequal.
+ */
+
+static void fpjump(const Label &label, bool equal) {
+  Label skip;
+
+  if (equal) {
+    out << "\tjp\t" << skip << '\n';
+    out << "\tje\t" << label << '\n';
+    out << skip << ":\n";
   }
   else {
-    // my_string = Label();
-    m2.insert({_value, my_string});
+    out << "\tjne\t" << label << '\n';
+    out << "\tjp\t" << label << '\n';
   }
+}
+
+
+/*
+ * Function:	statement (private)
+ *
+ * Description:	Generate code for a statement.  No value may be live
+ *		across statements, so the result of an expression statement
+ *		is discarded.
+ */
+
+static void statement(Statement *stmt) {
+  Expression *expr;
+
+  stmt->generate();
+  expr = dynamic_cast<Expression *>(stmt);
+
+  if (expr != nullptr)
+    release(expr);
+
+  assert(context->active.empty());
+}
+
+
+/*
+ * Function:	place (private)
+ *
+ * Description:	Write the value of a floating-point argument to the given
+ *		offset on the stack.
+ */
 
-  ostr << ".L" <<my_string.number();
-  // ostr << leal << my_string << ", %eax" << endl;
+static void place(Expression *arg, unsigned offset) {
+  if (!sse) {
+    out << "\tfldl\t" << arg << '\n';
+    out << "\tfstpl\t" << offset << "(" << esp << ")\n";
+  } else if (arg->reg != nullptr)
+    out << "\tmovsd\t" << arg << ", " << offset << "(" << esp << ")\n";
+  else {
+    out << "\tmovsd\t" << arg << ", %xmm0\n";
+    out << "\tmovsd\t%xmm0, " << offset << "(" << esp << ")\n";
+  }
 }
 
-void assigntemp(Expression *expr) {
-  offset -= expr->type().size();
-  expr->offset = offset;
+
+/*
+ * Function:	pass (private)
+ *
+ * Description:	Move the arguments of a call into place as the System V
+ *		ABI requires and return the number of bytes they occupy on
+ *		the stack.  The first integer and pointer arguments go in
+ *		registers, as do the first floating-point arguments, and
+ *		the rest go on the stack in order.  Once the stack
+ *		arguments are written, every caller-saved register must be
+ *		free except for arguments already in their own registers,
+ *		so loading one argument cannot clobber another.
+ */
+
+static unsigned pass(const Expressions &args, unsigned &reals) {
+  vector<Register *> dests(args.size(), nullptr);
+  unsigned i, integers, offset;
+
+  integers = reals = offset = 0;
+
+  for (i = 0; i < args.size(); i ++) {
+    Expression *arg = args[i];
+
+    if (FP(arg) && reals < target->realArguments)
+      reals ++;
+    else if (!FP(arg) && integers < target->integerArguments)
+      dests[i] = arguments[integers ++];
+    else {
+      if (FP(arg))
+        place(arg, offset);
+      else if (arg->reg != nullptr || dynamic_cast<Integer *>(arg) != nullptr)
+        out << "\tmov" << suffix(width(arg)) << "\t" << arg << ", " << offset << "(" << esp << ")\n";
+      else {
+        move(arg, eax);
+        out << "\tmov" << suffix(width(arg)) << "\t" << eax->name(width(arg));
+        out << ", " << offset << "(" << esp << ")\n";
+      }
+
+      release(arg);
+      offset += target->sizeofRegister;
+    }
+  }
+
+  for (auto reg : (regalloc ? registers : scratch))
+    if (!reg->callee() && reg->node != nullptr) {
+      i = find(args.begin(), args.end(), reg->node) - args.begin();
+
+      if (i == args.size())
+        evict(reg, true);
+      else if (dests[i] != reg && find(arguments.begin(), arguments.end(), reg) != arguments.end())
+        spill(reg);
+    }
+
+  for (i = 0; i < xmm.size(); i ++)
+    if (xmm[i]->node != nullptr)
+      if (i < target->realArguments || find(args.begin(), args.end(), xmm[i]->node) == args.end())
+        spill(xmm[i]);
+
+  for (i = 0, reals = 0; i < args.size(); i ++)
+    if (dests[i] != nullptr)
+      move(args[i], dests[i]);
+    else if (FP(args[i]) && reals < target->realArguments)
+      move(args[i], xmm[reals ++]);
+
+  for (auto arg : args)
+    release(arg);
+
+  return offset;
 }
 
+
 /*
  * Function:	Call::generate
  *
@@ -139,807 +790,1705 @@ void assigntemp(Expression *expr) {
  */
 
 void Call::generate() {
-  unsigned offset, size;
+  unsigned offset, size, reals;
+  Register *reg;
 
   /* Generate code for all arguments first. */
 
   for (auto arg : _args)
     arg->generate();
 
-  /* Move the arguments onto the stack. */
+  if (target->integerArguments > 0) {
+    offset = pass(_args, reals);
+    out << "\tmovl\t$" << reals << ", %eax\n";
+
+  } else {
+
+    /* Move the arguments onto the stack. */
+
+    offset = 0;
+
+    for (auto arg : _args) {
+      if (FP(arg))
+        place(arg, offset);
+      else if (arg->reg != nullptr || dynamic_cast<Integer *>(arg) != nullptr)
+        out << "\tmovl\t" << arg << ", " << offset << "(%esp)\n";
+      else {
+        out << "\tmovl\t" << arg << ", %eax\n";
+        out << "\tmovl\t%eax, " << offset << "(%esp)\n";
+      }
+
+      release(arg);
+      size = arg->type().size();
+      offset += size;
+    }
+
+    /* Values in caller-saved registers must survive the call. */
+
+    evict(ecx, true);
+    evict(edx, true);
+
+    for (auto reg : xmm)
+      spill(reg);
+  }
+
+  if (offset > context->max_args)
+    context->max_args = offset;
+
+  /* Make the function call. */
+
+  out << "\tcall\t" << target->globalPrefix << _id->name() << '\n';
+
+  /* Save the return value */
+
+  if (FP(this) && LONG_MODE && sse) {
+    reg = getreg(true);
+    out << "\tmovapd\t%xmm0, " << reg << '\n';
+    define(this, reg);
+  }
+  else if (FP(this)) {
+    assigntemp(this);
+
+    if (LONG_MODE)
+      out << "\tmovsd\t%xmm0, " << this << '\n';
+    else
+      out << "\tfstpl\t" << this << '\n';
+  }
+  else {
+    reg = getreg();
+
+    if (BYTE(this))
+      out << "\tmovsbl\t%al, " << reg->name(4) << '\n';
+    else
+      out << "\tmov" << suffix(width(this)) << "\t" << eax->name(width(this)) << ", " << reg->name(width(this)) << '\n';
+
+    define(this, reg);
+  }
+}
+
+
+/*
+ * Function:	Block::generate
+ *
+ * Description:	Generate code for this block, which simply means we
+ *		generate code for each statement within the block.
+ */
+
+void Block::generate() {
+  for (auto stmt : _stmts) {
+    statement(stmt);
+  }
+}
+
+
+/*
+ * Function:	Function::generate
+ *
+ * Description:	Generate code for this function.  The body is generated
+ *		first so that we know which callee-saved registers it uses
+ *		before writing the prologue.  Parameters passed in
+ *		registers are stored in their slots by the prologue.  When
+ *		optimizing for i386, the optimized intermediate code is
+ *		translated instead.
+ */
+
+void Function::generate() {
+  Timer::Scope timer(Timer::GENERATE, &_id->name().str());
+
+  if (optimization > 0 && !LONG_MODE) {
+    Procedure *proc = lower();
+    optimizeProcedure(*proc);
+    selectInstructions(*proc, out);
+    delete proc;
+    return;
+  }
+
+  int &offset = context->offset;
+  const Symbols &params = _body->declarations()->symbols();
+  const vector<Type> &types = _id->type().parameters()->types;
+  unsigned integers, reals, size;
+  char word = suffix(target->sizeofRegister);
+
+  Label::begin(_id->name().str());
+  context->globalReturn = Label();
+  context->max_args = 0;
+  offset = target->sizeofRegister * 2;
+  allocate(offset);
+
+  context->active.clear();
+  context->used.clear();
+
+  /* Generate the body of this function. */
+
+  size_t start = out.hold();
+  _body->generate();
+
+  /* Compute the proper stack frame size. */
+
+  vector<int> slots;
+
+  for (unsigned i = 0; i < context->used.size(); i ++) {
+    offset -= target->sizeofRegister;
+    slots.push_back(offset);
+  }
+
+  offset -= context->max_args;
+  offset -= align(offset - target->sizeofRegister * 2);
+
+  /* Generate our prologue in front of the body. */
+
+  stringstream prologue;
+
+  if (out.comments())
+    prologue << "#Prologue\n";
+
+  prologue << target->globalPrefix << _id->name() << ":\n";
+  prologue << "\tpush" << word << "\t" << ebp << "\n";
+  prologue << "\tmov" << word << "\t" << esp << ", " << ebp << "\n";
+  prologue << "\tsub" << word << "\t$" << _id->name() << ".size, " << esp << "\n";
+
+  for (unsigned i = 0; i < context->used.size(); i ++)
+    prologue << "\tmov" << word << "\t" << context->used[i] << ", " << slots[i] << "(" << ebp << ")\n";
+
+  integers = reals = 0;
+
+  for (unsigned i = 0; i < types.size(); i ++)
+    if (params[i]->offset < 0 && types[i].isReal())
+      prologue << "\tmovsd\t%xmm" << reals ++ << ", " << params[i]->offset << "(" << ebp << ")\n";
+    else if (params[i]->offset < 0) {
+      size = types[i].promote().size();
+      prologue << "\tmov" << suffix(size) << "\t" << arguments[integers ++]->name(size);
+      prologue << ", " << params[i]->offset << "(" << ebp << ")\n";
+    }
+
+  out.splice(start, prologue.str());
+  out.release();
+
+  /* Generate our epilogue. */
+
+  out << context->globalReturn << ": \n";
+  out.comment("Epilogue");
+
+  for (unsigned i = 0; i < context->used.size(); i ++)
+    out << "\tmov" << word << "\t" << slots[i] << "(" << ebp << "), " << context->used[i] << '\n';
+
+  out << "\tmov" << word << "\t" << ebp << ", " << esp << "\n";
+  out << "\tpop" << word << "\t" << ebp << "\n";
+  out << "\tret" << "\n\n";
+
+  out << "\t.set\t" << _id->name() << ".size, " << -offset << '\n';
+  out << "\t.globl\t" << target->globalPrefix << _id->name() << "\n\n";
+}
+
+
+/*
+ * Function:	put (private)
+ *
+ * Description:	Write text to a cache entry, preceded by its length.
+ */
+
+static void put(ostream &ostr, const string &text) {
+  ostr << text.size() << ':' << text;
+}
+
+
+/*
+ * Function:	get (private)
+ *
+ * Description:	Read text written by put from a cache entry.
+ */
+
+static bool get(istream &istr, string &text) {
+  size_t length;
+
+  if (!(istr >> length) || istr.get() != ':')
+    return false;
+
+  text.resize(length);
+  return bool(istr.read(&text[0], length));
+}
+
+
+/*
+ * Function:	pack (private)
+ *
+ * Description:	Return the code and literals of a job as a cache entry.
+ */
+
+static string pack(const Job *job) {
+  ostringstream ostr;
+
+  put(ostr, job->code);
+
+  for (auto literals : {&job->m1, &job->m2}) {
+    ostr << literals->size() << ':';
+
+    for (auto &element : *literals) {
+      put(ostr, element.first);
+      put(ostr, element.second);
+    }
+  }
+
+  return ostr.str();
+}
+
+
+/*
+ * Function:	unpack (private)
+ *
+ * Description:	Read the code and literals of a job from a cache entry.
+ */
+
+static bool unpack(const string &entry, Job *job) {
+  istringstream istr(entry);
+  string value, label;
+  size_t count;
+
+  if (!get(istr, job->code))
+    return false;
+
+  for (auto literals : {&job->m1, &job->m2}) {
+    if (!(istr >> count) || istr.get() != ':')
+      return false;
+
+    while (count -- > 0) {
+      if (!get(istr, value) || !get(istr, label))
+        return false;
+
+      (*literals)[value] = label;
+    }
+  }
+
+  return true;
+}
+
+
+/*
+ * Function:	run (private)
+ *
+ * Description:	Generate the function of a job into memory using a fresh
+ *		context, and keep the code and literals it produced.
+ */
+
+static void run(Job *job) {
+  Context cx;
+  ostringstream label;
+
+  context = &cx;
+  out.comments(output.comments());
+  job->function->generate();
+  context = nullptr;
+
+  job->code = peephole ? optimize(out.take(), &job->name.str()) : out.take();
+
+  for (auto &element : cx.m1) {
+    label.str("");
+    label << element.second;
+    job->m1[element.first] = label.str();
+  }
+
+  for (auto &element : cx.m2) {
+    label.str("");
+    label << element.second;
+    job->m2[element.first] = label.str();
+  }
+
+  if (job->keyed)
+    cache.store(job->key, pack(job));
+}
+
+
+/*
+ * Function:	work (private)
+ *
+ * Description:	Generate functions until there are no more.  This is the
+ *		body of each worker thread.
+ */
+
+static void work() {
+  unique_lock<mutex> guard(queue);
+  Job *job;
+
+  while (true) {
+    ready.wait(guard, [] { return stopping || !waiting.empty(); });
+
+    if (waiting.empty())
+      return;
+
+    job = waiting.front();
+    waiting.pop_front();
+
+    guard.unlock();
+    run(job);
+    guard.lock();
+
+    job->done = true;
+    finished.notify_all();
+  }
+}
+
+
+/*
+ * Function:	stop (private)
+ *
+ * Description:	Let the workers finish the queued functions, and wait for
+ *		them to exit.
+ */
+
+static void stop() {
+  queue.lock();
+  stopping = true;
+  queue.unlock();
+  ready.notify_all();
+
+  for (auto &worker : workers)
+    worker.join();
+
+  workers.clear();
+}
+
+
+/*
+ * Function:	abandon (private)
+ *
+ * Description:	Drop the queued functions and stop the workers.  This is
+ *		called on exit, which may happen at a syntax error while
+ *		functions are still in flight; the workers must be joined
+ *		before the pool is destroyed or the process never ends.
+ */
+
+static void abandon() {
+  queue.lock();
+  waiting.clear();
+  queue.unlock();
+  stop();
+}
+
+
+/*
+ * Function:	write (private)
+ *
+ * Description:	Write the code of a finished job and merge its literals.
+ */
+
+static void write(Job *job) {
+  output << job->code;
+
+  for (auto &element : job->m1)
+    strings[element.first].push_back(element.second);
+
+  for (auto &element : job->m2)
+    reals[element.first].push_back(element.second);
+}
+
+
+/*
+ * Function:	retire (private)
+ *
+ * Description:	Write the code of finished jobs in the order in which they
+ *		were submitted, merge their literals, and release their
+ *		arenas.  We wait for jobs to finish until no more than the
+ *		given number remain.  For a whole program, the code is held
+ *		until we know which functions are called.
+ */
+
+static void retire(size_t limit) {
+  Timer::Scope timer(Timer::OUTPUT);
+  Job *job;
+
+  while (!pending.empty()) {
+    job = pending.front();
+
+    if (!job->done) {
+      if (pending.size() <= limit)
+        break;
+
+      unique_lock<mutex> guard(queue);
+      finished.wait(guard, [job] { return job->done.load(); });
+    }
+
+    pending.pop_front();
+    delete job->arena;
+    job->arena = nullptr;
+
+    if (wholeProgram)
+      held.push_back(job);
+    else {
+      write(job);
+      delete job;
+    }
+  }
+}
+
+
+/*
+ * Function:	prune (private)
+ *
+ * Description:	Write the code of the held functions that main may call,
+ *		directly or not, and collect the names that they mention.
+ *		A function is assumed to call every function whose name
+ *		appears in its body.  Without main, the unit is not a whole
+ *		program and every function is kept; false is returned.
+ */
+
+static bool prune(Mentions &used) {
+  unordered_map<Name, Job *> functions;
+  vector<Job *> work;
+  bool whole;
+
+  for (auto job : held)
+    functions[job->name] = job;
+
+  whole = functions.count(Name("main")) > 0;
+
+  if (whole) {
+    used.insert(Name("main"));
+    work.push_back(functions[Name("main")]);
+  }
+
+  while (!work.empty()) {
+    Job *job = work.back();
+    work.pop_back();
+
+    for (auto &name : job->mentions)
+      if (used.insert(name).second && functions.count(name) > 0)
+        work.push_back(functions[name]);
+  }
+
+  for (auto job : held) {
+    if (!whole || used.count(job->name) > 0)
+      write(job);
+
+    delete job;
+  }
+
+  held.clear();
+  return whole;
+}
+
+
+/*
+ * Function:	generateFunction
+ *
+ * Description:	Generate code for a function, which is allocated in the
+ *		given arena.  With more than one job, the function is
+ *		queued for a worker thread and its code is written later;
+ *		the number of functions in flight is bounded so that memory
+ *		use stays proportional to the number of jobs.  Given a key,
+ *		the code is also stored in the cache.  The workers are
+ *		started with the first function, and are stopped on exit
+ *		if the program ends before the globals are generated.
+ */
+
+void generateFunction(Function *function, const Name &name,
+                      const Mentions &mentions, Arena *arena,
+                      const Digest *key) {
+  Job *job = new Job();
+
+  job->function = function;
+  job->arena = arena;
+  job->name = name;
+  job->mentions = mentions;
+  job->keyed = key != nullptr;
+
+  if (key != nullptr)
+    job->key = *key;
+
+  pending.push_back(job);
+
+  if (jobs <= 1) {
+    run(job);
+    job->done = true;
+
+  } else {
+    if (workers.empty()) {
+      for (unsigned i = 0; i < jobs; i ++)
+        workers.emplace_back(work);
+
+      atexit(abandon);
+    }
+
+    queue.lock();
+    waiting.push_back(job);
+    queue.unlock();
+    ready.notify_one();
+  }
+
+  retire(2 * jobs);
+}
+
+
+/*
+ * Function:	generateCached
+ *
+ * Description:	Use the code for a function stored in the cache under the
+ *		given key, if there is any.  The code is written in order
+ *		with the functions still in flight.
+ */
+
+bool generateCached(const Name &name, const Mentions &mentions,
+                    const Digest &key) {
+  string entry;
+  Job *job = new Job();
+
+  if (!cache.fetch(key, entry) || !unpack(entry, job)) {
+    delete job;
+    return false;
+  }
+
+  job->function = nullptr;
+  job->arena = nullptr;
+  job->name = name;
+  job->mentions = mentions;
+  job->done = true;
+  pending.push_back(job);
+
+  retire(2 * jobs);
+  return true;
+}
+
+
+/*
+ * Function:	generateGlobals
+ *
+ * Description:	Generate code for any global variable declarations, after
+ *		writing the code of any functions still in flight.  A
+ *		literal used by several functions gets one label from each.
+ *		For a whole program, only the functions main may call and
+ *		the variables they mention are kept.
+ */
+
+void generateGlobals(Scope *scope) {
+  const Symbols &symbols = scope->symbols();
+  Mentions used;
+  bool pruned = false;
+
+  retire(0);
+
+  Timer::Scope timer(Timer::OUTPUT);
+
+  stop();
+
+  if (wholeProgram)
+    pruned = prune(used);
+
+  for (auto symbol : symbols)
+    if (!symbol->type().isFunction() &&
+        (!pruned || used.count(symbol->name()) > 0)) {
+      output << "\t.comm\t" << target->globalPrefix << symbol->name() << ", ";
+      output << symbol->type().size() << '\n';
+    }
+
+  output << ".data\n";
+
+  for (auto &element : strings) {
+    for (auto &label : element.second)
+      output << label << ":\n";
+
+    output << "\t.asciz\t" << "\"" << escapeString(element.first) << "\"\n";
+  }
+
+  for (auto &element : reals) {
+    for (auto &label : element.second)
+      output << label << ":\n";
+
+    output << "\t.double\t" << element.first << '\n';
+  }
+}
+
+
+/*
+ * Function:	Assignment::generate
+ *
+ * Description:	Generate code for an assignment statement.  The left-hand
+ *		side is either a dereference, in which case we store
+ *		through the pointer, or a scalar identifier.
+ */
+
+void Assignment::generate() {
+  Register *reg, *ptr;
+
+  out.comment("Assigning");
+  _right->generate();
+  out.comment("Generated right");
+  Expression * leftChild = _left->isDereference();
+
+  if (leftChild!=nullptr) {
+    out.comment("Generating left child");
+    leftChild->generate();
+    ptr = load(leftChild);
+
+    if (FP(_right) && sse) {
+      reg = load(_right);
+      out << "\tmovsd\t" << reg << ", (" << ptr << ")\n";
+    }
+    else if (FP(_right)) {   // floating
+      out << "\tfldl\t" << _right << '\n';
+      out << "\tfstpl\t" << "(" << ptr << ")\n";
+    }
+    else if (BYTE(_left)) {  // char
+      reg = byteable(load(_right));
+      out << "\tmovb\t" << reg->name(1) << ", (" << ptr << ")\n";
+    }
+    else {    // int or pointer
+      out.comment("INT Pointer assign");
+      if (dynamic_cast<Integer *>(_right) == nullptr)
+        load(_right);
+      out << "\tmov" << suffix(width(_left)) << "\t" << _right << ", (" << ptr << ")\n";
+    }
+
+    release(leftChild);
+  }
+  else {
+    out.comment("No dereference here");
+    _left->generate();
+    if (FP(_right) && sse) {
+      reg = load(_right);
+      out << "\tmovsd\t" << reg << ", " << _left << '\n';
+    }
+    else if (FP(_right)) {   // floating
+      out << "\tfldl\t" << _right << '\n';
+      out << "\tfstpl\t" << _left << '\n';
+    }
+    else if (BYTE(_left)) {  // char
+      reg = byteable(load(_right));
+      out << "\tmovb\t" << reg->name(1) << ", " << _left << '\n';
+    }
+    else {    // int or pointer
+      if (dynamic_cast<Integer *>(_right) == nullptr)
+        load(_right);
+      out << "\tmov" << suffix(width(_left)) << "\t" << _right << ", " << _left << '\n';
+    }
+  }
+
+  release(_right);
+}
+
+Expression * Expression::isDereference() {
+  return nullptr;
+}
+
+Expression * Dereference::isDereference() {
+  return _expr;
+}
+
+
+/*
+ * Function:	arithmetic (private)
+ *
+ * Description:	Generate a floating-point operation, given the name shared
+ *		by its SSE2 and x87 instructions, whose result is computed
+ *		in place of its left operand.
+ */
+
+static void arithmetic(const char *name, Expression *result, Expression *left, Expression *right) {
+  Register *reg;
+
+  if (sse) {
+    reg = load(left);
+    out << "\t" << name << "sd\t" << right << ", " << reg << '\n';
+    release(right);
+    define(result, reg);
+  }
+  else {
+    out << "\tfldl\t" << left << '\n';
+    out << "\tf" << name << "l\t" << right << '\n';
+    assigntemp(result);
+    out << "\tfstpl\t" << result << '\n';
+  }
+}
+
+
+/*
+ * Function:	widens (private)
+ *
+ * Description:	Return whether an integer expression added to a pointer of
+ *		the given size must first be sign-extended.  A constant is
+ *		sign-extended by the instruction that uses it.
+ */
+
+static bool widens(Expression *expr, unsigned size) {
+  return width(expr) < size && dynamic_cast<Integer *>(expr) == nullptr;
+}
+
+
+/*
+ * Function:	widen (private)
+ *
+ * Description:	Sign-extend the integer in the register holding the given
+ *		expression to the given size.
+ */
+
+static void widen(Expression *expr, unsigned size) {
+  if (width(expr) < size)
+    out << "\tmovslq\t" << expr->reg->name(4) << ", " << expr->reg->name(8) << '\n';
+}
 
-  offset = 0;
 
-  for (auto arg : _args) {
-    if (FP(arg)) {
-	    cout << "\tfldl\t" << arg << endl;
-	    cout << "\tfstpl\t" << offset << "(%esp)" << endl;
-    }
-    else {
-      cout << "\tmovl\t" << arg << ", %eax" << endl;
-      cout << "\tmovl\t%eax, " << offset << "(%esp)" << endl;
-    }
+/*
+ * Function:	magic (private)
+ *
+ * Description:	Compute the multiplier and shift for a signed division by
+ *		a constant that is not a power of two, using the method of
+ *		Hacker's Delight.
+ */
 
-    size = arg->type().size();
-    offset += size;
-  }
+static void magic(unsigned divisor, int &multiplier, unsigned &shift) {
+  const unsigned two31 = 0x80000000u;
+  unsigned anc, delta, q1, r1, q2, r2, p = 31;
 
-  if (offset > max_args)
-    max_args = offset;
+  anc = two31 - 1 - two31 % divisor;
+  q1 = two31 / anc;
+  r1 = two31 - q1 * anc;
+  q2 = two31 / divisor;
+  r2 = two31 - q2 * divisor;
 
-  /* Make the function call. */
+  do {
+    p ++;
+    q1 *= 2;
+    r1 *= 2;
 
-  cout << "\tcall\t" << global_prefix << _id->name() << endl;
+    if (r1 >= anc) {
+      q1 ++;
+      r1 -= anc;
+    }
 
-  /* Save the return value */
+    q2 *= 2;
+    r2 *= 2;
 
-//   # if 0
-    assigntemp(this);
+    if (r2 >= divisor) {
+      q2 ++;
+      r2 -= divisor;
+    }
 
-  if (FP(this))
-    cout << "\tfstpl\t" << this << endl;
-  else
-    cout << "\tmovl\t%eax, " << this << endl;
-// # endif
+    delta = divisor - r2;
+  } while (q1 < delta || (q1 == delta && r1 == 0));
+
+  multiplier = q2 + 1;
+  shift = p - 32;
 }
 
 
 /*
- * Function:	Block::generate
+ * Function:	divide
  *
- * Description:	Generate code for this block, which simply means we
- *		generate code for each statement within the block.
+ * Description:	Write a signed division of an integer operand by a nonzero
+ *		constant, leaving the quotient in eax or the remainder in
+ *		edx, both of which are clobbered.  A power of two is an
+ *		arithmetic shift of the dividend, biased to round toward
+ *		zero, and any other divisor is a multiplication by its
+ *		reciprocal, which is much faster than idiv.  The operand
+ *		must be a register other than eax and edx, or memory.
  */
 
-void Block::generate() {
-  for (auto stmt : _stmts) {
-    stmt->generate();
-  }
-}
+void divide(ostream &ostr, const string &dividend, int divisor, bool remainder) {
+  unsigned magnitude = divisor < 0 ? -(unsigned) divisor : divisor;
+  unsigned shift = 0;
+  int multiplier;
 
+  if ((magnitude & (magnitude - 1)) == 0) {
+    ostr << "\tmovl\t" << dividend << ", %eax\n";
 
-/*
- * Function:	Function::generate
- */
+    while ((1u << shift) < magnitude)
+      shift ++;
 
-void Function::generate() {
-  Label empty;
-  globalReturn = empty;
-  max_args = 0;
-  offset = SIZEOF_REG * 2;
-  allocate(offset);
+    if (shift == 0) {
+      if (remainder)
+        ostr << "\txorl\t%edx, %edx\n";
+      else if (divisor < 0)
+        ostr << "\tnegl\t%eax\n";
 
-  /* Generate our prologue. */
-  cout << "#Prologue" << endl;
-  cout << global_prefix << _id->name() << ":" << endl;
-  cout << "\tpushl\t%ebp" << endl;
-  cout << "\tmovl\t%esp, %ebp" << endl;
-  cout << "\tsubl\t$" << _id->name() << ".size, %esp" << endl;
+      return;
+    }
 
-  /* Generate the body of this function. */
+    ostr << "\tcltd\t\n";
+    ostr << "\tshrl\t$" << 32 - shift << ", %edx\n";
+    ostr << "\taddl\t%edx, %eax\n";
 
-  _body->generate();
+    if (remainder) {
+      ostr << "\tandl\t$" << magnitude - 1 << ", %eax\n";
+      ostr << "\tsubl\t%edx, %eax\n";
+      ostr << "\tmovl\t%eax, %edx\n";
+    } else {
+      ostr << "\tsarl\t$" << shift << ", %eax\n";
 
-  /* Compute the proper stack frame size. */
+      if (divisor < 0)
+        ostr << "\tnegl\t%eax\n";
+    }
+
+    return;
+  }
 
-  offset -= max_args;
-  offset -= align(offset - SIZEOF_REG * 2);
+  magic(magnitude, multiplier, shift);
+  ostr << "\tmovl\t$" << multiplier << ", %eax\n";
+  ostr << "\timull\t" << dividend << '\n';
 
+  if (multiplier < 0)
+    ostr << "\taddl\t" << dividend << ", %edx\n";
 
-  /* Generate our epilogue. */
+  if (shift > 0)
+    ostr << "\tsarl\t$" << shift << ", %edx\n";
 
-  cout << globalReturn << ": " << endl;
-  cout << "#Epilogue" << endl;
-  cout << "\tmovl\t%ebp, %esp" << endl;
-  cout << "\tpopl\t%ebp" << endl;
-  cout << "\tret" << endl << endl;
+  ostr << "\tmovl\t" << dividend << ", %eax\n";
+  ostr << "\tshrl\t$31, %eax\n";
+  ostr << "\taddl\t%edx, %eax\n";
 
-  cout << "\t.set\t" << _id->name() << ".size, " << -offset << endl;
-  cout << "\t.globl\t" << global_prefix << _id->name() << endl << endl;
+  if (remainder) {
+    ostr << "\timull\t$" << magnitude << ", %eax\n";
+    ostr << "\tmovl\t" << dividend << ", %edx\n";
+    ostr << "\tsubl\t%eax, %edx\n";
+  } else if (divisor < 0)
+    ostr << "\tnegl\t%eax\n";
 }
 
 
 /*
- * Function:	generateGlobals
+ * Function:	divide (private)
  *
- * Description:	Generate code for any global variable declarations.
+ * Description:	Emit a signed integer division of the two expressions,
+ *		leaving the quotient in eax and the remainder in edx.  The
+ *		dividend goes in eax and edx is clobbered, so the divisor
+ *		must end up somewhere else.  A division by a constant is
+ *		done without idiv, and computes only the result wanted.
  */
 
-void generateGlobals(Scope *scope) {
-  const Symbols &symbols = scope->symbols();
-
-  for (auto symbol : symbols)
-    if (!symbol->type().isFunction()) {
-      cout << "\t.comm\t" << global_prefix << symbol->name() << ", ";
-      cout << symbol->type().size() << endl;
-	}
+static void divide(Expression *left, Expression *right, bool remainder) {
+  Integer *known = dynamic_cast<Integer *>(right);
+  stringstream dividend;
+
+  if (known != nullptr && known->value() != 0) {
+    load(left);
+    evict(edx);
+    dividend << left;
+    divide(out, dividend.str(), known->value(), remainder);
+    release(left);
+    release(right);
+    return;
+  }
 
-  cout << ".data" << endl;
+  if (right->reg == nullptr && known != nullptr)
+    load(right);
 
-  for (pair<std::string, Label> element : m1) {
-    cout << ".L" << element.second.number() << ":\t.asciz\t" << "\"" << escapeString(element.first) << "\"" << endl;
-  }
+  move(left, eax);
+  release(left);
+  evict(edx);
 
-  for (pair<std::string, Label> element : m2) {
-    cout << ".L" << element.second.number() << ":\t.double\t"  << escapeString(element.first) << endl;
-  }
+  out << "\tcltd\t\n";    // sign extend %eax into %edx
+  out << "\tidivl\t" << right << '\n';               // %edx:%eax / y
+  release(right);
 }
 
-
 /*
- * Function:	Assignment::generate
+ * Function:	multiply (private)
  *
- * Description:	Generate code for an assignment statement.
- *
- *		NOT FINISHED: Only works if the right-hand side is an
- *		integer literal and the left-hand side is an integer
- *		scalar.
+ * Description:	Multiply the integer of the given size in a register by a
+ *		constant.  A power of two is a shift, and a power of two
+ *		times three, five, or nine is an lea and a shift; anything
+ *		else is left to imul.
  */
 
-void Assignment::generate() {
-  cout << "#Assigning" << endl;
-  _right->generate();
-  cout << "#Generated right" << endl;
-  // assigntemp(this);
-  Expression * leftChild = _left->isDereference();
-
-  if (leftChild!=nullptr) {
-    cout << "#Generating left child" << endl;
-    leftChild->generate();
+static void multiply(Register *reg, int factor, unsigned size) {
+  const string name = reg->name(size);
+  const string base = reg->name(target->sizeofRegister);
+  unsigned shift = 0;
+  int odd = factor;
 
-    if (FP(_right)) {   // floating
-      cout << "\tfldl\t" << _right << endl;
-      cout << "\tmovl\t" << leftChild << ", %eax" << endl;
-      cout << "\tfstpl\t" << "(%eax)" << endl;
-    }
-    else if (BYTE(_right)) {  // char
-      cout << "\tmovl\t" << _right << ", %eax" << endl;
-      cout << "\tmovl\t" << leftChild << ", %ecx" << endl;
-      cout << "\tmovb\t" << "%eax" << ", (%ecx)" << endl;
-    }
-    else {    // int or pointer
-      cout << "#INT Pointer assign" << endl;
-      cout << "\tmovl\t" << _right << ", %eax" << endl;
-      cout << "\tmovl\t" << leftChild << ", %ecx" << endl;
-      cout << "\tmovl\t" << "%eax" << ", (%ecx)" << endl;
-    }
-  }
-  else {
-    cout << "#No dereference here" << endl;
-    _left->generate();
-    if (FP(_right)) {   // floating
-      cout << "\tfldl\t" << _right << endl;
-      cout << "\tfstpl\t" << _left << endl;
-    }
-    else if (BYTE(_right)) {  // char
-      cout << "\tmovb\t" << _right << ", %al" << endl;
-      cout << "\tmovb\t" << "%al, " << _left << endl;
-    }
-    else {    // int or pointer
-      cout << "\tmovl\t" << _right << ", %eax" << endl;
-      cout << "\tmovl\t" << "%eax, " << _left << endl;
-    }
+  while (odd > 0 && (odd & 1) == 0) {
+    odd >>= 1;
+    shift ++;
   }
-}
 
-Expression * Expression::isDereference() {
-  return nullptr;
-}
+  if (odd == 3 || odd == 5 || odd == 9)
+    out << "\tlea" << suffix(size) << "\t(" << base << "," << base << "," << odd - 1 << "), " << name << '\n';
+  else if (odd != 1) {
+    out << "\timul" << suffix(size) << "\t$" << factor << ", " << name << '\n';
+    return;
+  }
 
-Expression * Dereference::isDereference() {
-  return _expr;
+  if (shift > 0)
+    out << "\tsal" << suffix(size) << "\t$" << shift << ", " << name << '\n';
 }
 
 void Multiply::generate() {
-  cout << "#Multiplying" << endl;
+  Register *reg;
+  Integer *left, *right;
+
+  out.comment("Multiplying");
   _left->generate();
   _right->generate();
-  assigntemp(this);
 
-  if (FP(this)) {
-    cout << "\tfldl\t" << _left << endl;
-    cout << "\tfmull\t" << _right << endl;
-    cout << "\tfstpl\t" << this << endl;
+  left = dynamic_cast<Integer *>(_left);
+  right = dynamic_cast<Integer *>(_right);
+
+  if (FP(this))
+    arithmetic("mul", this, _left, _right);
+  else if (right != nullptr) {
+    reg = load(_left);
+    multiply(reg, right->value(), 4);
+    release(_right);
+    define(this, reg);
+  }
+  else if (left != nullptr) {
+    reg = load(_right);
+    multiply(reg, left->value(), 4);
+    release(_left);
+    define(this, reg);
   }
   else {
-    cout << "\tmovl\t" << _left << ", %eax" << endl;
-    cout << "\timull\t" << _right << ", %eax" << endl;
-    cout << "\tmovl\t%eax, " << this << endl;
+    reg = load(_left);
+    out << "\timull\t" << _right << ", " << reg->name(4) << '\n';
+    release(_right);
+    define(this, reg);
   }
 }
 
 void Divide::generate() {
-  cout << "#Dividing" << endl;
+  Register *reg;
+
+  out.comment("Dividing");
   _left->generate();
   _right->generate();
-  assigntemp(this);
 
-  if(FP(this)) {
-    cout << "\tfldl\t" << _left << endl;
-    cout << "\tfdivl\t" << _right << endl;
-    cout << "\tfstpl\t" << this << endl;
-  }
+  if(FP(this))
+    arithmetic("div", this, _left, _right);
   else {
-    cout << "\tmovl\t" << _left << ", %eax"<< endl;     // load: %eax allocated
-    cout << "\tcltd\t" << endl;    // sign extend %eax into %edx
-    cout << "\tmovl\t" << _right << ", %ecx" << endl;
-    cout << "\tidivl\t" << "%ecx" << endl;               // %edx:%eax / y
-    cout << "\tmovl\t%eax, " << this << endl;
+    divide(_left, _right, false);
+    reg = getreg();
+    out << "\tmovl\t%eax, " << reg->name(4) << '\n';
+    define(this, reg);
   }
 }
 
 void Remainder::generate() {
-  cout << "#Remainding" << endl;
+  out.comment("Remainding");
   _left->generate();
   _right->generate();
-  assigntemp(this);
 
   // Floating Point has no remainder
-  cout << "\tmovl\t" << _left << ", %eax"<< endl;     // load: %eax allocated
-  cout << "\tcltd\t" << endl;    // sign extend %eax into %edx
-  cout << "\tmovl\t" << _right << ", %ecx" << endl;
-  cout << "\tidivl\t" << "%ecx" << endl;               // %edx:%eax / y
-  cout << "\tmovl\t%edx, " << this << endl;
+  divide(_left, _right, true);
+  define(this, edx);
 }
 
 void Add::generate() {
-  cout << "#Adding" << endl;
+  Register *reg, *right;
+  unsigned size;
+
+  out.comment("Adding");
   _left->generate();
   _right->generate();
-  assigntemp(this);
 
-  if(FP(this)) {
-    cout << "\tfldl\t" << _left << endl;
-    cout << "\tfaddl\t" << _right << endl;
-    cout << "\tfstpl\t" << this << endl;
-  }
+  if(FP(this))
+    arithmetic("add", this, _left, _right);
   else {
-    cout << "\tmovl\t" << _left << ", %eax"<< endl;
+    size = width(this);
+    reg = load(_left);
+    widen(_left, size);
     if (scaleLeft!=0)
-      cout << "\timull\t$" << scaleLeft << ", %eax" << endl;
+      multiply(reg, scaleLeft, size);
+
+    if (scaleRight!=0 || widens(_right, size)) {
+      right = load(_right);
+      widen(_right, size);
+      if (scaleRight==2 || scaleRight==4 || scaleRight==8)
+        out << "\tlea" << suffix(size) << "\t(" << reg->name(size) << "," << right->name(size) << "," << scaleRight << "), " << reg->name(size) << '\n';
+      else
+        out << "\tadd" << suffix(size) << "\t" << right->name(size) << ", " << reg->name(size) << '\n';
+    }
+    else
+      out << "\tadd" << suffix(size) << "\t" << _right << ", " << reg->name(size) << '\n';
 
-    cout << "\tmovl\t" << _right << ", %ecx"<< endl;
-    if (scaleRight!=0)
-        cout << "\timull\t$" << scaleRight << ", %ecx" << endl;
-    cout << "\taddl\t" << "%ecx" << ", %eax"<< endl;
-    cout << "\tmovl\t%eax, " << this << endl;
+    release(_right);
+    define(this, reg);
   }
 }
 
 void Subtract::generate() {
-    cout << "#Subtracting" << endl;
+  Register *reg, *right;
+  unsigned shift, size;
+
+    out.comment("Subtracting");
     _left->generate();
     _right->generate();
-    assigntemp(this);
 
-    if(FP(this)) {
-        cout << "\tfldl\t" << _left << endl;
-        cout << "\tfsubl\t" << _right << endl;
-        cout << "\tfstpl\t" << this << endl;
-    }
+    if(FP(this))
+        arithmetic("sub", this, _left, _right);
     else {
-        cout << "\tmovl\t" << _left << ", %eax" << endl;
-        if (scaleResult!=0) {
-          cout << "\tsubl\t" << _right << ", %eax"<< endl;
-          cout << "\tidivl\t$" << scaleResult << endl;
+        size = width(_left);
+        reg = load(_left);
+        if (scaleRight!=0 || widens(_right, size)) {
+          right = load(_right);
+          widen(_right, size);
+          if (scaleRight!=0)
+            multiply(right, scaleRight, size);
+          out << "\tsub" << suffix(size) << "\t" << right->name(size) << ", " << reg->name(size) << '\n';
         }
-        else if (scaleRight!=0) {
-          cout << "\timull\t$" << scaleRight << ", %ecx" << endl;
-          cout << "\tsubl\t" << "%ecx" << ", %eax" << endl;
+        else
+          out << "\tsub" << suffix(size) << "\t" << _right << ", " << reg->name(size) << '\n';
+        release(_right);
+
+        // The difference of two pointers is an exact multiple of the
+        // element size, which is always a power of two.
+        if (scaleResult > 1) {
+          assert((scaleResult & (scaleResult - 1)) == 0);
+          for (shift = 0; (1u << shift) < scaleResult; shift ++)
+            ;
+          out << "\tsar" << suffix(size) << "\t$" << shift << ", " << reg->name(size) << '\n';
         }
-        else {
-          cout << "\tsubl\t" << _right << ", %eax" << endl;
-        }
-        cout << "\tmovl\t%eax, " << this << endl;
+        define(this, reg);
     }
 }
 
 void Not::generate() {
+  Register *reg;
+
   _expr->generate();
-  assigntemp(this);
-
-  if (FP(this)) {
-    cout << "\tfldl\t" << _expr << endl;
-    cout << "\tftst\t" << endl;
-    cout << "\tfnstsw\t" << "%ax" << endl;
-    cout << "\tfstp\t" << "%st(0)" << endl;
-    cout << "\tsahf\t" << endl;
-    cout << "\tsete\t" << "%al" << endl;
-    cout << "\tmovzbl\t" << "%al" << ", %eax" << endl;
-    cout << "\tmovl\t%eax, " << this << endl;
+
+  if (FP(_expr)) {
+    reg = getreg();
+    compare(_expr);
+    fpequal(true);
+    out << "\tmovzbl\t" << "%al" << ", " << reg->name(4) << '\n';
   }
   else {
-    cout << "\tmovl\t" << _expr << ", %eax" << endl;
-    cout << "\tcmpl\t" << "$0" << ", %eax" << endl;
-    cout << "\tsete\t" << "%al" << endl;
-    cout << "\tmovzbl\t" << "%al" << ", %eax" << endl;
-    cout << "\tmovl\t%eax, " << this << endl;
+    reg = load(_expr);
+    out << "\tcmp" << suffix(width(_expr)) << "\t" << "$0" << ", " << _expr << '\n';
+    out << "\tsete\t" << "%al\n";
+    out << "\tmovzbl\t" << "%al" << ", " << reg->name(4) << '\n';
   }
+
+  release(_expr);
+  define(this, reg);
 }
 
 void Negate::generate() {
+  Register *reg;
+
   _expr->generate();
-  assigntemp(this);
 
-  if (FP(this)) {
-    cout << "\tfldl\t" << _expr << endl;
-    cout << "\tfchs\t" << endl;
-    cout << "\tfstpl\t" << this << endl;
+  if (FP(this) && sse) {
+    reg = load(_expr);
+    out << "\tmulsd\t";
+    constant(out, -1);
+    out << ", " << reg << '\n';
+    define(this, reg);
+  }
+  else if (FP(this)) {
+    out << "\tfldl\t" << _expr << '\n';
+    out << "\tfchs\t\n";
+    assigntemp(this);
+    out << "\tfstpl\t" << this << '\n';
   }
   else {
-    cout << "\tmovl\t" << _expr << ", %eax" << endl;
-    cout << "\tnegl\t" << "%eax" << endl;
-    cout << "\tmovl\t%eax, " << this << endl;
+    reg = load(_expr);
+    out << "\tnegl\t" << reg->name(4) << '\n';
+    define(this, reg);
   }
 }
 
 void Dereference::generate() {
-    _expr->generate();
-    assigntemp(this);
-    cout << "#Dereference" << endl;
-    cout << "\tmovl\t" << _expr << ", %eax" << endl;
+  Register *reg, *fp;
 
-    if (FP(this)) {
-        cout << "\tfldl\t" << "(%eax)" << endl;
-        cout << "\tfstpl\t" << this << endl;
+    _expr->generate();
+    out.comment("Dereference");
+    reg = load(_expr);
+
+    if (FP(this) && sse) {
+        fp = getreg(true);
+        out << "\tmovsd\t" << "(" << reg << "), " << fp << '\n';
+        release(_expr);
+        define(this, fp);
+    }
+    else if (FP(this)) {
+        out << "\tfldl\t" << "(" << reg << ")\n";
+        release(_expr);
+        assigntemp(this);
+        out << "\tfstpl\t" << this << '\n';
+    }
+    else if (BYTE(this)) {
+        out << "\tmovsbl\t" << "(" << reg << "), " << reg->name(4) << '\n';
+        define(this, reg);
     }
     else {
-        cout << "\tmovl\t" << "(%eax)" << ", %eax" << endl;
-        cout << "\tmovl\t%eax, " << this << endl;
+        out << "\tmov" << suffix(width(this)) << "\t" << "(" << reg << "), " << reg->name(width(this)) << '\n';
+        define(this, reg);
     }
 }
 
 void Address::generate() {
-    _expr->generate();
-    assigntemp(this);
-    cout << "#Addressing" << endl;
+  Register *reg;
+  Expression *pointer = _expr->isDereference();
 
-    if (_expr->isDereference()==nullptr)
-        cout << "\tleal\t" << _expr << ", %eax" << endl;
-    else
-        cout << "\tmovl\t" << _expr->isDereference() << ", %eax"<<endl;
-    cout << "\tmovl\t%eax, " << this << endl;
+    out.comment("Addressing");
+
+    if (pointer==nullptr) {
+        _expr->generate();
+        reg = getreg();
+        out << "\tlea" << suffix(target->sizeofPointer) << "\t" << _expr << ", " << reg << '\n';
+    }
+    else {
+        pointer->generate();
+        reg = load(pointer);
+    }
+    define(this, reg);
+}
+
+/*
+ * Function:	fpcompare (private)
+ *
+ * Description:	Compare two floating-point values, leaving the result in
+ *		the flags as for an unsigned comparison.  An unordered
+ *		result sets the zero, parity, and carry flags, so only the
+ *		above and above-or-equal conditions are false for it; a
+ *		less-than comparison is made with the operands swapped.
+ */
+
+static void fpcompare(Expression *left, Expression *right) {
+  Register *reg;
+
+  if (sse) {
+    reg = load(left);
+    out << "\tucomisd\t" << right << ", " << reg << '\n';
+  }
+  else {
+    out << "\tfldl\t" << left << '\n';
+    out << "\tfcompl\t" << right << '\n';
+    out << "\tfnstsw\t" << "%ax\n";
+    out << "\tsahf\t\n";
+  }
+}
+
+/*
+ * Function:	branch (private)
+ *
+ * Description:	Compare two values and branch to the label on the given
+ *		condition, without computing the value of the comparison.
+ *		Integers and pointers are compared as signed values, and
+ *		floating-point values as unsigned ones, with the operands
+ *		swapped if requested.
+ */
+
+static void branch(Expression *left, Expression *right, const char *condition, const Label &label, bool swapped = false) {
+  left->generate();
+  right->generate();
+
+  if (FP(left) && swapped)
+    fpcompare(right, left);
+  else if (FP(left))
+    fpcompare(left, right);
+  else {
+    load(left);
+    out << "\tcmp" << suffix(width(left)) << "\t" << right << ", " << left << '\n';
+  }
+
+  release(left);
+  release(right);
+  out << "\tj" << condition << "\t" << label << '\n';
+}
+
+
+/*
+ * Function:	fpbranch (private)
+ *
+ * Description:	Compare two floating-point values and branch to the label
+ *		if they are equal, or unequal, as given.
+ */
+
+static void fpbranch(Expression *left, Expression *right, bool equal, const Label &label) {
+  left->generate();
+  right->generate();
+  fpcompare(left, right);
+  release(left);
+  release(right);
+  fpjump(label, equal);
 }
 
 void LessThan::generate() {
+  Register *reg;
+
     _left->generate();
     _right->generate();
-    assigntemp(this);
 
-    if (FP(this)) {
-        cout << "\tfldl\t" << _left << endl;
-        cout << "\tfcompl\t" << _right << endl;
-        cout << "\tfnstsw\t" << "%ax" << endl;
-        cout << "\tsahf\t" << endl;
-        cout << "\tsetb\t" << "%al" << endl;
-        cout << "\tmovzbl\t" << "%al" << ", %eax" << endl;
-        cout << "\tmovl\t%eax, " << this << endl;
+    if (FP(_left)) {
+        reg = getreg();
+        fpcompare(_right, _left);
+        out << "\tseta\t" << "%al\n";
+        out << "\tmovzbl\t" << "%al" << ", " << reg->name(4) << '\n';
     }
     else {
-        cout << "\tmovl\t" << _left << ", %eax" << endl;
-        cout << "\tcmpl\t" << _right << ", %eax" << endl;
-        cout << "\tsetl\t" << "%al" << endl;
-        cout << "\tmovzbl\t" << "%al" << ", %eax" << endl;
-        cout << "\tmovl\t%eax, " << this << endl;
+        reg = load(_left);
+        out << "\tcmp" << suffix(width(_left)) << "\t" << _right << ", " << _left << '\n';
+        out << "\tsetl\t" << "%al\n";
+        out << "\tmovzbl\t" << "%al" << ", " << reg->name(4) << '\n';
     }
+    release(_left);
+    release(_right);
+    define(this, reg);
+}
+
+void LessThan::test(const Label &label, bool ifTrue) {
+  if (FP(_left))
+    branch(_left, _right, ifTrue ? "a" : "be", label, true);
+  else
+    branch(_left, _right, ifTrue ? "l" : "ge", label);
 }
 
 void GreaterThan::generate() {
+  Register *reg;
+
     _left->generate();
     _right->generate();
-    assigntemp(this);
 
-    if (FP(this)) {
-        cout << "\tfldl\t" << _left << endl;
-        cout << "\tfcompl\t" << _right << endl;
-        cout << "\tfnstsw\t" << "%ax" << endl;
-        cout << "\tsahf\t" << endl;
-        cout << "\tseta\t" << "%al" << endl;
-        cout << "\tmovzbl\t" << "%al" << ", %eax" << endl;
-        cout << "\tmovl\t%eax, " << this << endl;
+    if (FP(_left)) {
+        reg = getreg();
+        fpcompare(_left, _right);
+        out << "\tseta\t" << "%al\n";
+        out << "\tmovzbl\t" << "%al" << ", " << reg->name(4) << '\n';
     }
     else {
-        cout << "\tmovl\t" << _left << ", %eax" << endl;
-        cout << "\tcmpl\t" << _right << ", %eax" << endl;
-        cout << "\tsetg\t" << "%al" << endl;
-        cout << "\tmovzbl\t" << "%al" << ", %eax" << endl;
-        cout << "\tmovl\t%eax, " << this << endl;
+        reg = load(_left);
+        out << "\tcmp" << suffix(width(_left)) << "\t" << _right << ", " << _left << '\n';
+        out << "\tsetg\t" << "%al\n";
+        out << "\tmovzbl\t" << "%al" << ", " << reg->name(4) << '\n';
     }
+    release(_left);
+    release(_right);
+    define(this, reg);
+}
+
+void GreaterThan::test(const Label &label, bool ifTrue) {
+  if (FP(_left))
+    branch(_left, _right, ifTrue ? "a" : "be", label);
+  else
+    branch(_left, _right, ifTrue ? "g" : "le", label);
 }
 
 void LessOrEqual::generate() {
+  Register *reg;
+
     _left->generate();
     _right->generate();
-    assigntemp(this);
 
-    if (FP(this)) {
-        cout << "\tfldl\t" << _left << endl;
-        cout << "\tfcompl\t" << _right << endl;
-        cout << "\tfnstsw\t" << "%ax" << endl;
-        cout << "\tsahf\t" << endl;
-        cout << "\tsetbe\t" << "%al" << endl;
-        cout << "\tmovzbl\t" << "%al" << ", %eax" << endl;
-        cout << "\tmovl\t%eax, " << this << endl;
+    if (FP(_left)) {
+        reg = getreg();
+        fpcompare(_right, _left);
+        out << "\tsetae\t" << "%al\n";
+        out << "\tmovzbl\t" << "%al" << ", " << reg->name(4) << '\n';
     }
     else {
-        cout << "\tmovl\t" << _left << ", %eax" << endl;
-        cout << "\tcmpl\t" << _right << ", %eax" << endl;
-        cout << "\tsetle\t" << "%al" << endl;
-        cout << "\tmovzbl\t" << "%al" << ", %eax" << endl;
-        cout << "\tmovl\t%eax, " << this << endl;
+        reg = load(_left);
+        out << "\tcmp" << suffix(width(_left)) << "\t" << _right << ", " << _left << '\n';
+        out << "\tsetle\t" << "%al\n";
+        out << "\tmovzbl\t" << "%al" << ", " << reg->name(4) << '\n';
     }
+    release(_left);
+    release(_right);
+    define(this, reg);
+}
+
+void LessOrEqual::test(const Label &label, bool ifTrue) {
+  if (FP(_left))
+    branch(_left, _right, ifTrue ? "ae" : "b", label, true);
+  else
+    branch(_left, _right, ifTrue ? "le" : "g", label);
 }
 
 void GreaterOrEqual::generate() {
+  Register *reg;
+
     _left->generate();
     _right->generate();
-    assigntemp(this);
 
-    if (FP(this)) {
-        cout << "\tfldl\t" << _left << endl;
-        cout << "\tfcompl\t" << _right << endl;
-        cout << "\tfnstsw\t" << "%ax" << endl;
-        cout << "\tsahf\t" << endl;
-        cout << "\tsetae\t" << "%al" << endl;
-        cout << "\tmovzbl\t" << "%al" << ", %eax" << endl;
-        cout << "\tmovl\t%eax, " << this << endl;
+    if (FP(_left)) {
+        reg = getreg();
+        fpcompare(_left, _right);
+        out << "\tsetae\t" << "%al\n";
+        out << "\tmovzbl\t" << "%al" << ", " << reg->name(4) << '\n';
     }
     else {
-        cout << "\tmovl\t" << _left << ", %eax" << endl;
-        cout << "\tcmpl\t" << _right << ", %eax" << endl;
-        cout << "\tsetge\t" << "%al" << endl;
-        cout << "\tmovzbl\t" << "%al" << ", %eax" << endl;
-        cout << "\tmovl\t%eax, " << this << endl;
+        reg = load(_left);
+        out << "\tcmp" << suffix(width(_left)) << "\t" << _right << ", " << _left << '\n';
+        out << "\tsetge\t" << "%al\n";
+        out << "\tmovzbl\t" << "%al" << ", " << reg->name(4) << '\n';
     }
+    release(_left);
+    release(_right);
+    define(this, reg);
+}
+
+void GreaterOrEqual::test(const Label &label, bool ifTrue) {
+  if (FP(_left))
+    branch(_left, _right, ifTrue ? "ae" : "b", label);
+  else
+    branch(_left, _right, ifTrue ? "ge" : "l", label);
 }
 
 void Equal::generate() {
+  Register *reg;
+
     _left->generate();
     _right->generate();
-    assigntemp(this);
 
     if (FP(_left)) {
-        cout << "\tfldl\t" << _left << endl;
-        cout << "\tfcompl\t" << _right << endl;
-        cout << "\tfnstsw\t" << "%ax" << endl;
-        cout << "\tsahf\t" << endl;
-        cout << "\tsete\t" << "%al" << endl;
-        cout << "\tmovzbl\t" << "%al" << ", %eax" << endl;
-        cout << "\tmovl\t%eax, " << this << endl;
+        reg = getreg();
+        fpcompare(_left, _right);
+        fpequal(true);
+        out << "\tmovzbl\t" << "%al" << ", " << reg->name(4) << '\n';
     }
     else {
-        cout << "#Equality!" << endl;
-        cout << "\tmovl\t" << _left << ", %eax" << endl;
-        cout << "\tcmpl\t" << _right << ", %eax" << endl;
-        cout << "\tsete\t" << "%al" << endl;
-        cout << "\tmovzbl\t" << "%al" << ", %eax" << endl;
-        cout << "\tmovl\t%eax, " << this << endl;
+        out.comment("Equality!");
+        reg = load(_left);
+        out << "\tcmp" << suffix(width(_left)) << "\t" << _right << ", " << _left << '\n';
+        out << "\tsete\t" << "%al\n";
+        out << "\tmovzbl\t" << "%al" << ", " << reg->name(4) << '\n';
     }
+    release(_left);
+    release(_right);
+    define(this, reg);
+}
+
+void Equal::test(const Label &label, bool ifTrue) {
+  if (FP(_left))
+    fpbranch(_left, _right, ifTrue, label);
+  else
+    branch(_left, _right, ifTrue ? "e" : "ne", label);
 }
 
 void NotEqual::generate() {
+  Register *reg;
+
     _left->generate();
     _right->generate();
-    assigntemp(this);
 
-    if (FP(this)) {
-        cout << "\tfldl\t" << _left << endl;
-        cout << "\tfcompl\t" << _right << endl;
-        cout << "\tfnstsw\t" << "%ax" << endl;
-        cout << "\tsahf\t" << endl;
-        cout << "\tsetne\t" << "%al" << endl;
-        cout << "\tmovzbl\t" << "%al" << ", %eax" << endl;
-        cout << "\tmovl\t%eax, " << this << endl;
+    if (FP(_left)) {
+        reg = getreg();
+        fpcompare(_left, _right);
+        fpequal(false);
+        out << "\tmovzbl\t" << "%al" << ", " << reg->name(4) << '\n';
     }
     else {
-        cout << "\tmovl\t" << _left << ", %eax" << endl;
-        cout << "\tcmpl\t" << _right << ", %eax" << endl;
-        cout << "\tsetne\t" << "%al" << endl;
-        cout << "\tmovzbl\t" << "%al" << ", %eax" << endl;
-        cout << "\tmovl\t%eax, " << this << endl;
+        reg = load(_left);
+        out << "\tcmp" << suffix(width(_left)) << "\t" << _right << ", " << _left << '\n';
+        out << "\tsetne\t" << "%al\n";
+        out << "\tmovzbl\t" << "%al" << ", " << reg->name(4) << '\n';
     }
+    release(_left);
+    release(_right);
+    define(this, reg);
+}
+
+void NotEqual::test(const Label &label, bool ifTrue) {
+  if (FP(_left))
+    fpbranch(_left, _right, !ifTrue, label);
+  else
+    branch(_left, _right, ifTrue ? "ne" : "e", label);
+}
+
+/*
+ * Function:	condition (private)
+ *
+ * Description:	Generate code for the value of a logical expression by
+ *		testing it.  The operands of the expression are evaluated
+ *		only on some paths, so every value live in a register is
+ *		first spilled to keep where each value lives the same on
+ *		all paths.
+ */
+
+static void condition(Expression *expr) {
+  Register *reg;
+  Label zero, done;
+
+  while (!context->active.empty())
+    spill(context->active.front());
+
+  expr->test(zero, false);
+
+  reg = getreg();
+  out << "\tmovl\t$1, " << reg->name(4) << '\n';
+  out << "\tjmp\t" << done << '\n';
+  out << zero << ":\n";
+  out << "\tmovl\t$0, " << reg->name(4) << '\n';
+  out << done << ":\n";
+
+  define(expr, reg);
 }
 
 void LogicalOr::generate() {
-  _left->generate();
-  _right->generate();
-  assigntemp(this);
-
-  Label firstLabel, secondLabel;
-  cout << "#LogicalOrring" << endl;
-  if (FP(this)) {
-    cout << "\tfldl\t" << _left << endl;
-    cout << "\tftst\t" << endl;
-    cout << "\tfnstsw\t" << "%ax" << endl;
-    cout << "\tfstp\t" << "%st(0)" << endl;
-    cout << "\tsahf" << endl;
-    cout << "\tjne\t" << firstLabel << endl;
-
-    cout << "\tmovl\t" << "$0" << ", %eax" << endl;
-
-    cout << "\tfldl\t" << _right << endl;
-    cout << "\tftst\t" << endl;
-    cout << "\tfnstsw\t" << "%ax" << endl;
-    cout << "\tfstp\t" << "%st(0)" << endl;
-    cout << "\tsahf" << endl;
-    cout << "\tjne\t" << secondLabel << endl;
-    cout << firstLabel << ":" << endl;
-    cout << "\tmovl\t" << "$1" << ", %eax" << endl;
-    cout << secondLabel << ":" << endl;
-    cout << "\tmovl\t%eax, " << this << endl;
-  }
-  else {
-    cout << "\tmovl\t" << _left << ", %eax" << endl;
-    cout << "\tcmpl\t" << "$0" << ", %eax" << endl;
-    cout << "\tjne\t" << firstLabel << endl;
-    cout << "\tmovl\t" << _right << ", %eax" << endl;
-    cout << "\tcmpl\t" << "$0" << ", %eax" << endl;
-    cout << "\tjne\t" << firstLabel << endl;
-    cout << "\tmovl\t" << "$0" << ", %eax" << endl;
-    cout << "\tjmp\t" << secondLabel << endl;
-    cout << firstLabel << ":" << endl;
-    cout << "\tmovl\t" << "$1" << ", %eax" << endl;
-    cout << secondLabel << ":" << endl;
-    cout << "\tmovl\t%eax, " << this << endl;
-  }
+  out.comment("LogicalOrring");
+  condition(this);
 }
 
 void LogicalAnd::generate() {
-  _left->generate();
-  _right->generate();
-  assigntemp(this);
+  out.comment("LogicalAnding");
+  condition(this);
+}
 
-  Label firstLabel, secondLabel;
 
-  if (FP(this)) {
-    //cout << "\tfldl\t" << _left << endl;
+/*
+ * Function:	LogicalOr::test
+ *
+ * Description:	Branch to the label if this expression is true, or if it is
+ *		false, as given.  The right operand is evaluated only if
+ *		the left one is false.
+ */
+
+void LogicalOr::test(const Label &label, bool ifTrue) {
+  if (ifTrue) {
+    _left->test(label, true);
+    _right->test(label, true);
+  } else {
+    Label skip;
+    _left->test(skip, true);
+    _right->test(label, false);
+    out << skip << ":\n";
   }
-  else {
-    cout << "#LogicalAnding" << endl;
-    cout << "\tmovl\t" << _left << ", %eax" << endl;
-    cout << "\tcmpl\t" << "$0" << ", %eax" << endl;
-    cout << "\tje\t" << firstLabel << endl;
-    cout << "\tmovl\t" << _right << ", %eax" << endl;
-    cout << "\tcmpl\t" << "$0" << ", %eax" << endl;
-    cout << "\tje\t" << firstLabel << endl;
-    cout << "\tmovl\t" << "$1" << ", %eax" << endl;
-    cout << "\tjmp\t" << secondLabel << endl;
-    cout << firstLabel << ":" << endl;
-    // cout << "#Got here" << endl;
-    cout << "\tmovl\t" << "$0" << ", %eax" << endl;
-    cout << secondLabel << ":" << endl;
-    cout << "\tmovl\t%eax, " << this << endl;
-    // cout << "#Second Label" << endl;
-    // assigntemp(this);
+}
+
+
+/*
+ * Function:	LogicalAnd::test
+ *
+ * Description:	Branch to the label if this expression is true, or if it is
+ *		false, as given.  The right operand is evaluated only if
+ *		the left one is true.
+ */
+
+void LogicalAnd::test(const Label &label, bool ifTrue) {
+  if (ifTrue) {
+    Label skip;
+    _left->test(skip, false);
+    _right->test(label, true);
+    out << skip << ":\n";
+  } else {
+    _left->test(label, false);
+    _right->test(label, false);
   }
 }
 
-void Increment::generate() {
-  _expr->generate();
-  assigntemp(this);
-
-  Expression * child = _expr->isDereference();
-  if (child!=nullptr) {
-    cout << "#Deref increment" << endl;
-    if (FP(this)) {
-      cout << "#Deref increment for FP" << endl;
-      cout << "\tfldl\t" << _expr << endl;
-      cout << "\tfld1\t" << endl;
-      cout << "\tfaddp\t" << endl;
-      cout << "\tmovl\t" << child << ", %ecx" << endl;
-      cout << "\tfstpl\t" << "(%ecx)" << endl;
-    }
-    else {
-      cout << "#Deref increment for non FP" << endl;
-      cout << "\tmovl\t" << _expr << ", %eax" << endl;
-      cout << "\taddl\t$" << scale << ", %eax"<< endl;
-      cout << "\tmovl\t" << child << ", %ecx" << endl;
-      cout << "\tmovl\t" << "%eax" << ", (%ecx)" << endl;
-    }
+
+/*
+ * Function:	Not::test
+ *
+ * Description:	Branch to the label if this expression is true, or if it is
+ *		false, as given, by testing the operand the other way.
+ */
+
+void Not::test(const Label &label, bool ifTrue) {
+  _expr->test(label, !ifTrue);
+}
+
+
+/*
+ * Function:	update (private)
+ *
+ * Description:	Generate code for a postfix increment or decrement of the
+ *		given lvalue by the given amount.  The result is the value
+ *		before the update.
+ */
+
+static void update(Expression *expr, Expression *result, int delta) {
+  Expression *pointer = expr->isDereference();
+  stringstream dest;
+  Register *reg;
+
+  if (pointer != nullptr) {
+    pointer->generate();
+    dest << "(" << load(pointer) << ")";
+  } else
+    dest << expr;
+
+  if (FP(expr) && sse) {
+    reg = getreg(true);
+    out << "\tmovsd\t" << dest.str() << ", " << reg << '\n';
+    out << "\tmovapd\t" << reg << ", %xmm0\n";
+    out << "\taddsd\t";
+    constant(out, delta < 0 ? -1 : 1);
+    out << ", %xmm0\n";
+    out << "\tmovsd\t%xmm0, " << dest.str() << '\n';
+    define(result, reg);
+  }
+  else if (FP(expr)) {
+    out << "\tfldl\t" << dest.str() << '\n';
+    assigntemp(result);
+    out << "\tfstl\t" << result << '\n';
+    out << "\tfld1\t\n";
+    if (delta < 0)
+      out << "\tfchs\t\n";
+    out << "\tfaddp\t\n";
+    out << "\tfstpl\t" << dest.str() << '\n';
   }
   else {
-    cout << "#Nonderef increment" << endl;
-    if (FP(this)) {
-      cout << "#Nonderef increment for FP" << endl;
-      cout << "\tfldl\t" << _expr << endl;
-      cout << "\tfld1\t" << endl;
-      cout << "\tfaddp\t" << endl;
-      cout << "\tfstpl\t" << this << endl;
-      //Must make sure that new calculation is also stored into expr
-      cout << "\tfldl\t" << this << endl;
-      cout << "\tfstpl\t" << _expr << endl;
+    reg = getreg();
+
+    if (BYTE(expr)) {
+      out << "\tmovsbl\t" << dest.str() << ", " << reg->name(4) << '\n';
+      out << "\taddb\t$" << delta << ", " << dest.str() << '\n';
     }
     else {
-      cout << "#Nonderef increment for non FP" << endl;
-      cout << "\tmovl\t" << _expr << ", %eax" << endl;
-      cout << "\taddl\t" << "$1" << ", %eax"<< endl;
-      cout << "\tmovl\t%eax, " << this << endl;
-      //Must make sure that new calculation is also stored into expr
-      cout << "\tmovl\t%eax, " << _expr << endl;
+      out << "\tmov" << suffix(width(expr)) << "\t" << dest.str() << ", " << reg->name(width(expr)) << '\n';
+      out << "\tadd" << suffix(width(expr)) << "\t$" << delta << ", " << dest.str() << '\n';
     }
+
+    define(result, reg);
   }
+
+  if (pointer != nullptr)
+    release(pointer);
+}
+
+void Increment::generate() {
+  update(_expr, this, scale);
 }
 
 void Decrement::generate() {
-  _expr->generate();
-  assigntemp(this);
-
-  Expression * child = _expr->isDereference();
-  if (child!=nullptr) {
-    cout << "#Deref increment" << endl;
-    if (FP(this)) {
-      cout << "#Deref increment for FP" << endl;
-      cout << "\tfld1\t" << endl;
-      cout << "\tfldl\t" << _expr << endl;
-      cout << "\tfsubp\t" << endl;
-      cout << "\tmovl\t" << child << ", %ecx" << endl;
-      cout << "\tfstpl\t" << "(%ecx)" << endl;
-    }
-    else {
-      cout << "#Deref increment for non FP" << endl;
-      cout << "\tmovl\t" << _expr << ", %eax" << endl;
-      cout << "\tsubl\t$" << scale << ", %eax"<< endl;
-      cout << "\tmovl\t" << child << ", %ecx" << endl;
-      cout << "\tmovl\t" << "%eax" << ", (%ecx)" << endl;
-    }
-  }
-  else {
-    cout << "#Nonderef increment" << endl;
-    if (FP(this)) {
-      cout << "#Nonderef increment for FP" << endl;
-      cout << "\tfld1\t" << endl;
-      cout << "\tfldl\t" << _expr << endl;
-      cout << "\tfsubp\t" << endl;
-      cout << "\tfstpl\t" << this << endl;
-      //Must make sure that new calculation is also stored into expr
-      cout << "\tfldl\t" << this << endl;
-      cout << "\tfstpl\t" << _expr << endl;
-    }
-    else {
-      cout << "#Nonderef increment for non FP" << endl;
-      cout << "\tmovl\t" << _expr << ", %eax" << endl;
-      cout << "\tsubl\t" << "$1" << ", %eax"<< endl;
-      cout << "\tmovl\t%eax, " << this << endl;
-      //Must make sure that new calculation is also stored into expr
-      cout << "\tmovl\t%eax, " << _expr << endl;
-    }
-  }
+  update(_expr, this, -(int) scale);
 }
 
 void Cast::generate() {
+  Register *reg, *byte;
+
   _expr->generate();
-  assigntemp(this);
-  cout << "#Casting" << endl;
+  out.comment("Casting");
   if (this->type().isNumeric()&&_expr->type().isNumeric()) {
-    if (FP(this)) {
-      if (FP(_expr)) {    // double to double
-        cout << "\tfldl\t" << _expr << endl;
-        cout << "\tfstpl\t" << this << endl;
+    if (FP(this) && sse) {
+      if (FP(_expr))    // double to double
+        reg = load(_expr);
+      else {    // char or int to double
+        if (BYTE(_expr) || dynamic_cast<Integer *>(_expr) != nullptr)
+          load(_expr);
+        reg = getreg(true);
+        out << "\tcvtsi2sdl\t" << _expr << ", " << reg << '\n';
+        release(_expr);
       }
-      else {
-        if BYTE(_expr) { // char to double
-          cout << "\tfildl\t" << _expr << endl; // this may be different
-          cout << "\tfstpl\t" << this << endl;
-        }
-        else {    // int to double
-          cout << "\tfildl\t" << _expr << endl;
-          cout << "\tfstpl\t" << this << endl;
-        }
+      define(this, reg);
+    }
+    else if (FP(_expr) && sse) {    // double to char or int
+      reg = getreg();
+      out << "\tcvttsd2si\t" << _expr << ", " << reg->name(4) << '\n';
+      release(_expr);
+
+      if (BYTE(this)) {
+        byte = byteable(reg);
+        out << "\tmovsbl\t" << byte->name(1) << ", " << reg->name(4) << '\n';
       }
+      define(this, reg);
     }
-    else if (BYTE(this)){
-      if (FP(_expr)) {    // double to char
-        cout << "\tfldl\t" << _expr << endl;
-        cout << "\tfisttpl\t" << this << endl;
-        cout << "\tmovl\t" << this << ", %eax"<< endl;
-        cout << "\tmovb\t" << "%al, " << this << endl;
+    else if (FP(this)) {
+      if (FP(_expr)) {    // double to double
+        out << "\tfldl\t" << _expr << '\n';
       }
-      else {
-        if BYTE(_expr) { // char to char
-          cout << "\tmovb\t" << _expr << ", %eax" << endl;
-          cout << "\tmovl\t%eax, " << this << endl;
-        }
-        else {    // int to char
-          cout << "\tmovl\t" << _expr << ", %eax" << endl;
-          cout << "\tmovb\t%eax, " << this << endl;
-        }
+      else {    // char or int to double
+        if (_expr->reg != nullptr)
+          spill(_expr->reg);
+        else if (BYTE(_expr) || dynamic_cast<Integer *>(_expr) != nullptr)
+          spill(load(_expr));
+        out << "\tfildl\t" << _expr << '\n';
+        release(_expr);
       }
+      assigntemp(this);
+      out << "\tfstpl\t" << this << '\n';
     }
-    else {
-      if (FP(_expr)) {    // double to int
-        cout << "\tfldl\t" << _expr << endl;
-        cout << "\tfisttpl\t" << this << endl;
-      }
-      else {
-        if BYTE(_expr) { // char to int
-          cout << "\tmovsbl\t" << _expr << ", %eax" << endl;
-          cout << "\tmovl\t%eax, " << this << endl;
-        }
-        else {    // int to int
-          cout << "\tmovl\t" << _expr << ", %eax" << endl;
-          cout << "\tmovl\t%eax, " << this << endl;
-        }
+    else if (FP(_expr)) {    // double to char or int
+      out << "\tfldl\t" << _expr << '\n';
+      assigntemp(this);
+      out << "\tfisttpl\t" << this << '\n';
+
+      if (BYTE(this)) {
+        reg = getreg();
+        out << "\tmovsbl\t" << this << ", " << reg->name(4) << '\n';
+        define(this, reg);
       }
     }
+    else if (BYTE(this) && !BYTE(_expr)) {    // int to char
+      reg = load(_expr);
+      byte = byteable(reg);
+      out << "\tmovsbl\t" << byte->name(1) << ", " << reg->name(4) << '\n';
+      define(this, reg);
+    }
+    else {    // char to int, or no conversion at all
+      reg = load(_expr);
+      define(this, reg);
+    }
   }
-  else {
-    cout << "\tmovl\t" << _expr << ", %eax" << endl;
-    cout << "\tmovl\t%eax, " << this << endl;
+  else {    // pointer to pointer, or between a pointer and an int
+    reg = load(_expr);
+    widen(_expr, width(this));
+    define(this, reg);
   }
 }
 
 void Expression::test(const Label &label, bool ifTrue) {
   generate();
-  if (FP(this)) {
-    cout << "\tfldl\t" << this << endl;
-    cout << "\tftst\t" << endl;
-    cout << "\tfnstsw\t" << "%ax" << endl;
-    cout << "\tsahf" << endl;
-  }
-  else {
-    cout << "\tmovl\t" << this << ", %eax" << endl;
-    cout << "\tcmpl\t$0, %eax" << endl;
-  }
+  compare(this);
+  release(this);
 
-  cout << (ifTrue ? "\tjne\t" : "\tje\t") << label << endl;
+  if (FP(this))
+    fpjump(label, !ifTrue);
+  else
+    out << (ifTrue ? "\tjne\t" : "\tje\t") << label << '\n';
 }
 
 void While::generate() {
   Label loop, exit;
-  breaks.push_back(exit);
-  cout << loop << ":" << endl;
+  context->breaks.push_back(exit);
+  out << loop << ":\n";
 
   _expr->test(exit, false);
-  _stmt->generate();
+  statement(_stmt);
 
-  cout << "\tjmp\t" << loop << endl;
-  cout << exit << ":" << endl;
+  out << "\tjmp\t" << loop << '\n';
+  out << exit << ":\n";
+  context->breaks.pop_back();
 }
 
 void For::generate() {
   Label loop, exit;
-  breaks.push_back(exit);
-  _init->generate();
-  cout << loop << ":" << endl;
+  context->breaks.push_back(exit);
+  statement(_init);
+  out << loop << ":\n";
 
   _expr->test(exit, false);
-  _stmt->generate();
-  _incr->generate();
-  cout << "\tjmp\t" << loop << endl;
-  cout << exit << ":" << endl;
+  statement(_stmt);
+  statement(_incr);
+  out << "\tjmp\t" << loop << '\n';
+  out << exit << ":\n";
+  context->breaks.pop_back();
 }
 
 void If::generate() {
   Label skip;
 
-  cout << "#If" << endl;
+  out.comment("If");
   _expr->test(skip, false);
-  _thenStmt->generate();
+  statement(_thenStmt);
 
   if (!_elseStmt) {
-    cout << skip << ":" << endl;
+    out << skip << ":\n";
   } else {
     Label exit;
-    cout << "\tjmp\t" << exit << endl;
-    cout << skip << ":" << endl;
-    _elseStmt->generate();
-    cout << exit << ":" << endl;
+    out << "\tjmp\t" << exit << '\n';
+    out << skip << ":\n";
+    statement(_elseStmt);
+    out << exit << ":\n";
   }
 }
 
 void Return::generate() {
   _expr->generate();
 
-  if (FP(_expr)) {
-    cout << "\tfldl\t" << _expr << endl;
+  if (FP(_expr) && LONG_MODE)
+    move(_expr, xmm[0]);
+  else if (FP(_expr)) {
+    if (_expr->reg != nullptr)
+      spill(_expr->reg);
+    out << "\tfldl\t" << _expr << '\n';
   }
   else {
-    cout << "\tmovl\t" << _expr << ", %eax" << endl;
+    move(_expr, eax);
   }
-  cout << "\tjmp\t" << globalReturn << endl;
+  release(_expr);
+  out << "\tjmp\t" << context->globalReturn << '\n';
 }
 
 void Break::generate() {
-  cout << "\tjmp\t" << breaks.back() << endl;
-  breaks.pop_back();
+  out << "\tjmp\t" << context->breaks.back() << '\n';
 }
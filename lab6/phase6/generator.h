@@ -4,12 +4,39 @@
  * Description:	This file contains the function declarations for the code
  *		generator for Simple C.  Most of the function declarations
  *		are actually member functions provided as part of Tree.h.
+ *		Up to the given number of jobs generate functions at once,
+ *		floating-point arithmetic uses SSE2 if sse is set, and the
+ *		code of each function is optimized if peephole is set.  If
+ *		wholeProgram is set, functions and variables that main
+ *		cannot reach are dropped.
  */
 
 # ifndef GENERATOR_H
 # define GENERATOR_H
+# include <unordered_set>
+# include "Arena.h"
+# include "Cache.h"
+# include "Emitter.h"
 # include "Scope.h"
 
+extern bool regalloc;
+extern bool peephole;
+extern bool wholeProgram;
+extern bool sse;
+extern unsigned jobs;
+extern Emitter output;
+
+typedef std::unordered_set<Name> Mentions;
+
+void generateFunction(class Function *function, const Name &name,
+		      const Mentions &mentions, Arena *arena,
+		      const Digest *key = nullptr);
+bool generateCached(const Name &name, const Mentions &mentions,
+		    const Digest &key);
 void generateGlobals(Scope *scope);
+void constant(std::ostream &ostr, const std::string &text);
+void constant(std::ostream &ostr, double number);
+void divide(std::ostream &ostr, const std::string &dividend, int divisor,
+	    bool remainder);
 
 # endif /* GENERATOR_H */
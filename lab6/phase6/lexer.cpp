@@ -1,2227 +1,597 @@
-
-#line 3 "<stdout>"
-
-#define  YY_INT_ALIGNED short int
-
-/* A lexical scanner generated by flex */
-
-#define FLEX_SCANNER
-#define YY_FLEX_MAJOR_VERSION 2
-#define YY_FLEX_MINOR_VERSION 5
-#define YY_FLEX_SUBMINOR_VERSION 37
-#if YY_FLEX_SUBMINOR_VERSION > 0
-#define FLEX_BETA
-#endif
-
-/* First, we deal with  platform-specific or compiler-specific issues. */
-
-/* begin standard C headers. */
-#include <stdio.h>
-#include <string.h>
-#include <errno.h>
-#include <stdlib.h>
-
-/* end standard C headers. */
-
-/* flex integer type definitions */
-
-#ifndef FLEXINT_H
-#define FLEXINT_H
-
-/* C99 systems have <inttypes.h>. Non-C99 systems may or may not. */
-
-#if defined (__STDC_VERSION__) && __STDC_VERSION__ >= 199901L
-
-/* C99 says to define __STDC_LIMIT_MACROS before including stdint.h,
- * if you want the limit (max/min) macros for int types. 
- */
-#ifndef __STDC_LIMIT_MACROS
-#define __STDC_LIMIT_MACROS 1
-#endif
-
-#include <inttypes.h>
-typedef int8_t flex_int8_t;
-typedef uint8_t flex_uint8_t;
-typedef int16_t flex_int16_t;
-typedef uint16_t flex_uint16_t;
-typedef int32_t flex_int32_t;
-typedef uint32_t flex_uint32_t;
-#else
-typedef signed char flex_int8_t;
-typedef short int flex_int16_t;
-typedef int flex_int32_t;
-typedef unsigned char flex_uint8_t; 
-typedef unsigned short int flex_uint16_t;
-typedef unsigned int flex_uint32_t;
-
-/* Limits of integral types. */
-#ifndef INT8_MIN
-#define INT8_MIN               (-128)
-#endif
-#ifndef INT16_MIN
-#define INT16_MIN              (-32767-1)
-#endif
-#ifndef INT32_MIN
-#define INT32_MIN              (-2147483647-1)
-#endif
-#ifndef INT8_MAX
-#define INT8_MAX               (127)
-#endif
-#ifndef INT16_MAX
-#define INT16_MAX              (32767)
-#endif
-#ifndef INT32_MAX
-#define INT32_MAX              (2147483647)
-#endif
-#ifndef UINT8_MAX
-#define UINT8_MAX              (255U)
-#endif
-#ifndef UINT16_MAX
-#define UINT16_MAX             (65535U)
-#endif
-#ifndef UINT32_MAX
-#define UINT32_MAX             (4294967295U)
-#endif
-
-#endif /* ! C99 */
-
-#endif /* ! FLEXINT_H */
-
-#ifdef __cplusplus
-
-/* The "const" storage-class-modifier is valid. */
-#define YY_USE_CONST
-
-#else	/* ! __cplusplus */
-
-/* C99 requires __STDC__ to be defined as 1. */
-#if defined (__STDC__)
-
-#define YY_USE_CONST
-
-#endif	/* defined (__STDC__) */
-#endif	/* ! __cplusplus */
-
-#ifdef YY_USE_CONST
-#define yyconst const
-#else
-#define yyconst
-#endif
-
-/* Returned upon end-of-file. */
-#define YY_NULL 0
-
-/* Promotes a possibly negative, possibly signed char to an unsigned
- * integer for use as an array index.  If the signed char is negative,
- * we want to instead treat it as an 8-bit unsigned char, hence the
- * double cast.
- */
-#define YY_SC_TO_UI(c) ((unsigned int) (unsigned char) c)
-
-/* Enter a start condition.  This macro really ought to take a parameter,
- * but we do it the disgusting crufty way forced on us by the ()-less
- * definition of BEGIN.
- */
-#define BEGIN (yy_start) = 1 + 2 *
-
-/* Translate the current start state into a value that can be later handed
- * to BEGIN to return to the state.  The YYSTATE alias is for lex
- * compatibility.
- */
-#define YY_START (((yy_start) - 1) / 2)
-#define YYSTATE YY_START
-
-/* Action number for EOF rule of a given start state. */
-#define YY_STATE_EOF(state) (YY_END_OF_BUFFER + state + 1)
-
-/* Special action meaning "start processing a new file". */
-#define YY_NEW_FILE yyrestart(yyin  )
-
-#define YY_END_OF_BUFFER_CHAR 0
-
-/* Size of default input buffer. */
-#ifndef YY_BUF_SIZE
-#define YY_BUF_SIZE 16384
-#endif
-
-/* The state buf must be large enough to hold one state per character in the main buffer.
- */
-#define YY_STATE_BUF_SIZE   ((YY_BUF_SIZE + 2) * sizeof(yy_state_type))
-
-#ifndef YY_TYPEDEF_YY_BUFFER_STATE
-#define YY_TYPEDEF_YY_BUFFER_STATE
-typedef struct yy_buffer_state *YY_BUFFER_STATE;
-#endif
-
-#ifndef YY_TYPEDEF_YY_SIZE_T
-#define YY_TYPEDEF_YY_SIZE_T
-typedef size_t yy_size_t;
-#endif
-
-extern yy_size_t yyleng;
-
-extern FILE *yyin, *yyout;
-
-#define EOB_ACT_CONTINUE_SCAN 0
-#define EOB_ACT_END_OF_FILE 1
-#define EOB_ACT_LAST_MATCH 2
-
-    /* Note: We specifically omit the test for yy_rule_can_match_eol because it requires
-     *       access to the local variable yy_act. Since yyless() is a macro, it would break
-     *       existing scanners that call yyless() from OUTSIDE yylex. 
-     *       One obvious solution it to make yy_act a global. I tried that, and saw
-     *       a 5% performance hit in a non-yylineno scanner, because yy_act is
-     *       normally declared as a register variable-- so it is not worth it.
-     */
-    #define  YY_LESS_LINENO(n) \
-            do { \
-                int yyl;\
-                for ( yyl = n; yyl < yyleng; ++yyl )\
-                    if ( yytext[yyl] == '\n' )\
-                        --yylineno;\
-            }while(0)
-    
-/* Return all but the first "n" matched characters back to the input stream. */
-#define yyless(n) \
-	do \
-		{ \
-		/* Undo effects of setting up yytext. */ \
-        int yyless_macro_arg = (n); \
-        YY_LESS_LINENO(yyless_macro_arg);\
-		*yy_cp = (yy_hold_char); \
-		YY_RESTORE_YY_MORE_OFFSET \
-		(yy_c_buf_p) = yy_cp = yy_bp + yyless_macro_arg - YY_MORE_ADJ; \
-		YY_DO_BEFORE_ACTION; /* set up yytext again */ \
-		} \
-	while ( 0 )
-
-#define unput(c) yyunput( c, (yytext_ptr)  )
-
-#ifndef YY_STRUCT_YY_BUFFER_STATE
-#define YY_STRUCT_YY_BUFFER_STATE
-struct yy_buffer_state
-	{
-	FILE *yy_input_file;
-
-	char *yy_ch_buf;		/* input buffer */
-	char *yy_buf_pos;		/* current position in input buffer */
-
-	/* Size of input buffer in bytes, not including room for EOB
-	 * characters.
-	 */
-	yy_size_t yy_buf_size;
-
-	/* Number of characters read into yy_ch_buf, not including EOB
-	 * characters.
-	 */
-	yy_size_t yy_n_chars;
-
-	/* Whether we "own" the buffer - i.e., we know we created it,
-	 * and can realloc() it to grow it, and should free() it to
-	 * delete it.
-	 */
-	int yy_is_our_buffer;
-
-	/* Whether this is an "interactive" input source; if so, and
-	 * if we're using stdio for input, then we want to use getc()
-	 * instead of fread(), to make sure we stop fetching input after
-	 * each newline.
-	 */
-	int yy_is_interactive;
-
-	/* Whether we're considered to be at the beginning of a line.
-	 * If so, '^' rules will be active on the next match, otherwise
-	 * not.
-	 */
-	int yy_at_bol;
-
-    int yy_bs_lineno; /**< The line count. */
-    int yy_bs_column; /**< The column count. */
-    
-	/* Whether to try to fill the input buffer when we reach the
-	 * end of it.
-	 */
-	int yy_fill_buffer;
-
-	int yy_buffer_status;
-
-#define YY_BUFFER_NEW 0
-#define YY_BUFFER_NORMAL 1
-	/* When an EOF's been seen but there's still some text to process
-	 * then we mark the buffer as YY_EOF_PENDING, to indicate that we
-	 * shouldn't try reading from the input source any more.  We might
-	 * still have a bunch of tokens to match, though, because of
-	 * possible backing-up.
-	 *
-	 * When we actually see the EOF, we change the status to "new"
-	 * (via yyrestart()), so that the user can continue scanning by
-	 * just pointing yyin at a new input file.
-	 */
-#define YY_BUFFER_EOF_PENDING 2
-
-	};
-#endif /* !YY_STRUCT_YY_BUFFER_STATE */
-
-/* Stack of input buffers. */
-static size_t yy_buffer_stack_top = 0; /**< index of top of stack. */
-static size_t yy_buffer_stack_max = 0; /**< capacity of stack. */
-static YY_BUFFER_STATE * yy_buffer_stack = 0; /**< Stack as an array. */
-
-/* We provide macros for accessing buffer states in case in the
- * future we want to put the buffer states in a more general
- * "scanner state".
- *
- * Returns the top of the stack, or NULL.
- */
-#define YY_CURRENT_BUFFER ( (yy_buffer_stack) \
-                          ? (yy_buffer_stack)[(yy_buffer_stack_top)] \
-                          : NULL)
-
-/* Same as previous macro, but useful when we know that the buffer stack is not
- * NULL or when we need an lvalue. For internal use only.
- */
-#define YY_CURRENT_BUFFER_LVALUE (yy_buffer_stack)[(yy_buffer_stack_top)]
-
-/* yy_hold_char holds the character lost when yytext is formed. */
-static char yy_hold_char;
-static yy_size_t yy_n_chars;		/* number of characters read into yy_ch_buf */
-yy_size_t yyleng;
-
-/* Points to current character in buffer. */
-static char *yy_c_buf_p = (char *) 0;
-static int yy_init = 0;		/* whether we need to initialize */
-static int yy_start = 0;	/* start state number */
-
-/* Flag which is used to allow yywrap()'s to do buffer switches
- * instead of setting up a fresh yyin.  A bit of a hack ...
- */
-static int yy_did_buffer_switch_on_eof;
-
-void yyrestart (FILE *input_file  );
-void yy_switch_to_buffer (YY_BUFFER_STATE new_buffer  );
-YY_BUFFER_STATE yy_create_buffer (FILE *file,int size  );
-void yy_delete_buffer (YY_BUFFER_STATE b  );
-void yy_flush_buffer (YY_BUFFER_STATE b  );
-void yypush_buffer_state (YY_BUFFER_STATE new_buffer  );
-void yypop_buffer_state (void );
-
-static void yyensure_buffer_stack (void );
-static void yy_load_buffer_state (void );
-static void yy_init_buffer (YY_BUFFER_STATE b,FILE *file  );
-
-#define YY_FLUSH_BUFFER yy_flush_buffer(YY_CURRENT_BUFFER )
-
-YY_BUFFER_STATE yy_scan_buffer (char *base,yy_size_t size  );
-YY_BUFFER_STATE yy_scan_string (yyconst char *yy_str  );
-YY_BUFFER_STATE yy_scan_bytes (yyconst char *bytes,yy_size_t len  );
-
-void *yyalloc (yy_size_t  );
-void *yyrealloc (void *,yy_size_t  );
-void yyfree (void *  );
-
-#define yy_new_buffer yy_create_buffer
-
-#define yy_set_interactive(is_interactive) \
-	{ \
-	if ( ! YY_CURRENT_BUFFER ){ \
-        yyensure_buffer_stack (); \
-		YY_CURRENT_BUFFER_LVALUE =    \
-            yy_create_buffer(yyin,YY_BUF_SIZE ); \
-	} \
-	YY_CURRENT_BUFFER_LVALUE->yy_is_interactive = is_interactive; \
-	}
-
-#define yy_set_bol(at_bol) \
-	{ \
-	if ( ! YY_CURRENT_BUFFER ){\
-        yyensure_buffer_stack (); \
-		YY_CURRENT_BUFFER_LVALUE =    \
-            yy_create_buffer(yyin,YY_BUF_SIZE ); \
-	} \
-	YY_CURRENT_BUFFER_LVALUE->yy_at_bol = at_bol; \
-	}
-
-#define YY_AT_BOL() (YY_CURRENT_BUFFER_LVALUE->yy_at_bol)
-
-/* Begin user sect3 */
-
-#define yywrap() 1
-#define YY_SKIP_YYWRAP
-
-typedef unsigned char YY_CHAR;
-
-FILE *yyin = (FILE *) 0, *yyout = (FILE *) 0;
-
-typedef int yy_state_type;
-
-extern int yylineno;
-
-int yylineno = 1;
-
-extern char *yytext;
-#define yytext_ptr yytext
-
-static yy_state_type yy_get_previous_state (void );
-static yy_state_type yy_try_NUL_trans (yy_state_type current_state  );
-static int yy_get_next_buffer (void );
-static void yy_fatal_error (yyconst char msg[]  );
-
-/* Done after the current pattern has been matched and before the
- * corresponding action - sets up yytext.
- */
-#define YY_DO_BEFORE_ACTION \
-	(yytext_ptr) = yy_bp; \
-	yyleng = (size_t) (yy_cp - yy_bp); \
-	(yy_hold_char) = *yy_cp; \
-	*yy_cp = '\0'; \
-	(yy_c_buf_p) = yy_cp;
-
-#define YY_NUM_RULES 52
-#define YY_END_OF_BUFFER 53
-/* This struct is not used in this scanner,
-   but its presence is necessary. */
-struct yy_trans_info
-	{
-	flex_int32_t yy_verify;
-	flex_int32_t yy_nxt;
-	};
-static yyconst flex_int16_t yy_accept[190] =
-    {   0,
-        0,    0,   53,   51,   50,   50,   44,   51,   44,   44,
-       51,   44,   44,   44,   44,   46,   44,   44,   44,   45,
-       45,   45,   45,   45,   45,   45,   45,   45,   45,   45,
-       45,   45,   45,   45,   45,   44,   50,   37,    0,   48,
-        0,   35,    0,    0,   40,   41,   42,    0,    1,    0,
-       46,   38,   36,   39,   45,   45,   45,   45,   45,   45,
-       45,    9,   45,   45,   45,   45,   45,   45,   17,   45,
-       45,   45,   45,   45,   45,   45,   45,   45,   45,   45,
-       34,   49,   43,   47,   45,   45,   45,   45,   45,   45,
-       45,   45,   45,   45,   45,   15,   45,   18,   45,   45,
-
-       45,   45,   45,   45,   45,   45,   45,   45,   45,   45,
-       45,   45,   45,    0,    2,   45,    4,    5,   45,   45,
-       45,   45,   11,   12,   45,   45,   16,   19,   45,   45,
-       45,   45,   45,   45,   45,   45,   45,   45,   45,   31,
-       45,   45,    0,   47,    3,    6,   45,   45,   45,   45,
-       14,   45,   45,   22,   45,   45,   45,   45,   45,   45,
-       29,   45,   45,   33,   45,   45,   10,   13,   45,   21,
-       23,   24,   25,   26,   27,   45,   45,   45,   45,    8,
-       45,   28,   45,   45,    7,   20,   30,   32,    0
-    } ;
-
-static yyconst flex_int32_t yy_ec[256] =
-    {   0,
-        1,    1,    1,    1,    1,    1,    1,    1,    2,    3,
-        2,    2,    2,    1,    1,    1,    1,    1,    1,    1,
-        1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
-        1,    2,    4,    5,    1,    1,    6,    7,    8,    6,
-        6,    9,   10,    6,   11,   12,   13,   14,   14,   14,
-       14,   14,   14,   14,   14,   14,   14,    6,    6,   15,
-       16,   17,    1,    1,   18,   18,   18,   18,   19,   18,
-       18,   18,   18,   18,   18,   18,   18,   18,   18,   18,
-       18,   18,   18,   18,   18,   18,   18,   18,   18,   18,
-        6,   20,    6,    1,   18,    1,   21,   22,   23,   24,
-
-       25,   26,   27,   28,   29,   18,   30,   31,   32,   33,
-       34,   35,   18,   36,   37,   38,   39,   40,   41,   42,
-       43,   44,    6,   45,    6,    1,    1,    1,    1,    1,
-        1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
-        1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
-        1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
-        1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
-        1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
-        1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
-        1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
-
-        1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
-        1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
-        1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
-        1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
-        1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
-        1,    1,    1,    1,    1
-    } ;
-
-static yyconst flex_int32_t yy_meta[46] =
-    {   0,
-        1,    1,    2,    1,    1,    1,    1,    3,    1,    1,
-        1,    1,    1,    4,    1,    1,    1,    4,    4,    1,
-        4,    4,    4,    4,    4,    4,    4,    4,    4,    4,
-        4,    4,    4,    4,    4,    4,    4,    4,    4,    4,
-        4,    4,    4,    4,    1
-    } ;
-
-static yyconst flex_int16_t yy_base[193] =
-    {   0,
-        0,    0,  217,  218,   44,   46,  200,   45,  218,  208,
-      194,  203,   40,  200,  202,   40,  194,  193,  192,    0,
-      168,  170,   32,   30,   25,   28,  171,   35,  170,  178,
-       41,  159,  168,  166,  171,  153,   69,  218,   58,  218,
-        0,  218,   65,  189,  218,  218,  218,  184,  218,  181,
-       62,  218,  218,  218,    0,  156,  168,  155,  170,  157,
-      163,  149,  150,  147,  147,  150,  147,  144,    0,  143,
-      147,   48,  145,   50,   59,  149,  142,   52,   59,  147,
-      218,  218,  218,   73,  141,  153,  148,  136,   46,  150,
-      148,  144,  136,  142,  145,    0,  131,    0,  137,  134,
-
-      123,  125,  127,  134,  120,  118,  118,  130,  120,  124,
-      128,  130,  119,   86,    0,  119,    0,    0,  110,  118,
-      107,  114,    0,    0,  108,  105,    0,    0,  105,  105,
-      102,  114,  104,  108,  113,  112,  110,  100,  105,    0,
-       93,  105,  115,  114,    0,    0,   94,   95,  100,   91,
-        0,   85,   89,    0,   97,   94,   96,   80,   89,   91,
-        0,   82,   85,    0,   74,   74,    0,    0,   86,    0,
-        0,    0,    0,    0,    0,   84,   84,   76,   81,    0,
-       66,    0,   75,   68,    0,    0,    0,    0,  218,  100,
-      104,   87
-
-    } ;
-
-static yyconst flex_int16_t yy_def[193] =
-    {   0,
-      189,    1,  189,  189,  189,  189,  189,  190,  189,  189,
-      191,  189,  189,  189,  189,  189,  189,  189,  189,  192,
-      192,  192,  192,  192,  192,  192,  192,  192,  192,  192,
-      192,  192,  192,  192,  192,  189,  189,  189,  190,  189,
-      190,  189,  191,  191,  189,  189,  189,  189,  189,  189,
-      189,  189,  189,  189,  192,  192,  192,  192,  192,  192,
-      192,  192,  192,  192,  192,  192,  192,  192,  192,  192,
-      192,  192,  192,  192,  192,  192,  192,  192,  192,  192,
-      189,  189,  189,  189,  192,  192,  192,  192,  192,  192,
-      192,  192,  192,  192,  192,  192,  192,  192,  192,  192,
-
-      192,  192,  192,  192,  192,  192,  192,  192,  192,  192,
-      192,  192,  192,  189,  192,  192,  192,  192,  192,  192,
-      192,  192,  192,  192,  192,  192,  192,  192,  192,  192,
-      192,  192,  192,  192,  192,  192,  192,  192,  192,  192,
-      192,  192,  189,  189,  192,  192,  192,  192,  192,  192,
-      192,  192,  192,  192,  192,  192,  192,  192,  192,  192,
-      192,  192,  192,  192,  192,  192,  192,  192,  192,  192,
-      192,  192,  192,  192,  192,  192,  192,  192,  192,  192,
-      192,  192,  192,  192,  192,  192,  192,  192,    0,  189,
-      189,  189
-
-    } ;
-
-static yyconst flex_int16_t yy_nxt[264] =
-    {   0,
-        4,    5,    6,    7,    8,    9,   10,   11,    9,   12,
-       13,   14,   15,   16,   17,   18,   19,   20,   20,    4,
-       21,   22,   23,   24,   25,   26,   27,   20,   28,   20,
-       29,   20,   20,   20,   20,   30,   31,   32,   33,   34,
-       35,   20,   20,   20,   36,   37,   37,   37,   37,   40,
-       46,   50,   58,   51,   61,   63,   47,   64,   66,   59,
-       69,   67,   40,   62,   41,   60,   65,   70,   73,   74,
-       37,   37,   82,   50,  100,   51,  103,   41,   75,  105,
-      109,   76,  119,  120,   44,  101,   84,  111,  110,  112,
-       55,  114,  188,  104,  106,  143,  143,  114,  187,  144,
-
-       39,  186,   39,   39,   43,  185,  184,   43,  183,  182,
-      181,  180,  179,  178,  177,  176,  175,  174,  173,  172,
-      171,  170,  169,  168,  167,  166,  165,  144,  144,  164,
-      163,  162,  161,  160,  159,  158,  157,  156,  155,  154,
-      153,  152,  151,  150,  149,  148,  147,  146,  145,  142,
-      141,  140,  139,  138,  137,  136,  135,  134,  133,  132,
-      131,  130,  129,  128,  127,  126,  125,  124,  123,  122,
-      121,  118,  117,  116,  115,  113,  108,  107,  102,   99,
-       98,   97,   96,   95,   94,   93,   92,   91,   90,   89,
-       88,   87,   86,   85,   84,   83,   43,   81,   80,   79,
-
-       78,   77,   72,   71,   68,   57,   56,   54,   53,   52,
-       49,   48,   45,   44,   42,   38,  189,    3,  189,  189,
-      189,  189,  189,  189,  189,  189,  189,  189,  189,  189,
-      189,  189,  189,  189,  189,  189,  189,  189,  189,  189,
-      189,  189,  189,  189,  189,  189,  189,  189,  189,  189,
-      189,  189,  189,  189,  189,  189,  189,  189,  189,  189,
-      189,  189,  189
-    } ;
-
-static yyconst flex_int16_t yy_chk[264] =
-    {   0,
-        1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
-        1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
-        1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
-        1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
-        1,    1,    1,    1,    1,    5,    5,    6,    6,    8,
-       13,   16,   23,   16,   24,   25,   13,   25,   26,   23,
-       28,   26,   39,   24,    8,   23,   25,   28,   31,   31,
-       37,   37,   43,   51,   72,   51,   74,   39,   31,   75,
-       78,   31,   89,   89,   43,   72,   84,   79,   78,   79,
-      192,   84,  184,   74,   75,  114,  114,   84,  183,  114,
-
-      190,  181,  190,  190,  191,  179,  178,  191,  177,  176,
-      169,  166,  165,  163,  162,  160,  159,  158,  157,  156,
-      155,  153,  152,  150,  149,  148,  147,  144,  143,  142,
-      141,  139,  138,  137,  136,  135,  134,  133,  132,  131,
-      130,  129,  126,  125,  122,  121,  120,  119,  116,  113,
-      112,  111,  110,  109,  108,  107,  106,  105,  104,  103,
-      102,  101,  100,   99,   97,   95,   94,   93,   92,   91,
-       90,   88,   87,   86,   85,   80,   77,   76,   73,   71,
-       70,   68,   67,   66,   65,   64,   63,   62,   61,   60,
-       59,   58,   57,   56,   50,   48,   44,   36,   35,   34,
-
-       33,   32,   30,   29,   27,   22,   21,   19,   18,   17,
-       15,   14,   12,   11,   10,    7,    3,  189,  189,  189,
-      189,  189,  189,  189,  189,  189,  189,  189,  189,  189,
-      189,  189,  189,  189,  189,  189,  189,  189,  189,  189,
-      189,  189,  189,  189,  189,  189,  189,  189,  189,  189,
-      189,  189,  189,  189,  189,  189,  189,  189,  189,  189,
-      189,  189,  189
-    } ;
-
-/* Table of booleans, true if rule could match eol. */
-static yyconst flex_int32_t yy_rule_can_match_eol[53] =
-    {   0,
-0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 
-    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 
-    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0,     };
-
-static yy_state_type yy_last_accepting_state;
-static char *yy_last_accepting_cpos;
-
-extern int yy_flex_debug;
-int yy_flex_debug = 0;
-
-/* The intent behind this definition is that it'll catch
- * any uses of REJECT which flex missed.
- */
-#define REJECT reject_used_but_not_detected
-#define yymore() yymore_used_but_not_detected
-#define YY_MORE_ADJ 0
-#define YY_RESTORE_YY_MORE_OFFSET
-char *yytext;
-#line 1 "lexer.l"
-#line 2 "lexer.l"
 /*
- * File:	lexer.l
+ * File:	lexer.cpp
  *
- * Description:	This file contains the flex description for the lexical
- *		analyzer for Simple C.
+ * Description:	This file contains the lexical analyzer for Simple C.  The
+ *		entire input is mapped into memory, or read into memory if
+ *		it cannot be mapped, and each token is left as a slice of
+ *		the input in yytext and yyleng.  Keywords are recognized
+ *		with a perfect hash on their first, second, and last
+ *		characters, and comments are skipped with memchr.
  *
  *		Extra functionality:
  *		- checking for out of range integer and real literals
  *		- checking for invalid string and character literals
  */
 
+# include <algorithm>
 # include <cerrno>
 # include <cstdlib>
+# include <cstring>
 # include <iostream>
+# include <vector>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+# include "Cache.h"
 # include "string.h"
+# include "Timer.h"
 # include "tokens.h"
 # include "lexer.h"
 
 using namespace std;
 
 int numerrors = 0;
-static void checkInt(), checkReal();
-static void checkString(), checkChar();
-static void ignoreComment();
-#line 619 "<stdout>"
+int yylineno = 1;
+const char *yytext = "";
+size_t yyleng = 0;
+Name yyname;
+
+static const char *cursor, *limit;
+
+static vector<Token> window;
+static size_t first, last;
+static int line = 1;
+static bool quiet;
+static string *deferred;
+
+enum {SKIP = 0, OTHER = 1, LETTER = 2, DIGIT = 4};
+static unsigned char classes[256];
+
+struct Keyword {
+    const char *text;
+    int token;
+};
+
+static const Keyword keywords[] = {
+    {"auto", AUTO}, {"break", BREAK}, {"case", CASE}, {"char", CHAR},
+    {"const", CONST}, {"continue", CONTINUE}, {"default", DEFAULT},
+    {"do", DO}, {"double", DOUBLE}, {"else", ELSE}, {"enum", ENUM},
+    {"extern", EXTERN}, {"float", FLOAT}, {"for", FOR}, {"goto", GOTO},
+    {"if", IF}, {"int", INT}, {"long", LONG}, {"register", REGISTER},
+    {"return", RETURN}, {"short", SHORT}, {"signed", SIGNED},
+    {"sizeof", SIZEOF}, {"static", STATIC}, {"struct", STRUCT},
+    {"switch", SWITCH}, {"typedef", TYPEDEF}, {"union", UNION},
+    {"unsigned", UNSIGNED}, {"void", VOID}, {"volatile", VOLATILE},
+    {"while", WHILE},
+};
+
+static const unsigned HASH_SIZE = 128;
+static const Keyword *table[HASH_SIZE];
 
-#define INITIAL 0
 
-#ifndef YY_NO_UNISTD_H
-/* Special case for "unistd.h", since it is non-ANSI. We include it way
- * down here because we want the user's section 1 to have been scanned first.
- * The user has a chance to override it with an option.
+/*
+ * Function:	perfect
+ *
+ * Description:	Return the hash value of a word, which has at least two
+ *		characters.  The function is perfect for the keywords.
  */
-#include <unistd.h>
-#endif
-
-#ifndef YY_EXTRA_TYPE
-#define YY_EXTRA_TYPE void *
-#endif
-
-static int yy_init_globals (void );
-
-/* Accessor methods to globals.
-   These are made visible to non-reentrant scanners for convenience. */
 
-int yylex_destroy (void );
-
-int yyget_debug (void );
-
-void yyset_debug (int debug_flag  );
+static unsigned perfect(const char *text, size_t length)
+{
+    unsigned char c0 = text[0], c1 = text[1], cn = text[length - 1];
+    return (4 * c0 + c1 + 10 * cn) % HASH_SIZE;
+}
 
-YY_EXTRA_TYPE yyget_extra (void );
 
-void yyset_extra (YY_EXTRA_TYPE user_defined  );
+/*
+ * Function:	initialize
+ *
+ * Description:	Map the standard input into memory, or read it if it is
+ *		not a regular file, and build the tables used to classify
+ *		characters and recognize keywords.
+ */
 
-FILE *yyget_in (void );
+static void initialize()
+{
+    static vector<char> buffer;
+    struct stat st;
+    const char *s;
+    size_t length;
+    void *data;
+    ssize_t n;
+    unsigned h;
+    int c;
 
-void yyset_in  (FILE * in_str  );
 
-FILE *yyget_out (void );
+    if (fstat(0, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0
+	    && lseek(0, 0, SEEK_CUR) == 0) {
+	data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, 0, 0);
 
-void yyset_out  (FILE * out_str  );
+	if (data != MAP_FAILED) {
+	    cursor = static_cast<const char *>(data);
+	    limit = cursor + st.st_size;
+	}
+    }
 
-yy_size_t yyget_leng (void );
+    if (cursor == nullptr) {
+	buffer.resize(1 << 16);
+	length = 0;
 
-char *yyget_text (void );
+	while ((n = read(0, &buffer[length], buffer.size() - length)) != 0)
+	    if (n > 0) {
+		length += n;
 
-int yyget_lineno (void );
+		if (length == buffer.size())
+		    buffer.resize(buffer.size() * 2);
 
-void yyset_lineno (int line_number  );
+	    } else if (errno != EINTR) {
+		perror("read");
+		exit(EXIT_FAILURE);
+	    }
 
-/* Macros after this point can all be overridden by user definitions in
- * section 1.
- */
+	cursor = buffer.data();
+	limit = cursor + length;
+    }
 
-#ifndef YY_SKIP_YYWRAP
-#ifdef __cplusplus
-extern "C" int yywrap (void );
-#else
-extern int yywrap (void );
-#endif
-#endif
-
-#ifndef yytext_ptr
-static void yy_flex_strncpy (char *,yyconst char *,int );
-#endif
-
-#ifdef YY_NEED_STRLEN
-static int yy_flex_strlen (yyconst char * );
-#endif
-
-#ifndef YY_NO_INPUT
-
-#ifdef __cplusplus
-static int yyinput (void );
-#else
-static int input (void );
-#endif
-
-#endif
-
-/* Amount of stuff to slurp up with each read. */
-#ifndef YY_READ_BUF_SIZE
-#define YY_READ_BUF_SIZE 8192
-#endif
-
-/* Copy whatever the last rule matched to the standard output. */
-#ifndef ECHO
-/* This used to be an fputs(), but since the string might contain NUL's,
- * we now use fwrite().
- */
-#define ECHO do { if (fwrite( yytext, yyleng, 1, yyout )) {} } while (0)
-#endif
+    for (c = 'a'; c <= 'z'; c ++)
+	classes[c] = classes[c - 'a' + 'A'] = LETTER;
 
-/* Gets input and stuffs it into "buf".  number of characters read, or YY_NULL,
- * is returned in "result".
- */
-#ifndef YY_INPUT
-#define YY_INPUT(buf,result,max_size) \
-	if ( YY_CURRENT_BUFFER_LVALUE->yy_is_interactive ) \
-		{ \
-		int c = '*'; \
-		size_t n; \
-		for ( n = 0; n < max_size && \
-			     (c = getc( yyin )) != EOF && c != '\n'; ++n ) \
-			buf[n] = (char) c; \
-		if ( c == '\n' ) \
-			buf[n++] = (char) c; \
-		if ( c == EOF && ferror( yyin ) ) \
-			YY_FATAL_ERROR( "input in flex scanner failed" ); \
-		result = n; \
-		} \
-	else \
-		{ \
-		errno=0; \
-		while ( (result = fread(buf, 1, max_size, yyin))==0 && ferror(yyin)) \
-			{ \
-			if( errno != EINTR) \
-				{ \
-				YY_FATAL_ERROR( "input in flex scanner failed" ); \
-				break; \
-				} \
-			errno=0; \
-			clearerr(yyin); \
-			} \
-		}\
-\
-
-#endif
-
-/* No semi-colon after return; correct usage is to write "yyterminate();" -
- * we don't want an extra ';' after the "return" because that will cause
- * some compilers to complain about unreachable statements.
- */
-#ifndef yyterminate
-#define yyterminate() return YY_NULL
-#endif
+    for (c = '0'; c <= '9'; c ++)
+	classes[c] = DIGIT;
 
-/* Number of entries by which start-condition stack grows. */
-#ifndef YY_START_STACK_INCR
-#define YY_START_STACK_INCR 25
-#endif
+    classes['_'] = LETTER;
 
-/* Report a fatal error. */
-#ifndef YY_FATAL_ERROR
-#define YY_FATAL_ERROR(msg) yy_fatal_error( msg )
-#endif
+    for (s = "-|=<>+*/%&!()[]{};:.,\"'"; *s != '\0'; s ++)
+	classes[(unsigned char) *s] = OTHER;
 
-/* end tables serialization structures and prototypes */
+    for (auto &keyword : keywords) {
+	h = perfect(keyword.text, strlen(keyword.text));
 
-/* Default declaration of generated scanner - a define so the user can
- * easily add parameters.
- */
-#ifndef YY_DECL
-#define YY_DECL_IS_OURS 1
+	if (table[h] != nullptr)
+	    abort();
 
-extern int yylex (void);
+	table[h] = &keyword;
+    }
+}
 
-#define YY_DECL int yylex (void)
-#endif /* !YY_DECL */
 
-/* Code executed at the beginning of each rule, after yytext and yyleng
- * have been set up.
+/*
+ * Function:	countLines
+ *
+ * Description:	Count the newlines in the given span of the input.
  */
-#ifndef YY_USER_ACTION
-#define YY_USER_ACTION
-#endif
-
-/* Code executed at the end of each rule. */
-#ifndef YY_BREAK
-#define YY_BREAK break;
-#endif
-
-#define YY_RULE_SETUP \
-	YY_USER_ACTION
 
-/** The main scanner function which does all the work.
- */
-YY_DECL
+static void countLines(const char *p, const char *q)
 {
-	register yy_state_type yy_current_state;
-	register char *yy_cp, *yy_bp;
-	register int yy_act;
-    
-#line 29 "lexer.l"
-
-
-#line 802 "<stdout>"
-
-	if ( !(yy_init) )
-		{
-		(yy_init) = 1;
-
-#ifdef YY_USER_INIT
-		YY_USER_INIT;
-#endif
-
-		if ( ! (yy_start) )
-			(yy_start) = 1;	/* first start state */
-
-		if ( ! yyin )
-			yyin = stdin;
-
-		if ( ! yyout )
-			yyout = stdout;
-
-		if ( ! YY_CURRENT_BUFFER ) {
-			yyensure_buffer_stack ();
-			YY_CURRENT_BUFFER_LVALUE =
-				yy_create_buffer(yyin,YY_BUF_SIZE );
-		}
-
-		yy_load_buffer_state( );
-		}
-
-	while ( 1 )		/* loops until end-of-file is reached */
-		{
-		yy_cp = (yy_c_buf_p);
-
-		/* Support of yytext. */
-		*yy_cp = (yy_hold_char);
-
-		/* yy_bp points to the position in yy_ch_buf of the start of
-		 * the current run.
-		 */
-		yy_bp = yy_cp;
-
-		yy_current_state = (yy_start);
-yy_match:
-		do
-			{
-			register YY_CHAR yy_c = yy_ec[YY_SC_TO_UI(*yy_cp)];
-			if ( yy_accept[yy_current_state] )
-				{
-				(yy_last_accepting_state) = yy_current_state;
-				(yy_last_accepting_cpos) = yy_cp;
-				}
-			while ( yy_chk[yy_base[yy_current_state] + yy_c] != yy_current_state )
-				{
-				yy_current_state = (int) yy_def[yy_current_state];
-				if ( yy_current_state >= 190 )
-					yy_c = yy_meta[(unsigned int) yy_c];
-				}
-			yy_current_state = yy_nxt[yy_base[yy_current_state] + (unsigned int) yy_c];
-			++yy_cp;
-			}
-		while ( yy_base[yy_current_state] != 218 );
-
-yy_find_action:
-		yy_act = yy_accept[yy_current_state];
-		if ( yy_act == 0 )
-			{ /* have to back up */
-			yy_cp = (yy_last_accepting_cpos);
-			yy_current_state = (yy_last_accepting_state);
-			yy_act = yy_accept[yy_current_state];
-			}
-
-		YY_DO_BEFORE_ACTION;
-
-		if ( yy_act != YY_END_OF_BUFFER && yy_rule_can_match_eol[yy_act] )
-			{
-			yy_size_t yyl;
-			for ( yyl = 0; yyl < yyleng; ++yyl )
-				if ( yytext[yyl] == '\n' )
-					   
-    yylineno++;
-;
-			}
-
-do_action:	/* This label is used only to access EOF actions. */
-
-		switch ( yy_act )
-	{ /* beginning of action switch */
-			case 0: /* must back up */
-			/* undo the effects of YY_DO_BEFORE_ACTION */
-			*yy_cp = (yy_hold_char);
-			yy_cp = (yy_last_accepting_cpos);
-			yy_current_state = (yy_last_accepting_state);
-			goto yy_find_action;
-
-case 1:
-YY_RULE_SETUP
-#line 31 "lexer.l"
-{ignoreComment();}
-	YY_BREAK
-case 2:
-YY_RULE_SETUP
-#line 33 "lexer.l"
-{return AUTO;}
-	YY_BREAK
-case 3:
-YY_RULE_SETUP
-#line 34 "lexer.l"
-{return BREAK;}
-	YY_BREAK
-case 4:
-YY_RULE_SETUP
-#line 35 "lexer.l"
-{return CASE;}
-	YY_BREAK
-case 5:
-YY_RULE_SETUP
-#line 36 "lexer.l"
-{return CHAR;}
-	YY_BREAK
-case 6:
-YY_RULE_SETUP
-#line 37 "lexer.l"
-{return CONST;}
-	YY_BREAK
-case 7:
-YY_RULE_SETUP
-#line 38 "lexer.l"
-{return CONTINUE;}
-	YY_BREAK
-case 8:
-YY_RULE_SETUP
-#line 39 "lexer.l"
-{return DEFAULT;}
-	YY_BREAK
-case 9:
-YY_RULE_SETUP
-#line 40 "lexer.l"
-{return DO;}
-	YY_BREAK
-case 10:
-YY_RULE_SETUP
-#line 41 "lexer.l"
-{return DOUBLE;}
-	YY_BREAK
-case 11:
-YY_RULE_SETUP
-#line 42 "lexer.l"
-{return ELSE;}
-	YY_BREAK
-case 12:
-YY_RULE_SETUP
-#line 43 "lexer.l"
-{return ENUM;}
-	YY_BREAK
-case 13:
-YY_RULE_SETUP
-#line 44 "lexer.l"
-{return EXTERN;}
-	YY_BREAK
-case 14:
-YY_RULE_SETUP
-#line 45 "lexer.l"
-{return FLOAT;}
-	YY_BREAK
-case 15:
-YY_RULE_SETUP
-#line 46 "lexer.l"
-{return FOR;}
-	YY_BREAK
-case 16:
-YY_RULE_SETUP
-#line 47 "lexer.l"
-{return GOTO;}
-	YY_BREAK
-case 17:
-YY_RULE_SETUP
-#line 48 "lexer.l"
-{return IF;}
-	YY_BREAK
-case 18:
-YY_RULE_SETUP
-#line 49 "lexer.l"
-{return INT;}
-	YY_BREAK
-case 19:
-YY_RULE_SETUP
-#line 50 "lexer.l"
-{return LONG;}
-	YY_BREAK
-case 20:
-YY_RULE_SETUP
-#line 51 "lexer.l"
-{return REGISTER;}
-	YY_BREAK
-case 21:
-YY_RULE_SETUP
-#line 52 "lexer.l"
-{return RETURN;}
-	YY_BREAK
-case 22:
-YY_RULE_SETUP
-#line 53 "lexer.l"
-{return SHORT;}
-	YY_BREAK
-case 23:
-YY_RULE_SETUP
-#line 54 "lexer.l"
-{return SIGNED;}
-	YY_BREAK
-case 24:
-YY_RULE_SETUP
-#line 55 "lexer.l"
-{return SIZEOF;}
-	YY_BREAK
-case 25:
-YY_RULE_SETUP
-#line 56 "lexer.l"
-{return STATIC;}
-	YY_BREAK
-case 26:
-YY_RULE_SETUP
-#line 57 "lexer.l"
-{return STRUCT;}
-	YY_BREAK
-case 27:
-YY_RULE_SETUP
-#line 58 "lexer.l"
-{return SWITCH;}
-	YY_BREAK
-case 28:
-YY_RULE_SETUP
-#line 59 "lexer.l"
-{return TYPEDEF;}
-	YY_BREAK
-case 29:
-YY_RULE_SETUP
-#line 60 "lexer.l"
-{return UNION;}
-	YY_BREAK
-case 30:
-YY_RULE_SETUP
-#line 61 "lexer.l"
-{return UNSIGNED;}
-	YY_BREAK
-case 31:
-YY_RULE_SETUP
-#line 62 "lexer.l"
-{return VOID;}
-	YY_BREAK
-case 32:
-YY_RULE_SETUP
-#line 63 "lexer.l"
-{return VOLATILE;}
-	YY_BREAK
-case 33:
-YY_RULE_SETUP
-#line 64 "lexer.l"
-{return WHILE;}
-	YY_BREAK
-case 34:
-YY_RULE_SETUP
-#line 66 "lexer.l"
-{return OR;}
-	YY_BREAK
-case 35:
-YY_RULE_SETUP
-#line 67 "lexer.l"
-{return AND;}
-	YY_BREAK
-case 36:
-YY_RULE_SETUP
-#line 68 "lexer.l"
-{return EQL;}
-	YY_BREAK
-case 37:
-YY_RULE_SETUP
-#line 69 "lexer.l"
-{return NEQ;}
-	YY_BREAK
-case 38:
-YY_RULE_SETUP
-#line 70 "lexer.l"
-{return LEQ;}
-	YY_BREAK
-case 39:
-YY_RULE_SETUP
-#line 71 "lexer.l"
-{return GEQ;}
-	YY_BREAK
-case 40:
-YY_RULE_SETUP
-#line 72 "lexer.l"
-{return INC;}
-	YY_BREAK
-case 41:
-YY_RULE_SETUP
-#line 73 "lexer.l"
-{return DEC;}
-	YY_BREAK
-case 42:
-YY_RULE_SETUP
-#line 74 "lexer.l"
-{return ARROW;}
-	YY_BREAK
-case 43:
-YY_RULE_SETUP
-#line 75 "lexer.l"
-{return ELLIPSIS;}
-	YY_BREAK
-case 44:
-YY_RULE_SETUP
-#line 76 "lexer.l"
-{return *yytext;}
-	YY_BREAK
-case 45:
-YY_RULE_SETUP
-#line 78 "lexer.l"
-{return ID;}
-	YY_BREAK
-case 46:
-YY_RULE_SETUP
-#line 80 "lexer.l"
-{checkInt(); return INTEGER;}
-	YY_BREAK
-case 47:
-YY_RULE_SETUP
-#line 81 "lexer.l"
-{checkReal(); return REAL;}
-	YY_BREAK
-case 48:
-YY_RULE_SETUP
-#line 82 "lexer.l"
-{checkString(); return STRING;}
-	YY_BREAK
-case 49:
-YY_RULE_SETUP
-#line 83 "lexer.l"
-{checkChar(); return CHARACTER;}
-	YY_BREAK
-case 50:
-/* rule 50 can match eol */
-YY_RULE_SETUP
-#line 85 "lexer.l"
-{/* ignored */}
-	YY_BREAK
-case 51:
-YY_RULE_SETUP
-#line 86 "lexer.l"
-{/* ignored */}
-	YY_BREAK
-case 52:
-YY_RULE_SETUP
-#line 88 "lexer.l"
-ECHO;
-	YY_BREAK
-#line 1156 "<stdout>"
-case YY_STATE_EOF(INITIAL):
-	yyterminate();
-
-	case YY_END_OF_BUFFER:
-		{
-		/* Amount of text matched not including the EOB char. */
-		int yy_amount_of_matched_text = (int) (yy_cp - (yytext_ptr)) - 1;
-
-		/* Undo the effects of YY_DO_BEFORE_ACTION. */
-		*yy_cp = (yy_hold_char);
-		YY_RESTORE_YY_MORE_OFFSET
-
-		if ( YY_CURRENT_BUFFER_LVALUE->yy_buffer_status == YY_BUFFER_NEW )
-			{
-			/* We're scanning a new file or input source.  It's
-			 * possible that this happened because the user
-			 * just pointed yyin at a new source and called
-			 * yylex().  If so, then we have to assure
-			 * consistency between YY_CURRENT_BUFFER and our
-			 * globals.  Here is the right place to do so, because
-			 * this is the first action (other than possibly a
-			 * back-up) that will match for the new input source.
-			 */
-			(yy_n_chars) = YY_CURRENT_BUFFER_LVALUE->yy_n_chars;
-			YY_CURRENT_BUFFER_LVALUE->yy_input_file = yyin;
-			YY_CURRENT_BUFFER_LVALUE->yy_buffer_status = YY_BUFFER_NORMAL;
-			}
-
-		/* Note that here we test for yy_c_buf_p "<=" to the position
-		 * of the first EOB in the buffer, since yy_c_buf_p will
-		 * already have been incremented past the NUL character
-		 * (since all states make transitions on EOB to the
-		 * end-of-buffer state).  Contrast this with the test
-		 * in input().
-		 */
-		if ( (yy_c_buf_p) <= &YY_CURRENT_BUFFER_LVALUE->yy_ch_buf[(yy_n_chars)] )
-			{ /* This was really a NUL. */
-			yy_state_type yy_next_state;
-
-			(yy_c_buf_p) = (yytext_ptr) + yy_amount_of_matched_text;
-
-			yy_current_state = yy_get_previous_state(  );
-
-			/* Okay, we're now positioned to make the NUL
-			 * transition.  We couldn't have
-			 * yy_get_previous_state() go ahead and do it
-			 * for us because it doesn't know how to deal
-			 * with the possibility of jamming (and we don't
-			 * want to build jamming into it because then it
-			 * will run more slowly).
-			 */
-
-			yy_next_state = yy_try_NUL_trans( yy_current_state );
-
-			yy_bp = (yytext_ptr) + YY_MORE_ADJ;
-
-			if ( yy_next_state )
-				{
-				/* Consume the NUL. */
-				yy_cp = ++(yy_c_buf_p);
-				yy_current_state = yy_next_state;
-				goto yy_match;
-				}
-
-			else
-				{
-				yy_cp = (yy_c_buf_p);
-				goto yy_find_action;
-				}
-			}
-
-		else switch ( yy_get_next_buffer(  ) )
-			{
-			case EOB_ACT_END_OF_FILE:
-				{
-				(yy_did_buffer_switch_on_eof) = 0;
-
-				if ( yywrap( ) )
-					{
-					/* Note: because we've taken care in
-					 * yy_get_next_buffer() to have set up
-					 * yytext, we can now set up
-					 * yy_c_buf_p so that if some total
-					 * hoser (like flex itself) wants to
-					 * call the scanner after we return the
-					 * YY_NULL, it'll still work - another
-					 * YY_NULL will get returned.
-					 */
-					(yy_c_buf_p) = (yytext_ptr) + YY_MORE_ADJ;
-
-					yy_act = YY_STATE_EOF(YY_START);
-					goto do_action;
-					}
-
-				else
-					{
-					if ( ! (yy_did_buffer_switch_on_eof) )
-						YY_NEW_FILE;
-					}
-				break;
-				}
-
-			case EOB_ACT_CONTINUE_SCAN:
-				(yy_c_buf_p) =
-					(yytext_ptr) + yy_amount_of_matched_text;
-
-				yy_current_state = yy_get_previous_state(  );
-
-				yy_cp = (yy_c_buf_p);
-				yy_bp = (yytext_ptr) + YY_MORE_ADJ;
-				goto yy_match;
-
-			case EOB_ACT_LAST_MATCH:
-				(yy_c_buf_p) =
-				&YY_CURRENT_BUFFER_LVALUE->yy_ch_buf[(yy_n_chars)];
-
-				yy_current_state = yy_get_previous_state(  );
-
-				yy_cp = (yy_c_buf_p);
-				yy_bp = (yytext_ptr) + YY_MORE_ADJ;
-				goto yy_find_action;
-			}
-		break;
-		}
+    while ((p = static_cast<const char *>(memchr(p, '\n', q - p))) != nullptr) {
+	yylineno ++;
+	p ++;
+    }
+}
 
-	default:
-		YY_FATAL_ERROR(
-			"fatal flex scanner internal error--no action found" );
-	} /* end of action switch */
-		} /* end of scanning one token */
-} /* end of yylex */
 
-/* yy_get_next_buffer - try to read in a new buffer
+/*
+ * Function:	ignoreComment
  *
- * Returns a code representing an action:
- *	EOB_ACT_LAST_MATCH -
- *	EOB_ACT_CONTINUE_SCAN - continue scanning from current position
- *	EOB_ACT_END_OF_FILE - end of file
+ * Description:	Ignore a comment after recognizing its beginning, and
+ *		return the position just after it.
  */
-static int yy_get_next_buffer (void)
-{
-    	register char *dest = YY_CURRENT_BUFFER_LVALUE->yy_ch_buf;
-	register char *source = (yytext_ptr);
-	register int number_to_move, i;
-	int ret_val;
-
-	if ( (yy_c_buf_p) > &YY_CURRENT_BUFFER_LVALUE->yy_ch_buf[(yy_n_chars) + 1] )
-		YY_FATAL_ERROR(
-		"fatal flex scanner internal error--end of buffer missed" );
-
-	if ( YY_CURRENT_BUFFER_LVALUE->yy_fill_buffer == 0 )
-		{ /* Don't try to fill the buffer, so this is an EOF. */
-		if ( (yy_c_buf_p) - (yytext_ptr) - YY_MORE_ADJ == 1 )
-			{
-			/* We matched a single character, the EOB, so
-			 * treat this as a final EOF.
-			 */
-			return EOB_ACT_END_OF_FILE;
-			}
-
-		else
-			{
-			/* We matched some text prior to the EOB, first
-			 * process it.
-			 */
-			return EOB_ACT_LAST_MATCH;
-			}
-		}
-
-	/* Try to read more data. */
-
-	/* First move last chars to start of buffer. */
-	number_to_move = (int) ((yy_c_buf_p) - (yytext_ptr)) - 1;
-
-	for ( i = 0; i < number_to_move; ++i )
-		*(dest++) = *(source++);
-
-	if ( YY_CURRENT_BUFFER_LVALUE->yy_buffer_status == YY_BUFFER_EOF_PENDING )
-		/* don't do the read, it's not guaranteed to return an EOF,
-		 * just force an EOF
-		 */
-		YY_CURRENT_BUFFER_LVALUE->yy_n_chars = (yy_n_chars) = 0;
-
-	else
-		{
-			yy_size_t num_to_read =
-			YY_CURRENT_BUFFER_LVALUE->yy_buf_size - number_to_move - 1;
-
-		while ( num_to_read <= 0 )
-			{ /* Not enough room in the buffer - grow it. */
-
-			/* just a shorter name for the current buffer */
-			YY_BUFFER_STATE b = YY_CURRENT_BUFFER_LVALUE;
-
-			int yy_c_buf_p_offset =
-				(int) ((yy_c_buf_p) - b->yy_ch_buf);
-
-			if ( b->yy_is_our_buffer )
-				{
-				yy_size_t new_size = b->yy_buf_size * 2;
-
-				if ( new_size <= 0 )
-					b->yy_buf_size += b->yy_buf_size / 8;
-				else
-					b->yy_buf_size *= 2;
-
-				b->yy_ch_buf = (char *)
-					/* Include room in for 2 EOB chars. */
-					yyrealloc((void *) b->yy_ch_buf,b->yy_buf_size + 2  );
-				}
-			else
-				/* Can't grow it, we don't own it. */
-				b->yy_ch_buf = 0;
-
-			if ( ! b->yy_ch_buf )
-				YY_FATAL_ERROR(
-				"fatal error - scanner input buffer overflow" );
 
-			(yy_c_buf_p) = &b->yy_ch_buf[yy_c_buf_p_offset];
-
-			num_to_read = YY_CURRENT_BUFFER_LVALUE->yy_buf_size -
-						number_to_move - 1;
-
-			}
-
-		if ( num_to_read > YY_READ_BUF_SIZE )
-			num_to_read = YY_READ_BUF_SIZE;
-
-		/* Read in more data. */
-		YY_INPUT( (&YY_CURRENT_BUFFER_LVALUE->yy_ch_buf[number_to_move]),
-			(yy_n_chars), num_to_read );
-
-		YY_CURRENT_BUFFER_LVALUE->yy_n_chars = (yy_n_chars);
-		}
-
-	if ( (yy_n_chars) == 0 )
-		{
-		if ( number_to_move == YY_MORE_ADJ )
-			{
-			ret_val = EOB_ACT_END_OF_FILE;
-			yyrestart(yyin  );
-			}
-
-		else
-			{
-			ret_val = EOB_ACT_LAST_MATCH;
-			YY_CURRENT_BUFFER_LVALUE->yy_buffer_status =
-				YY_BUFFER_EOF_PENDING;
-			}
-		}
+static const char *ignoreComment(const char *p)
+{
+    const char *start = p, *q;
 
-	else
-		ret_val = EOB_ACT_CONTINUE_SCAN;
 
-	if ((yy_size_t) ((yy_n_chars) + number_to_move) > YY_CURRENT_BUFFER_LVALUE->yy_buf_size) {
-		/* Extend the array by 50%, plus the number we really need. */
-		yy_size_t new_size = (yy_n_chars) + number_to_move + ((yy_n_chars) >> 1);
-		YY_CURRENT_BUFFER_LVALUE->yy_ch_buf = (char *) yyrealloc((void *) YY_CURRENT_BUFFER_LVALUE->yy_ch_buf,new_size  );
-		if ( ! YY_CURRENT_BUFFER_LVALUE->yy_ch_buf )
-			YY_FATAL_ERROR( "out of dynamic memory in yy_get_next_buffer()" );
+    while ((q = static_cast<const char *>(memchr(p, '*', limit - p))) != nullptr) {
+	if (q + 1 < limit && q[1] == '/') {
+	    countLines(start, q);
+	    return q + 2;
 	}
 
-	(yy_n_chars) += number_to_move;
-	YY_CURRENT_BUFFER_LVALUE->yy_ch_buf[(yy_n_chars)] = YY_END_OF_BUFFER_CHAR;
-	YY_CURRENT_BUFFER_LVALUE->yy_ch_buf[(yy_n_chars) + 1] = YY_END_OF_BUFFER_CHAR;
-
-	(yytext_ptr) = &YY_CURRENT_BUFFER_LVALUE->yy_ch_buf[0];
+	p = q + 1;
+    }
 
-	return ret_val;
+    countLines(start, limit);
+    report("unterminated comment");
+    return limit;
 }
 
-/* yy_get_previous_state - get the state just before the EOB char was reached */
 
-    static yy_state_type yy_get_previous_state (void)
-{
-	register yy_state_type yy_current_state;
-	register char *yy_cp;
-    
-	yy_current_state = (yy_start);
-
-	for ( yy_cp = (yytext_ptr) + YY_MORE_ADJ; yy_cp < (yy_c_buf_p); ++yy_cp )
-		{
-		register YY_CHAR yy_c = (*yy_cp ? yy_ec[YY_SC_TO_UI(*yy_cp)] : 1);
-		if ( yy_accept[yy_current_state] )
-			{
-			(yy_last_accepting_state) = yy_current_state;
-			(yy_last_accepting_cpos) = yy_cp;
-			}
-		while ( yy_chk[yy_base[yy_current_state] + yy_c] != yy_current_state )
-			{
-			yy_current_state = (int) yy_def[yy_current_state];
-			if ( yy_current_state >= 190 )
-				yy_c = yy_meta[(unsigned int) yy_c];
-			}
-		yy_current_state = yy_nxt[yy_base[yy_current_state] + (unsigned int) yy_c];
-		}
-
-	return yy_current_state;
-}
-
-/* yy_try_NUL_trans - try to make a transition on the NUL character
+/*
+ * Function:	scanQuoted
  *
- * synopsis
- *	next_state = yy_try_NUL_trans( current_state );
+ * Description:	Scan a string or character literal beginning with the given
+ *		quote character, and return the position just after it.  A
+ *		null pointer is returned if the literal is not terminated
+ *		on the same line, or is an empty character literal.
  */
-    static yy_state_type yy_try_NUL_trans  (yy_state_type yy_current_state )
-{
-	register int yy_is_jam;
-    	register char *yy_cp = (yy_c_buf_p);
-
-	register YY_CHAR yy_c = 1;
-	if ( yy_accept[yy_current_state] )
-		{
-		(yy_last_accepting_state) = yy_current_state;
-		(yy_last_accepting_cpos) = yy_cp;
-		}
-	while ( yy_chk[yy_base[yy_current_state] + yy_c] != yy_current_state )
-		{
-		yy_current_state = (int) yy_def[yy_current_state];
-		if ( yy_current_state >= 190 )
-			yy_c = yy_meta[(unsigned int) yy_c];
-		}
-	yy_current_state = yy_nxt[yy_base[yy_current_state] + (unsigned int) yy_c];
-	yy_is_jam = (yy_current_state == 189);
-
-		return yy_is_jam ? 0 : yy_current_state;
-}
-
-#ifndef YY_NO_INPUT
-#ifdef __cplusplus
-    static int yyinput (void)
-#else
-    static int input  (void)
-#endif
 
+static const char *scanQuoted(const char *p, char quote)
 {
-	int c;
-    
-	*(yy_c_buf_p) = (yy_hold_char);
-
-	if ( *(yy_c_buf_p) == YY_END_OF_BUFFER_CHAR )
-		{
-		/* yy_c_buf_p now points to the character we want to return.
-		 * If this occurs *before* the EOB characters, then it's a
-		 * valid NUL; if not, then we've hit the end of the buffer.
-		 */
-		if ( (yy_c_buf_p) < &YY_CURRENT_BUFFER_LVALUE->yy_ch_buf[(yy_n_chars)] )
-			/* This was really a NUL. */
-			*(yy_c_buf_p) = '\0';
-
-		else
-			{ /* need more input */
-			yy_size_t offset = (yy_c_buf_p) - (yytext_ptr);
-			++(yy_c_buf_p);
-
-			switch ( yy_get_next_buffer(  ) )
-				{
-				case EOB_ACT_LAST_MATCH:
-					/* This happens because yy_g_n_b()
-					 * sees that we've accumulated a
-					 * token and flags that we need to
-					 * try matching the token before
-					 * proceeding.  But for input(),
-					 * there's no matching to consider.
-					 * So convert the EOB_ACT_LAST_MATCH
-					 * to EOB_ACT_END_OF_FILE.
-					 */
-
-					/* Reset buffer status. */
-					yyrestart(yyin );
-
-					/*FALLTHROUGH*/
-
-				case EOB_ACT_END_OF_FILE:
-					{
-					if ( yywrap( ) )
-						return EOF;
-
-					if ( ! (yy_did_buffer_switch_on_eof) )
-						YY_NEW_FILE;
-#ifdef __cplusplus
-					return yyinput();
-#else
-					return input();
-#endif
-					}
-
-				case EOB_ACT_CONTINUE_SCAN:
-					(yy_c_buf_p) = (yytext_ptr) + offset;
-					break;
-				}
-			}
-		}
+    const char *start = p;
 
-	c = *(unsigned char *) (yy_c_buf_p);	/* cast for 8-bit char's */
-	*(yy_c_buf_p) = '\0';	/* preserve yytext */
-	(yy_hold_char) = *++(yy_c_buf_p);
 
-	if ( c == '\n' )
-		   
-    yylineno++;
-;
+    while (p < limit && *p != quote) {
+	if (*p == '\n')
+	    return nullptr;
 
-	return c;
-}
-#endif	/* ifndef YY_NO_INPUT */
+	if (*p == '\\') {
+	    if (p + 1 == limit || p[1] == '\n')
+		return nullptr;
 
-/** Immediately switch to a different input stream.
- * @param input_file A readable stream.
- * 
- * @note This function does not reset the start condition to @c INITIAL .
- */
-    void yyrestart  (FILE * input_file )
-{
-    
-	if ( ! YY_CURRENT_BUFFER ){
-        yyensure_buffer_stack ();
-		YY_CURRENT_BUFFER_LVALUE =
-            yy_create_buffer(yyin,YY_BUF_SIZE );
+	    p ++;
 	}
 
-	yy_init_buffer(YY_CURRENT_BUFFER,input_file );
-	yy_load_buffer_state( );
-}
-
-/** Switch to a different input buffer.
- * @param new_buffer The new input buffer.
- * 
- */
-    void yy_switch_to_buffer  (YY_BUFFER_STATE  new_buffer )
-{
-    
-	/* TODO. We should be able to replace this entire function body
-	 * with
-	 *		yypop_buffer_state();
-	 *		yypush_buffer_state(new_buffer);
-     */
-	yyensure_buffer_stack ();
-	if ( YY_CURRENT_BUFFER == new_buffer )
-		return;
-
-	if ( YY_CURRENT_BUFFER )
-		{
-		/* Flush out information for old buffer. */
-		*(yy_c_buf_p) = (yy_hold_char);
-		YY_CURRENT_BUFFER_LVALUE->yy_buf_pos = (yy_c_buf_p);
-		YY_CURRENT_BUFFER_LVALUE->yy_n_chars = (yy_n_chars);
-		}
+	p ++;
+    }
 
-	YY_CURRENT_BUFFER_LVALUE = new_buffer;
-	yy_load_buffer_state( );
+    if (p == limit || (quote == '\'' && p == start))
+	return nullptr;
 
-	/* We don't actually know whether we did this switch during
-	 * EOF (yywrap()) processing, but the only time this flag
-	 * is looked at is after yywrap() is called, so it's safe
-	 * to go ahead and always set it.
-	 */
-	(yy_did_buffer_switch_on_eof) = 1;
+    return p + 1;
 }
 
-static void yy_load_buffer_state  (void)
-{
-    	(yy_n_chars) = YY_CURRENT_BUFFER_LVALUE->yy_n_chars;
-	(yytext_ptr) = (yy_c_buf_p) = YY_CURRENT_BUFFER_LVALUE->yy_buf_pos;
-	yyin = YY_CURRENT_BUFFER_LVALUE->yy_input_file;
-	(yy_hold_char) = *(yy_c_buf_p);
-}
 
-/** Allocate and initialize an input buffer state.
- * @param file A readable stream.
- * @param size The character buffer size in bytes. When in doubt, use @c YY_BUF_SIZE.
- * 
- * @return the allocated buffer state.
+/*
+ * Function:	checkInt
+ *
+ * Description:	Check if an integer constant is valid.
  */
-    YY_BUFFER_STATE yy_create_buffer  (FILE * file, int  size )
-{
-	YY_BUFFER_STATE b;
-    
-	b = (YY_BUFFER_STATE) yyalloc(sizeof( struct yy_buffer_state )  );
-	if ( ! b )
-		YY_FATAL_ERROR( "out of dynamic memory in yy_create_buffer()" );
-
-	b->yy_buf_size = size;
-
-	/* yy_ch_buf has to be 2 characters longer than the size given because
-	 * we need to put in 2 end-of-buffer characters.
-	 */
-	b->yy_ch_buf = (char *) yyalloc(b->yy_buf_size + 2  );
-	if ( ! b->yy_ch_buf )
-		YY_FATAL_ERROR( "out of dynamic memory in yy_create_buffer()" );
-
-	b->yy_is_our_buffer = 1;
-
-	yy_init_buffer(b,file );
 
-	return b;
-}
-
-/** Destroy the buffer.
- * @param b a buffer created with yy_create_buffer()
- * 
- */
-    void yy_delete_buffer (YY_BUFFER_STATE  b )
+static void checkInt()
 {
-    
-	if ( ! b )
-		return;
+    string text(yytext, yyleng);
+    long val;
 
-	if ( b == YY_CURRENT_BUFFER ) /* Not sure if we should pop here. */
-		YY_CURRENT_BUFFER_LVALUE = (YY_BUFFER_STATE) 0;
 
-	if ( b->yy_is_our_buffer )
-		yyfree((void *) b->yy_ch_buf  );
+    errno = 0;
+    val = strtol(text.c_str(), NULL, 0);
 
-	yyfree((void *) b  );
+    if (errno != 0 || val != (int) val)
+	report("integer constant too large");
 }
 
-/* Initializes or reinitializes a buffer.
- * This function is sometimes called more than once on the same buffer,
- * such as during a yyrestart() or at EOF.
- */
-    static void yy_init_buffer  (YY_BUFFER_STATE  b, FILE * file )
 
-{
-	int oerrno = errno;
-    
-	yy_flush_buffer(b );
-
-	b->yy_input_file = file;
-	b->yy_fill_buffer = 1;
-
-    /* If b is the current buffer, then yy_init_buffer was _probably_
-     * called from yyrestart() or through yy_get_next_buffer.
-     * In that case, we don't want to reset the lineno or column.
-     */
-    if (b != YY_CURRENT_BUFFER){
-        b->yy_bs_lineno = 1;
-        b->yy_bs_column = 0;
-    }
-
-        b->yy_is_interactive = file ? (isatty( fileno(file) ) > 0) : 0;
-    
-	errno = oerrno;
-}
-
-/** Discard all buffered characters. On the next scan, YY_INPUT will be called.
- * @param b the buffer state to be flushed, usually @c YY_CURRENT_BUFFER.
- * 
+/*
+ * Function:	checkReal
+ *
+ * Description:	Check if a floating-point constant is valid.
  */
-    void yy_flush_buffer (YY_BUFFER_STATE  b )
-{
-    	if ( ! b )
-		return;
 
-	b->yy_n_chars = 0;
-
-	/* We always need two end-of-buffer characters.  The first causes
-	 * a transition to the end-of-buffer state.  The second causes
-	 * a jam in that state.
-	 */
-	b->yy_ch_buf[0] = YY_END_OF_BUFFER_CHAR;
-	b->yy_ch_buf[1] = YY_END_OF_BUFFER_CHAR;
+static void checkReal()
+{
+    string text(yytext, yyleng);
 
-	b->yy_buf_pos = &b->yy_ch_buf[0];
 
-	b->yy_at_bol = 1;
-	b->yy_buffer_status = YY_BUFFER_NEW;
+    errno = 0;
+    strtod(text.c_str(), NULL);
 
-	if ( b == YY_CURRENT_BUFFER )
-		yy_load_buffer_state( );
+    if (errno != 0)
+	report("floating-point constant out of range");
 }
 
-/** Pushes the new state onto the stack. The new state becomes
- *  the current state. This function will allocate the stack
- *  if necessary.
- *  @param new_buffer The new state.
- *  
- */
-void yypush_buffer_state (YY_BUFFER_STATE new_buffer )
-{
-    	if (new_buffer == NULL)
-		return;
-
-	yyensure_buffer_stack();
-
-	/* This block is copied from yy_switch_to_buffer. */
-	if ( YY_CURRENT_BUFFER )
-		{
-		/* Flush out information for old buffer. */
-		*(yy_c_buf_p) = (yy_hold_char);
-		YY_CURRENT_BUFFER_LVALUE->yy_buf_pos = (yy_c_buf_p);
-		YY_CURRENT_BUFFER_LVALUE->yy_n_chars = (yy_n_chars);
-		}
-
-	/* Only push if top exists. Otherwise, replace top. */
-	if (YY_CURRENT_BUFFER)
-		(yy_buffer_stack_top)++;
-	YY_CURRENT_BUFFER_LVALUE = new_buffer;
 
-	/* copied from yy_switch_to_buffer. */
-	yy_load_buffer_state( );
-	(yy_did_buffer_switch_on_eof) = 1;
-}
-
-/** Removes and deletes the top of the stack, if present.
- *  The next element becomes the new top.
- *  
+/*
+ * Function:	checkString
+ *
+ * Description:	Check if a string literal is valid.
  */
-void yypop_buffer_state (void)
-{
-    	if (!YY_CURRENT_BUFFER)
-		return;
-
-	yy_delete_buffer(YY_CURRENT_BUFFER );
-	YY_CURRENT_BUFFER_LVALUE = NULL;
-	if ((yy_buffer_stack_top) > 0)
-		--(yy_buffer_stack_top);
 
-	if (YY_CURRENT_BUFFER) {
-		yy_load_buffer_state( );
-		(yy_did_buffer_switch_on_eof) = 1;
-	}
-}
-
-/* Allocates the stack if it does not exist.
- *  Guarantees space for at least one push.
- */
-static void yyensure_buffer_stack (void)
+static void checkString()
 {
-	yy_size_t num_to_alloc;
-    
-	if (!(yy_buffer_stack)) {
-
-		/* First allocation is just for 2 elements, since we don't know if this
-		 * scanner will even need a stack. We use 2 instead of 1 to avoid an
-		 * immediate realloc on the next call.
-         */
-		num_to_alloc = 1;
-		(yy_buffer_stack) = (struct yy_buffer_state**)yyalloc
-								(num_to_alloc * sizeof(struct yy_buffer_state*)
-								);
-		if ( ! (yy_buffer_stack) )
-			YY_FATAL_ERROR( "out of dynamic memory in yyensure_buffer_stack()" );
-								  
-		memset((yy_buffer_stack), 0, num_to_alloc * sizeof(struct yy_buffer_state*));
-				
-		(yy_buffer_stack_max) = num_to_alloc;
-		(yy_buffer_stack_top) = 0;
-		return;
-	}
-
-	if ((yy_buffer_stack_top) >= ((yy_buffer_stack_max)) - 1){
+    bool invalid, overflow;
+    string s(yytext + 1, yyleng - 2);
 
-		/* Increase the buffer to prepare for a possible push. */
-		int grow_size = 8 /* arbitrary grow size */;
 
-		num_to_alloc = (yy_buffer_stack_max) + grow_size;
-		(yy_buffer_stack) = (struct yy_buffer_state**)yyrealloc
-								((yy_buffer_stack),
-								num_to_alloc * sizeof(struct yy_buffer_state*)
-								);
-		if ( ! (yy_buffer_stack) )
-			YY_FATAL_ERROR( "out of dynamic memory in yyensure_buffer_stack()" );
+    s = parseString(s, invalid, overflow);
 
-		/* zero only the new slots.*/
-		memset((yy_buffer_stack) + (yy_buffer_stack_max), 0, grow_size * sizeof(struct yy_buffer_state*));
-		(yy_buffer_stack_max) = num_to_alloc;
-	}
+    if (invalid)
+	report("unknown escape sequence in string constant");
+    else if (overflow)
+	report("escape sequence out of range in string constant");
 }
 
-/** Setup the input buffer state to scan directly from a user-specified character buffer.
- * @param base the character buffer
- * @param size the size in bytes of the character buffer
- * 
- * @return the newly allocated buffer state object. 
- */
-YY_BUFFER_STATE yy_scan_buffer  (char * base, yy_size_t  size )
-{
-	YY_BUFFER_STATE b;
-    
-	if ( size < 2 ||
-	     base[size-2] != YY_END_OF_BUFFER_CHAR ||
-	     base[size-1] != YY_END_OF_BUFFER_CHAR )
-		/* They forgot to leave room for the EOB's. */
-		return 0;
-
-	b = (YY_BUFFER_STATE) yyalloc(sizeof( struct yy_buffer_state )  );
-	if ( ! b )
-		YY_FATAL_ERROR( "out of dynamic memory in yy_scan_buffer()" );
-
-	b->yy_buf_size = size - 2;	/* "- 2" to take care of EOB's */
-	b->yy_buf_pos = b->yy_ch_buf = base;
-	b->yy_is_our_buffer = 0;
-	b->yy_input_file = 0;
-	b->yy_n_chars = b->yy_buf_size;
-	b->yy_is_interactive = 0;
-	b->yy_at_bol = 1;
-	b->yy_fill_buffer = 0;
-	b->yy_buffer_status = YY_BUFFER_NEW;
-
-	yy_switch_to_buffer(b  );
-
-	return b;
-}
 
-/** Setup the input buffer state to scan a string. The next call to yylex() will
- * scan from a @e copy of @a str.
- * @param yystr a NUL-terminated string to scan
- * 
- * @return the newly allocated buffer state object.
- * @note If you want to scan bytes that may contain NUL values, then use
- *       yy_scan_bytes() instead.
+/*
+ * Function:	checkChar
+ *
+ * Description:	Check if a character literal is valid.
  */
-YY_BUFFER_STATE yy_scan_string (yyconst char * yystr )
-{
-    
-	return yy_scan_bytes(yystr,strlen(yystr) );
-}
 
-/** Setup the input buffer state to scan the given bytes. The next call to yylex() will
- * scan from a @e copy of @a bytes.
- * @param yybytes the byte buffer to scan
- * @param _yybytes_len the number of bytes in the buffer pointed to by @a bytes.
- * 
- * @return the newly allocated buffer state object.
- */
-YY_BUFFER_STATE yy_scan_bytes  (yyconst char * yybytes, yy_size_t  _yybytes_len )
+static void checkChar()
 {
-	YY_BUFFER_STATE b;
-	char *buf;
-	yy_size_t n;
-	yy_size_t i;
-    
-	/* Get memory for full buffer, including space for trailing EOB's. */
-	n = _yybytes_len + 2;
-	buf = (char *) yyalloc(n  );
-	if ( ! buf )
-		YY_FATAL_ERROR( "out of dynamic memory in yy_scan_bytes()" );
-
-	for ( i = 0; i < _yybytes_len; ++i )
-		buf[i] = yybytes[i];
-
-	buf[_yybytes_len] = buf[_yybytes_len+1] = YY_END_OF_BUFFER_CHAR;
-
-	b = yy_scan_buffer(buf,n );
-	if ( ! b )
-		YY_FATAL_ERROR( "bad buffer in yy_scan_bytes()" );
-
-	/* It's okay to grow etc. this buffer, and we should throw it
-	 * away when we're done.
-	 */
-	b->yy_is_our_buffer = 1;
-
-	return b;
-}
+    bool invalid, overflow;
+    string s(yytext + 1, yyleng - 2);
 
-#ifndef YY_EXIT_FAILURE
-#define YY_EXIT_FAILURE 2
-#endif
 
-static void yy_fatal_error (yyconst char* msg )
-{
-    	(void) fprintf( stderr, "%s\n", msg );
-	exit( YY_EXIT_FAILURE );
-}
+    s = parseString(s, invalid, overflow);
 
-/* Redefine yyless() so it works in section 3 code. */
-
-#undef yyless
-#define yyless(n) \
-	do \
-		{ \
-		/* Undo effects of setting up yytext. */ \
-        int yyless_macro_arg = (n); \
-        YY_LESS_LINENO(yyless_macro_arg);\
-		yytext[yyleng] = (yy_hold_char); \
-		(yy_c_buf_p) = yytext + yyless_macro_arg; \
-		(yy_hold_char) = *(yy_c_buf_p); \
-		*(yy_c_buf_p) = '\0'; \
-		yyleng = yyless_macro_arg; \
-		} \
-	while ( 0 )
-
-/* Accessor  methods (get/set functions) to struct members. */
-
-/** Get the current line number.
- * 
- */
-int yyget_lineno  (void)
-{
-        
-    return yylineno;
+    if (invalid)
+	report("unknown escape sequence in character constant");
+    else if (overflow)
+	report("escape sequence out of range in character constant");
+    else if (s.size() > 1)
+	report("multi-character character constant");
 }
 
-/** Get the input stream.
- * 
- */
-FILE *yyget_in  (void)
-{
-        return yyin;
-}
 
-/** Get the output stream.
- * 
+/*
+ * Function:	token (private)
+ *
+ * Description:	Record the text of a token and return it.
  */
-FILE *yyget_out  (void)
-{
-        return yyout;
-}
 
-/** Get the length of the current token.
- * 
- */
-yy_size_t yyget_leng  (void)
+static int token(int kind, const char *start, const char *end)
 {
-        return yyleng;
+    yytext = start;
+    yyleng = end - start;
+    cursor = end;
+    return kind;
 }
 
-/** Get the current token.
- * 
- */
 
-char *yyget_text  (void)
-{
-        return yytext;
-}
-
-/** Set the current line number.
- * @param line_number
- * 
+/*
+ * Function:	yylex
+ *
+ * Description:	Return the next token from the input.  Whitespace and any
+ *		characters that cannot begin a token are ignored.  At the
+ *		end of the input, DONE is returned with an empty text.
  */
-void yyset_lineno (int  line_number )
-{
-    
-    yylineno = line_number;
-}
 
-/** Set the input stream. This does not discard the current
- * input buffer.
- * @param in_str A readable stream.
- * 
- * @see yy_switch_to_buffer
- */
-void yyset_in (FILE *  in_str )
+int yylex()
 {
-        yyin = in_str ;
-}
+    const char *p, *q, *start;
+    const Keyword *keyword;
+    size_t length;
+    int kind;
 
-void yyset_out (FILE *  out_str )
-{
-        yyout = out_str ;
-}
 
-int yyget_debug  (void)
-{
-        return yy_flex_debug;
-}
+    if (limit == nullptr)
+	initialize();
 
-void yyset_debug (int  bdebug )
-{
-        yy_flex_debug = bdebug ;
-}
+    p = cursor;
 
-static int yy_init_globals (void)
-{
-        /* Initialization is the same as for the non-reentrant scanner.
-     * This function is called from yylex_destroy(), so don't allocate here.
-     */
-
-    /* We do not touch yylineno unless the option is enabled. */
-    yylineno =  1;
-    
-    (yy_buffer_stack) = 0;
-    (yy_buffer_stack_top) = 0;
-    (yy_buffer_stack_max) = 0;
-    (yy_c_buf_p) = (char *) 0;
-    (yy_init) = 0;
-    (yy_start) = 0;
-
-/* Defined in main.c */
-#ifdef YY_STDINIT
-    yyin = stdin;
-    yyout = stdout;
-#else
-    yyin = (FILE *) 0;
-    yyout = (FILE *) 0;
-#endif
-
-    /* For future reference: Set errno on error, since we are called by
-     * yylex_init()
-     */
-    return 0;
-}
+    while (true) {
+	while (p < limit && classes[(unsigned char) *p] == SKIP)
+	    if (*p ++ == '\n')
+		yylineno ++;
 
-/* yylex_destroy is for both reentrant and non-reentrant scanners. */
-int yylex_destroy  (void)
-{
-    
-    /* Pop the buffer stack, destroying each element. */
-	while(YY_CURRENT_BUFFER){
-		yy_delete_buffer(YY_CURRENT_BUFFER  );
-		YY_CURRENT_BUFFER_LVALUE = NULL;
-		yypop_buffer_state();
-	}
+	if (p == limit)
+	    return token(DONE, p, p);
 
-	/* Destroy the stack itself. */
-	yyfree((yy_buffer_stack) );
-	(yy_buffer_stack) = NULL;
+	start = p;
 
-    /* Reset the globals. This is important in a non-reentrant scanner so the next time
-     * yylex() is called, initialization will occur. */
-    yy_init_globals( );
+	switch (classes[(unsigned char) *p]) {
+	case LETTER:
+	    while (++ p < limit && (classes[(unsigned char) *p] & (LETTER | DIGIT)))
+		continue;
 
-    return 0;
-}
+	    length = p - start;
 
-/*
- * Internal utility routines.
- */
+	    if (length > 1) {
+		keyword = table[perfect(start, length)];
 
-#ifndef yytext_ptr
-static void yy_flex_strncpy (char* s1, yyconst char * s2, int n )
-{
-	register int i;
-	for ( i = 0; i < n; ++i )
-		s1[i] = s2[i];
-}
-#endif
-
-#ifdef YY_NEED_STRLEN
-static int yy_flex_strlen (yyconst char * s )
-{
-	register int n;
-	for ( n = 0; s[n]; ++n )
-		;
-
-	return n;
-}
-#endif
+		if (keyword != nullptr && strncmp(keyword->text, start, length) == 0
+			&& keyword->text[length] == '\0')
+		    return token(keyword->token, start, p);
+	    }
 
-void *yyalloc (yy_size_t  size )
-{
-	return (void *) malloc( size );
-}
-
-void *yyrealloc  (void * ptr, yy_size_t  size )
-{
-	/* The cast to (char *) in the following accommodates both
-	 * implementations that use char* generic pointers, and those
-	 * that use void* generic pointers.  It works with the latter
-	 * because both ANSI C and C++ allow castless assignment from
-	 * any pointer type to void*, and deal with argument conversions
-	 * as though doing an assignment.
-	 */
-	return (void *) realloc( (char *) ptr, size );
-}
+	    yyname = Name(start, length);
+	    return token(ID, start, p);
 
-void yyfree (void * ptr )
-{
-	free( (char *) ptr );	/* see yyrealloc() for (char *) cast */
-}
+	case DIGIT:
+	    while (++ p < limit && classes[(unsigned char) *p] == DIGIT)
+		continue;
 
-#define YYTABLES_NAME "yytables"
+	    if (p + 1 < limit && p[0] == '.' && classes[(unsigned char) p[1]] == DIGIT) {
+		p += 2;
 
-#line 88 "lexer.l"
+		while (p < limit && classes[(unsigned char) *p] == DIGIT)
+		    p ++;
 
+		if (p < limit && (*p == 'e' || *p == 'E')) {
+		    q = p + 1;
 
+		    if (q < limit && (*q == '+' || *q == '-'))
+			q ++;
 
-/*
- * Function:	ignoreComment
- *
- * Description:	Ignore a comment after recognizing its beginning.
- */
+		    if (q < limit && classes[(unsigned char) *q] == DIGIT) {
+			p = q;
 
-static void ignoreComment()
-{
-    int c1, c2;
+			while (p < limit && classes[(unsigned char) *p] == DIGIT)
+			    p ++;
+		    }
+		}
 
+		kind = token(REAL, start, p);
+		checkReal();
+		return kind;
+	    }
 
-    while ((c1 = yyinput()) != 0) {
-	while (c1 == '*') {
-	    if ((c2 = yyinput()) == '/' || c2 == 0)
-		return;
+	    kind = token(INTEGER, start, p);
+	    checkInt();
+	    return kind;
+	}
 
-	    c1 = c2;
+	q = p + 1;
+
+	switch (*p) {
+	case '/':
+	    if (q < limit && *q == '*') {
+		p = ignoreComment(q + 1);
+		continue;
+	    }
+
+	    return token('/', start, q);
+
+	case '"':
+	    if ((q = scanQuoted(q, '"')) == nullptr) {
+		p ++;
+		continue;
+	    }
+
+	    kind = token(STRING, start, q);
+	    checkString();
+	    return kind;
+
+	case '\'':
+	    if ((q = scanQuoted(q, '\'')) == nullptr) {
+		p ++;
+		continue;
+	    }
+
+	    kind = token(CHARACTER, start, q);
+	    checkChar();
+	    return kind;
+
+	case '|':
+	    if (q < limit && *q == '|')
+		return token(OR, start, q + 1);
+	    break;
+
+	case '&':
+	    if (q < limit && *q == '&')
+		return token(AND, start, q + 1);
+	    break;
+
+	case '=':
+	    if (q < limit && *q == '=')
+		return token(EQL, start, q + 1);
+	    break;
+
+	case '!':
+	    if (q < limit && *q == '=')
+		return token(NEQ, start, q + 1);
+	    break;
+
+	case '<':
+	    if (q < limit && *q == '=')
+		return token(LEQ, start, q + 1);
+	    break;
+
+	case '>':
+	    if (q < limit && *q == '=')
+		return token(GEQ, start, q + 1);
+	    break;
+
+	case '+':
+	    if (q < limit && *q == '+')
+		return token(INC, start, q + 1);
+	    break;
+
+	case '-':
+	    if (q < limit && *q == '-')
+		return token(DEC, start, q + 1);
+
+	    if (q < limit && *q == '>')
+		return token(ARROW, start, q + 1);
+	    break;
+
+	case '.':
+	    if (q + 1 < limit && q[0] == '.' && q[1] == '.')
+		return token(ELLIPSIS, start, q + 2);
+	    break;
 	}
-    }
 
-    if (c1 == 0)
-	report("unterminated comment");
+	return token(*p, start, q);
+    }
 }
 
 
 /*
- * Function:	checkInt
+ * Function:	scanAhead
  *
- * Description:	Check if an integer constant is valid.
+ * Description:	Return the token N tokens after the next unconsumed token,
+ *		scanning as many tokens as necessary.  The scanned tokens
+ *		are not yet seen by the parser, so the text and line used
+ *		for diagnostics are left as they were, and any errors in
+ *		them are kept with the tokens until they are seen.
  */
 
-static void checkInt()
+const Token &scanAhead(unsigned n)
 {
-    long val;
+    Token token;
 
 
-    errno = 0;
-    val = strtol(yytext, NULL, 0);
+    if (window.size() - first <= n) {
+	Timer::Scope timer(Timer::LEX);
 
-    if (errno != 0 || val != (int) val)
-	report("integer constant too large");
-}
+	yylineno = line;
 
+	while (window.size() - first <= n) {
+	    deferred = &token.errors;
+	    token.errors.clear();
+	    token.kind = yylex();
+	    deferred = nullptr;
+	    token.line = yylineno;
+	    token.text = yytext;
+	    token.length = yyleng;
+	    token.name = token.kind == ID ? yyname : Name();
+	    window.push_back(token);
+	}
 
-/*
- * Function:	checkReal
- *
- * Description:	Check if a floating-point constant is valid.
- */
+	line = yylineno;
 
-static void checkReal()
-{
-    errno = 0;
-    strtod(yytext, NULL);
+	if (last < window.size()) {
+	    yytext = window[last].text;
+	    yyleng = window[last].length;
+	    yylineno = window[last].line;
+	}
+    }
 
-    if (errno != 0)
-	report("floating-point constant out of range");
+    return window[first + n];
 }
 
 
 /*
- * Function:	checkString
+ * Function:	lookAhead
  *
- * Description:	Check if a string literal is valid.
+ * Description:	Return the token N tokens after the next unconsumed token.
+ *		The text and line of the furthest token seen by the parser
+ *		are used for diagnostics, and the errors in the tokens up
+ *		to it are reported, just as if the tokens had been scanned
+ *		only as the parser asked for them.
  */
 
-static void checkString()
+const Token &lookAhead(unsigned n)
 {
-    bool invalid, overflow;
-    string s(yytext + 1, yyleng - 2);
+    const Token &token = scanAhead(n);
 
 
-    s = parseString(s, invalid, overflow);
+    if (first + n >= last) {
+	for (size_t i = last; i <= first + n; i ++)
+	    if (!window[i].errors.empty()) {
+		numerrors += count(window[i].errors.begin(),
+				   window[i].errors.end(), '\n');
+		cerr << window[i].errors;
+		window[i].errors.clear();
+	    }
 
-    if (invalid)
-	report("unknown escape sequence in string constant");
-    else if (overflow)
-	report("escape sequence out of range in string constant");
+	last = first + n;
+	yytext = token.text;
+	yyleng = token.length;
+	yylineno = token.line;
+    }
+
+    return token;
 }
 
 
 /*
- * Function:	checkChar
+ * Function:	consume
  *
- * Description:	Check if a character literal is valid.
+ * Description:	Discard the next unconsumed token.  The storage of the
+ *		buffer is reused once every scanned token is consumed.
  */
 
-static void checkChar()
+void consume()
 {
-    bool invalid, overflow;
-    string s(yytext + 1, yyleng - 2);
+    lookAhead();
 
-
-    s = parseString(s, invalid, overflow);
-
-    if (invalid)
-	report("unknown escape sequence in character constant");
-    else if (overflow)
-	report("escape sequence out of range in character constant");
-    else if (s.size() > 1)
-	report("multi-character character constant");
+    if (++ first == window.size()) {
+	window.clear();
+	first = last = 0;
+    }
 }
 
 
@@ -2233,6 +603,7 @@ static void checkChar()
  *		optional string argument, but C++'s stupid streams don't do
  *		positional arguments, so we actually resort to snprintf.
  *		You just can't beat C for doing things down and dirty.
+ *		An error found while scanning ahead is kept for later.
  */
 
 void report(const string &str, const string &arg)
@@ -2240,8 +611,57 @@ void report(const string &str, const string &arg)
     char buf[1000];
 
 
+    if (quiet)
+	return;
+
     snprintf(buf, sizeof(buf), str.c_str(), arg.c_str());
+
+    if (deferred != nullptr) {
+	*deferred += "line " + to_string(yylineno) + ": " + buf + "\n";
+	return;
+    }
+
     cerr << "line " << yylineno << ": " << buf << endl;
     numerrors ++;
 }
 
+
+/*
+ * Function:	fingerprint
+ *
+ * Description:	Add the kind and text of every token in the input to the
+ *		given digest, so that the digest is unaffected by changes
+ *		to whitespace and comments.  The input is scanned without
+ *		reporting any errors, and the lexer is left as it was.
+ */
+
+void fingerprint(Digest &digest)
+{
+    Timer::Scope timer(Timer::CACHE);
+    const char *saved, *text;
+    int kind, lineno, errors;
+    size_t length;
+
+
+    if (limit == nullptr)
+	initialize();
+
+    saved = cursor;
+    text = yytext;
+    length = yyleng;
+    lineno = yylineno;
+    errors = numerrors;
+    quiet = true;
+
+    do {
+	kind = yylex();
+	digest.add(kind).add(yytext, yyleng);
+    } while (kind != DONE);
+
+    cursor = saved;
+    yytext = text;
+    yyleng = length;
+    yylineno = lineno;
+    numerrors = errors;
+    quiet = false;
+}
@@ -2,17 +2,45 @@
  * File:	lexer.h
  *
  * Description:	This file contains the public function and variable
- *		declarations for the lexical analyzer for Simple C.
+ *		declarations for the lexical analyzer for Simple C.  The
+ *		text of the most recent token is a slice of the input given
+ *		by yytext and yyleng, and is not null terminated.  The name
+ *		of the most recent identifier is left in yyname.
+ *
+ *		The parser instead reads tokens through a buffer, which
+ *		holds the kind, text, and line of each token not yet
+ *		consumed.  Tokens are only scanned as they are needed, and
+ *		a reference to a buffered token is valid until the buffer
+ *		is next used.  Tokens may also be scanned far ahead without
+ *		disturbing the line used for diagnostics, in which case any
+ *		errors in a token are only reported once the parser sees it.
  */
 
 # ifndef LEXER_H
 # define LEXER_H
+# include <cstddef>
 # include <string>
+# include "Name.h"
 
-extern char *yytext;
+extern const char *yytext;
+extern size_t yyleng;
+extern Name yyname;
 extern int yylineno, numerrors;
 
+struct Token {
+    int kind;
+    unsigned line;
+    const char *text;
+    size_t length;
+    Name name;
+    std::string errors;
+};
+
 extern int yylex();
+extern const Token &lookAhead(unsigned n = 0);
+extern const Token &scanAhead(unsigned n);
+extern void consume();
+extern void fingerprint(class Digest &digest);
 extern void report(const std::string &str, const std::string &arg = "");
 
 # endif /* LEXER_H */
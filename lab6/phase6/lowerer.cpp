@@ -0,0 +1,1294 @@
+/*
+ * File:	lowerer.cpp
+ *
+ * Description:	This file contains the member function definitions for
+ *		lowering the abstract syntax tree of a function to its
+ *		intermediate code.  The actual classes are declared
+ *		elsewhere, mainly in Tree.h and IR.h.
+ *
+ *		Statements are lowered into the current block, and
+ *		control flow starts new blocks.  Conditions are lowered
+ *		as branches, so that && and || are short-circuited without
+ *		computing a value that is only tested.  Anything lowered
+ *		after a jump or return goes in a new block that nothing
+ *		reaches and is later removed.
+ *
+ *		Local scalar variables are at first read and written by
+ *		name.  Once the function has been lowered, the variables
+ *		whose address is never taken are promoted to virtual
+ *		registers, putting the procedure in SSA form: phi
+ *		instructions are placed on the iterated dominance frontier
+ *		of the blocks that assign a variable, and each use is then
+ *		renamed to the definition that reaches it by walking the
+ *		dominator tree (Cytron et al.).  The other variables are
+ *		read and written in memory.
+ */
+
+# include <algorithm>
+# include <cassert>
+# include <map>
+# include <set>
+# include "IR.h"
+# include "Target.h"
+# include "Timer.h"
+# include "Tree.h"
+
+using namespace std;
+
+/*
+ * The state of lowering a single function: the procedure being built,
+ * the block into which instructions are being added, and the blocks to
+ * which break statements jump.
+ */
+
+struct Builder {
+    Procedure *proc;
+    BasicBlock *block;
+    vector<BasicBlock *> breaks;
+};
+
+static thread_local Builder *builder;
+
+
+/*
+ * Function:	kind (private)
+ *
+ * Description:	Return the kind of virtual register that holds a value of
+ *		the given type.  Characters are held sign-extended to
+ *		integers, and an array stands for its address.
+ */
+
+static Instruction::Kind kind(const Type &type)
+{
+    if (type.isReal())
+	return Instruction::REAL;
+
+    if (type.promote().isPointer())
+	return Instruction::PTR;
+
+    return Instruction::INT;
+}
+
+
+/*
+ * Function:	start (private)
+ *
+ * Description:	Continue lowering in the given block.
+ */
+
+static void start(BasicBlock *block)
+{
+    builder->block = block;
+}
+
+
+/*
+ * Function:	emit (private)
+ *
+ * Description:	Add an instruction to the end of the current block.  If
+ *		the current block has already ended, the instruction is
+ *		unreachable and goes in a new block of its own.
+ */
+
+static Instruction *emit(Instruction *instruction)
+{
+    if (builder->block == nullptr)
+	builder->block = builder->proc->block();
+
+    instruction->block = builder->block;
+    builder->block->instructions.push_back(instruction);
+
+    if (instruction->terminates())
+	builder->block = nullptr;
+
+    return instruction;
+}
+
+
+/*
+ * Function:	emit (private)
+ *
+ * Description:	Create an instruction with the given operands and add it to
+ *		the end of the current block.
+ */
+
+static Instruction *emit(Instruction::Opcode opcode, Instruction::Kind kind,
+			 const vector<Instruction *> &operands)
+{
+    Instruction *instruction = builder->proc->create(opcode, kind);
+
+    instruction->operands = operands;
+    return emit(instruction);
+}
+
+
+/*
+ * Function:	jump (private)
+ *
+ * Description:	End the current block with a jump to the given block.
+ */
+
+static void jump(BasicBlock *target)
+{
+    emit(Instruction::JUMP, Instruction::NONE, {})->blocks = {target};
+}
+
+
+/*
+ * Function:	address (private)
+ *
+ * Description:	Return the constant address of a local or global variable.
+ */
+
+static Instruction *address(const Symbol *symbol)
+{
+    Instruction *result;
+
+
+    if (symbol->offset == 0)
+	result = builder->proc->create(Instruction::GLOBAL, Instruction::PTR);
+    else
+	result = builder->proc->create(Instruction::FRAME, Instruction::PTR);
+
+    result->symbol = symbol;
+    return result;
+}
+
+
+/*
+ * Function:	zero (private)
+ *
+ * Description:	Return a zero of the same kind as the given value.
+ */
+
+static Instruction *zero(Instruction *value)
+{
+    Instruction *result;
+
+
+    if (value->kind != Instruction::REAL)
+	return builder->proc->constant(0, value->kind);
+
+    result = builder->proc->create(Instruction::FCONST, Instruction::REAL);
+    result->real = 0;
+    return result;
+}
+
+
+/*
+ * Function:	fetch (private)
+ *
+ * Description:	Return the value of an lvalue, given the address of the
+ *		lvalue or null if it is a local variable.
+ */
+
+static Instruction *fetch(Expression *expr, Instruction *pointer,
+			  const Symbol *symbol)
+{
+    Instruction *result;
+
+
+    if (pointer != nullptr) {
+	result = emit(Instruction::LOAD, kind(expr->type()), {pointer});
+	result->size = expr->type().size();
+
+    } else {
+	result = emit(Instruction::GET, kind(expr->type()), {});
+	result->symbol = symbol;
+	result->size = expr->type().size();
+    }
+
+    return result;
+}
+
+
+/*
+ * Function:	store (private)
+ *
+ * Description:	Assign a value to an lvalue, given the address of the
+ *		lvalue or null if it is a local variable.
+ */
+
+static void store(Expression *expr, Instruction *pointer,
+		  const Symbol *symbol, Instruction *value)
+{
+    Instruction *result;
+
+
+    if (pointer != nullptr) {
+	result = emit(Instruction::STORE, Instruction::NONE, {pointer, value});
+	result->size = expr->type().size();
+
+    } else {
+	result = emit(Instruction::SET, Instruction::NONE, {value});
+	result->symbol = symbol;
+	result->size = expr->type().size();
+    }
+}
+
+
+/*
+ * Function:	locate (private)
+ *
+ * Description:	Find where an lvalue lives.  The address of a dereference
+ *		or a global is returned; a local variable is returned as
+ *		its symbol and a null address.
+ */
+
+static Instruction *locate(Expression *expr, const Symbol *&symbol)
+{
+    Expression *pointer = expr->isDereference();
+    Identifier *id = dynamic_cast<Identifier *>(expr);
+
+
+    symbol = nullptr;
+
+    if (pointer != nullptr)
+	return pointer->evaluate();
+
+    assert(id != nullptr);
+    symbol = id->symbol();
+
+    if (symbol->offset == 0)
+	return address(symbol);
+
+    return nullptr;
+}
+
+
+/*
+ * Function:	Expression::lower
+ *
+ * Description:	Lower an expression statement, whose value is discarded.
+ */
+
+void Expression::lower()
+{
+    evaluate();
+}
+
+
+/*
+ * Function:	Expression::evaluate
+ *
+ * Description:	Lower an expression and return the instruction giving its
+ *		value.  Every kind of expression overrides this function.
+ */
+
+Instruction *Expression::evaluate()
+{
+    assert(false);
+    return nullptr;
+}
+
+
+/*
+ * Function:	Expression::decide
+ *
+ * Description:	Lower an expression used as a condition, ending the
+ *		current block with a branch to one block if the value of
+ *		the expression is nonzero and to another if it is zero.
+ */
+
+void Expression::decide(BasicBlock *ifTrue, BasicBlock *ifFalse)
+{
+    Instruction *value = evaluate();
+    Instruction *result;
+
+
+    result = emit(Instruction::BRANCH, Instruction::NONE, {value, zero(value)});
+    result->condition = Instruction::NE;
+    result->blocks = {ifTrue, ifFalse};
+}
+
+
+/*
+ * Function:	String::evaluate
+ *
+ * Description:	Lower a string literal to its address.
+ */
+
+Instruction *String::evaluate()
+{
+    Instruction *result;
+
+
+    result = builder->proc->create(Instruction::STRING, Instruction::PTR);
+    result->text = _value;
+    return result;
+}
+
+
+/*
+ * Function:	Identifier::evaluate
+ *
+ * Description:	Lower an identifier to the value of its variable.
+ */
+
+Instruction *Identifier::evaluate()
+{
+    const Symbol *symbol;
+    Instruction *pointer;
+
+
+    pointer = locate(this, symbol);
+    return fetch(this, pointer, symbol);
+}
+
+
+/*
+ * Function:	Integer::evaluate
+ *
+ * Description:	Lower an integer literal to a constant.
+ */
+
+Instruction *Integer::evaluate()
+{
+    return builder->proc->constant(_value);
+}
+
+
+/*
+ * Function:	Real::evaluate
+ *
+ * Description:	Lower a real literal to a constant.
+ */
+
+Instruction *Real::evaluate()
+{
+    Instruction *result;
+
+
+    result = builder->proc->create(Instruction::FCONST, Instruction::REAL);
+    result->real = _value;
+    return result;
+}
+
+
+/*
+ * Function:	Call::evaluate
+ *
+ * Description:	Lower a function call, evaluating the arguments from left
+ *		to right.
+ */
+
+Instruction *Call::evaluate()
+{
+    vector<Instruction *> args;
+    Instruction *result;
+
+
+    for (auto arg : _args)
+	args.push_back(arg->evaluate());
+
+    result = emit(Instruction::CALL, kind(_type), args);
+    result->symbol = _id;
+    result->size = _type.size();
+    return result;
+}
+
+
+/*
+ * Function:	Not::evaluate
+ *
+ * Description:	Lower a logical negation to a comparison against zero.
+ */
+
+Instruction *Not::evaluate()
+{
+    Instruction *value = _expr->evaluate();
+    Instruction *result;
+
+
+    result = emit(Instruction::CMP, Instruction::INT, {value, zero(value)});
+    result->condition = Instruction::EQ;
+    return result;
+}
+
+
+/*
+ * Function:	Not::decide
+ *
+ * Description:	Lower a logical negation used as a condition by branching
+ *		on its operand the other way.
+ */
+
+void Not::decide(BasicBlock *ifTrue, BasicBlock *ifFalse)
+{
+    _expr->decide(ifFalse, ifTrue);
+}
+
+
+/*
+ * Function:	Negate::evaluate
+ *
+ * Description:	Lower an arithmetic negation.
+ */
+
+Instruction *Negate::evaluate()
+{
+    return emit(Instruction::NEG, kind(_type), {_expr->evaluate()});
+}
+
+
+/*
+ * Function:	Dereference::evaluate
+ *
+ * Description:	Lower a dereference to a load through the pointer.
+ */
+
+Instruction *Dereference::evaluate()
+{
+    Instruction *result;
+
+
+    result = emit(Instruction::LOAD, kind(_type), {_expr->evaluate()});
+    result->size = _type.size();
+    return result;
+}
+
+
+/*
+ * Function:	Address::evaluate
+ *
+ * Description:	Lower an address expression.  The address of a
+ *		dereference is the pointer itself.
+ */
+
+Instruction *Address::evaluate()
+{
+    Expression *pointer = _expr->isDereference();
+    Identifier *id = dynamic_cast<Identifier *>(_expr);
+
+
+    if (pointer != nullptr)
+	return pointer->evaluate();
+
+    if (id != nullptr)
+	return address(id->symbol());
+
+    return _expr->evaluate();
+}
+
+
+/*
+ * Function:	update (private)
+ *
+ * Description:	Lower a postfix increment or decrement of an lvalue by the
+ *		given amount.  The result is the value before the update.
+ */
+
+static Instruction *update(Expression *expr, int delta)
+{
+    Instruction *pointer, *before, *after, *amount;
+    const Symbol *symbol;
+
+
+    pointer = locate(expr, symbol);
+    before = fetch(expr, pointer, symbol);
+
+    if (before->kind == Instruction::REAL) {
+	amount = builder->proc->create(Instruction::FCONST, Instruction::REAL);
+	amount->real = delta < 0 ? -1 : 1;
+    } else
+	amount = builder->proc->constant(delta);
+
+    after = emit(Instruction::ADD, before->kind, {before, amount});
+
+    if (expr->type().size() == 1)
+	after = emit(Instruction::EXTEND, Instruction::INT, {after});
+
+    store(expr, pointer, symbol, after);
+    return before;
+}
+
+
+/*
+ * Function:	Increment::evaluate
+ *
+ * Description:	Lower a postfix increment.
+ */
+
+Instruction *Increment::evaluate()
+{
+    return update(_expr, scale);
+}
+
+
+/*
+ * Function:	Decrement::evaluate
+ *
+ * Description:	Lower a postfix decrement.
+ */
+
+Instruction *Decrement::evaluate()
+{
+    return update(_expr, -(int) scale);
+}
+
+
+/*
+ * Function:	Cast::evaluate
+ *
+ * Description:	Lower a type cast.  Only conversions between integers and
+ *		doubles and truncations to characters change the value.
+ */
+
+Instruction *Cast::evaluate()
+{
+    Instruction *value = _expr->evaluate();
+
+
+    if (_type.isReal() && !_expr->type().isReal())
+	return emit(Instruction::ITOF, Instruction::REAL, {value});
+
+    if (!_type.isReal() && _expr->type().isReal())
+	value = emit(Instruction::FTOI, Instruction::INT, {value});
+
+    if (_type.size() == 1 && _expr->type().size() != 1)
+	value = emit(Instruction::EXTEND, Instruction::INT, {value});
+
+    return value;
+}
+
+
+/*
+ * Function:	scale (private)
+ *
+ * Description:	Multiply an integer added to or subtracted from a pointer
+ *		by the size of the objects pointed to.
+ */
+
+static Instruction *scale(Instruction *value, unsigned size)
+{
+    Instruction *factor;
+
+
+    if (size == 0)
+	return value;
+
+    factor = builder->proc->constant(size);
+    return emit(Instruction::MUL, Instruction::INT, {value, factor});
+}
+
+
+/*
+ * Function:	Multiply::evaluate
+ *
+ * Description:	Lower a multiplication.
+ */
+
+Instruction *Multiply::evaluate()
+{
+    Instruction *left = _left->evaluate();
+    Instruction *right = _right->evaluate();
+
+    return emit(Instruction::MUL, kind(_type), {left, right});
+}
+
+
+/*
+ * Function:	Divide::evaluate
+ *
+ * Description:	Lower a division.
+ */
+
+Instruction *Divide::evaluate()
+{
+    Instruction *left = _left->evaluate();
+    Instruction *right = _right->evaluate();
+
+    return emit(Instruction::DIV, kind(_type), {left, right});
+}
+
+
+/*
+ * Function:	Remainder::evaluate
+ *
+ * Description:	Lower a remainder.
+ */
+
+Instruction *Remainder::evaluate()
+{
+    Instruction *left = _left->evaluate();
+    Instruction *right = _right->evaluate();
+
+    return emit(Instruction::REM, kind(_type), {left, right});
+}
+
+
+/*
+ * Function:	Add::evaluate
+ *
+ * Description:	Lower an addition, scaling an integer added to a pointer.
+ */
+
+Instruction *Add::evaluate()
+{
+    Instruction *left = scale(_left->evaluate(), scaleLeft);
+    Instruction *right = scale(_right->evaluate(), scaleRight);
+
+    return emit(Instruction::ADD, kind(_type), {left, right});
+}
+
+
+/*
+ * Function:	Subtract::evaluate
+ *
+ * Description:	Lower a subtraction, scaling an integer subtracted from a
+ *		pointer.  The difference of two pointers is an exact
+ *		multiple of the size of the objects pointed to, which is
+ *		always a power of two, and so is divided by shifting.
+ */
+
+Instruction *Subtract::evaluate()
+{
+    Instruction *left = _left->evaluate();
+    Instruction *right = scale(_right->evaluate(), scaleRight);
+    Instruction *result;
+    int shift;
+
+
+    result = emit(Instruction::SUB, kind(_type), {left, right});
+
+    if (scaleResult > 1) {
+	assert((scaleResult & (scaleResult - 1)) == 0);
+
+	for (shift = 0; (1u << shift) < scaleResult; shift ++)
+	    ;
+
+	result = emit(Instruction::SAR, Instruction::INT,
+		      {result, builder->proc->constant(shift)});
+    }
+
+    return result;
+}
+
+
+/*
+ * Function:	compare (private)
+ *
+ * Description:	Lower a comparison of two expressions to its value.
+ */
+
+static Instruction *compare(Expression *left, Expression *right,
+			    Instruction::Condition condition)
+{
+    Instruction *first = left->evaluate();
+    Instruction *second = right->evaluate();
+    Instruction *result;
+
+
+    result = emit(Instruction::CMP, Instruction::INT, {first, second});
+    result->condition = condition;
+    return result;
+}
+
+
+/*
+ * Function:	branch (private)
+ *
+ * Description:	Lower a comparison of two expressions used as a condition
+ *		to a branch on the comparison.
+ */
+
+static void branch(Expression *left, Expression *right,
+		   Instruction::Condition condition,
+		   BasicBlock *ifTrue, BasicBlock *ifFalse)
+{
+    Instruction *first = left->evaluate();
+    Instruction *second = right->evaluate();
+    Instruction *result;
+
+
+    result = emit(Instruction::BRANCH, Instruction::NONE, {first, second});
+    result->condition = condition;
+    result->blocks = {ifTrue, ifFalse};
+}
+
+Instruction *LessThan::evaluate()
+{
+    return compare(_left, _right, Instruction::LT);
+}
+
+void LessThan::decide(BasicBlock *ifTrue, BasicBlock *ifFalse)
+{
+    branch(_left, _right, Instruction::LT, ifTrue, ifFalse);
+}
+
+Instruction *GreaterThan::evaluate()
+{
+    return compare(_left, _right, Instruction::GT);
+}
+
+void GreaterThan::decide(BasicBlock *ifTrue, BasicBlock *ifFalse)
+{
+    branch(_left, _right, Instruction::GT, ifTrue, ifFalse);
+}
+
+Instruction *LessOrEqual::evaluate()
+{
+    return compare(_left, _right, Instruction::LE);
+}
+
+void LessOrEqual::decide(BasicBlock *ifTrue, BasicBlock *ifFalse)
+{
+    branch(_left, _right, Instruction::LE, ifTrue, ifFalse);
+}
+
+Instruction *GreaterOrEqual::evaluate()
+{
+    return compare(_left, _right, Instruction::GE);
+}
+
+void GreaterOrEqual::decide(BasicBlock *ifTrue, BasicBlock *ifFalse)
+{
+    branch(_left, _right, Instruction::GE, ifTrue, ifFalse);
+}
+
+Instruction *Equal::evaluate()
+{
+    return compare(_left, _right, Instruction::EQ);
+}
+
+void Equal::decide(BasicBlock *ifTrue, BasicBlock *ifFalse)
+{
+    branch(_left, _right, Instruction::EQ, ifTrue, ifFalse);
+}
+
+Instruction *NotEqual::evaluate()
+{
+    return compare(_left, _right, Instruction::NE);
+}
+
+void NotEqual::decide(BasicBlock *ifTrue, BasicBlock *ifFalse)
+{
+    branch(_left, _right, Instruction::NE, ifTrue, ifFalse);
+}
+
+
+/*
+ * Function:	logical (private)
+ *
+ * Description:	Lower the value of a logical expression by branching on it
+ *		to blocks that give the value one or zero.
+ */
+
+static Instruction *logical(Expression *expr)
+{
+    BasicBlock *yes, *no, *join;
+    Instruction *result;
+
+
+    yes = builder->proc->block();
+    no = builder->proc->block();
+    join = builder->proc->block();
+
+    expr->decide(yes, no);
+    start(yes);
+    jump(join);
+    start(no);
+    jump(join);
+    start(join);
+
+    result = builder->proc->create(Instruction::PHI, Instruction::INT);
+    result->operands = {builder->proc->constant(1), builder->proc->constant(0)};
+    result->blocks = {yes, no};
+    return emit(result);
+}
+
+Instruction *LogicalAnd::evaluate()
+{
+    return logical(this);
+}
+
+Instruction *LogicalOr::evaluate()
+{
+    return logical(this);
+}
+
+
+/*
+ * Function:	LogicalAnd::decide
+ *
+ * Description:	Lower a logical-and used as a condition.  The right operand
+ *		is tested only if the left one is true.
+ */
+
+void LogicalAnd::decide(BasicBlock *ifTrue, BasicBlock *ifFalse)
+{
+    BasicBlock *next = builder->proc->block();
+
+    _left->decide(next, ifFalse);
+    start(next);
+    _right->decide(ifTrue, ifFalse);
+}
+
+
+/*
+ * Function:	LogicalOr::decide
+ *
+ * Description:	Lower a logical-or used as a condition.  The right operand
+ *		is tested only if the left one is false.
+ */
+
+void LogicalOr::decide(BasicBlock *ifTrue, BasicBlock *ifFalse)
+{
+    BasicBlock *next = builder->proc->block();
+
+    _left->decide(ifTrue, next);
+    start(next);
+    _right->decide(ifTrue, ifFalse);
+}
+
+
+/*
+ * Function:	Assignment::lower
+ *
+ * Description:	Lower an assignment statement.  As in the generated code,
+ *		the right-hand side is evaluated before the address of the
+ *		left-hand side.
+ */
+
+void Assignment::lower()
+{
+    Instruction *value, *pointer;
+    const Symbol *symbol;
+
+
+    value = _right->evaluate();
+    pointer = locate(_left, symbol);
+    store(_left, pointer, symbol, value);
+}
+
+
+/*
+ * Function:	Break::lower
+ *
+ * Description:	Lower a break statement to a jump out of the innermost
+ *		loop.
+ */
+
+void Break::lower()
+{
+    jump(builder->breaks.back());
+}
+
+
+/*
+ * Function:	Return::lower
+ *
+ * Description:	Lower a return statement.
+ */
+
+void Return::lower()
+{
+    emit(Instruction::RETURN, Instruction::NONE, {_expr->evaluate()});
+}
+
+
+/*
+ * Function:	Block::lower
+ *
+ * Description:	Lower each statement of a block in turn.
+ */
+
+void Block::lower()
+{
+    for (auto stmt : _stmts)
+	stmt->lower();
+}
+
+
+/*
+ * Function:	While::lower
+ *
+ * Description:	Lower a while statement.  The condition is tested in a
+ *		block of its own at the top of the loop.
+ */
+
+void While::lower()
+{
+    BasicBlock *test, *body, *exit;
+
+
+    test = builder->proc->block();
+    body = builder->proc->block();
+    exit = builder->proc->block();
+
+    jump(test);
+    start(test);
+    _expr->decide(body, exit);
+
+    start(body);
+    builder->breaks.push_back(exit);
+    _stmt->lower();
+    builder->breaks.pop_back();
+    jump(test);
+
+    start(exit);
+}
+
+
+/*
+ * Function:	For::lower
+ *
+ * Description:	Lower a for statement.  A break skips the increment.
+ */
+
+void For::lower()
+{
+    BasicBlock *test, *body, *exit;
+
+
+    _init->lower();
+
+    test = builder->proc->block();
+    body = builder->proc->block();
+    exit = builder->proc->block();
+
+    jump(test);
+    start(test);
+    _expr->decide(body, exit);
+
+    start(body);
+    builder->breaks.push_back(exit);
+    _stmt->lower();
+    builder->breaks.pop_back();
+    _incr->lower();
+    jump(test);
+
+    start(exit);
+}
+
+
+/*
+ * Function:	If::lower
+ *
+ * Description:	Lower an if-then or if-then-else statement.
+ */
+
+void If::lower()
+{
+    BasicBlock *then, *otherwise, *join;
+
+
+    then = builder->proc->block();
+    join = builder->proc->block();
+    otherwise = _elseStmt != nullptr ? builder->proc->block() : join;
+
+    _expr->decide(then, otherwise);
+    start(then);
+    _thenStmt->lower();
+    jump(join);
+
+    if (_elseStmt != nullptr) {
+	start(otherwise);
+	_elseStmt->lower();
+	jump(join);
+    }
+
+    start(join);
+}
+
+
+/*
+ * Function:	demote (private)
+ *
+ * Description:	Turn the reads and writes of a local variable whose
+ *		address is taken into loads and stores.
+ */
+
+static void demote(Procedure *proc, Instruction *instruction)
+{
+    Instruction *frame = proc->create(Instruction::FRAME, Instruction::PTR);
+
+
+    frame->symbol = instruction->symbol;
+
+    if (instruction->opcode == Instruction::GET) {
+	instruction->opcode = Instruction::LOAD;
+	instruction->operands = {frame};
+    } else {
+	instruction->opcode = Instruction::STORE;
+	instruction->operands.insert(instruction->operands.begin(), frame);
+    }
+
+    instruction->symbol = nullptr;
+}
+
+
+/*
+ * The state of renaming the promoted variables: the definitions of
+ * each variable that reach the current point, innermost last, the
+ * value of each before any assignment, the children of each block in
+ * the dominator tree, and what each read is replaced by.
+ */
+
+struct Renaming {
+    map<const Symbol *, vector<Instruction *>> stacks;
+    map<const Symbol *, Instruction *> initial;
+    map<BasicBlock *, vector<BasicBlock *>> children;
+    Replacements replacements;
+};
+
+
+/*
+ * Function:	rename (private)
+ *
+ * Description:	Rename the reads of promoted variables in the given block
+ *		and in the blocks it dominates, and fill in the values the
+ *		phi instructions of its successors receive from it.
+ */
+
+static void rename(BasicBlock *block, Renaming &renaming)
+{
+    vector<const Symbol *> pushed;
+    Replacements::iterator it;
+    const Symbol *symbol;
+
+
+    for (auto instruction : block->instructions) {
+	for (auto &operand : instruction->operands)
+	    if ((it = renaming.replacements.find(operand)) !=
+		    renaming.replacements.end())
+		operand = it->second;
+
+	symbol = instruction->symbol;
+
+	if (instruction->opcode == Instruction::PHI && symbol != nullptr) {
+	    renaming.stacks[symbol].push_back(instruction);
+	    pushed.push_back(symbol);
+
+	} else if (instruction->opcode == Instruction::GET) {
+	    vector<Instruction *> &stack = renaming.stacks[symbol];
+	    renaming.replacements[instruction] =
+		stack.empty() ? renaming.initial[symbol] : stack.back();
+
+	} else if (instruction->opcode == Instruction::SET) {
+	    renaming.stacks[symbol].push_back(instruction->operands[0]);
+	    pushed.push_back(symbol);
+	}
+    }
+
+    for (auto successor : block->successors())
+	for (auto phi : successor->instructions) {
+	    if (phi->opcode != Instruction::PHI)
+		break;
+
+	    if ((symbol = phi->symbol) == nullptr)
+		continue;
+
+	    vector<Instruction *> &stack = renaming.stacks[symbol];
+	    phi->operands.push_back(stack.empty() ? renaming.initial[symbol]
+				    : stack.back());
+	    phi->blocks.push_back(block);
+	}
+
+    for (auto child : renaming.children[block])
+	rename(child, renaming);
+
+    for (auto symbol : pushed)
+	renaming.stacks[symbol].pop_back();
+}
+
+
+/*
+ * Function:	prune (private)
+ *
+ * Description:	Remove the phi instructions for promoted variables whose
+ *		values are never used, except by other such instructions.
+ */
+
+static void prune(Procedure *proc)
+{
+    vector<Instruction *> work;
+    set<Instruction *> live;
+
+
+    for (auto block : proc->blocks)
+	for (auto instruction : block->instructions)
+	    if (instruction->opcode != Instruction::PHI ||
+		    instruction->symbol == nullptr)
+		for (auto operand : instruction->operands)
+		    if (live.insert(operand).second)
+			work.push_back(operand);
+
+    while (!work.empty()) {
+	Instruction *instruction = work.back();
+	work.pop_back();
+
+	if (instruction->opcode == Instruction::PHI)
+	    for (auto operand : instruction->operands)
+		if (live.insert(operand).second)
+		    work.push_back(operand);
+    }
+
+    for (auto block : proc->blocks) {
+	vector<Instruction *> kept;
+
+	for (auto instruction : block->instructions)
+	    if (instruction->opcode != Instruction::PHI ||
+		    instruction->symbol == nullptr || live.count(instruction))
+		kept.push_back(instruction);
+
+	block->instructions = kept;
+    }
+}
+
+
+/*
+ * Function:	promote (private)
+ *
+ * Description:	Promote the local scalar variables of a procedure whose
+ *		address is never taken to virtual registers.  A parameter
+ *		starts with the value passed to it, and any other variable
+ *		starts with zero.
+ */
+
+static void promote(Procedure *proc)
+{
+    map<BasicBlock *, set<BasicBlock *>> frontiers;
+    map<const Symbol *, set<BasicBlock *>> definitions;
+    set<const Symbol *> addressed;
+    vector<Instruction *> accesses;
+    BasicBlock *entry, *runner;
+    Renaming renaming;
+
+
+    proc->analyze();
+    entry = proc->blocks[0];
+
+
+    /* Find the variables whose address is taken. */
+
+    for (auto block : proc->blocks)
+	for (auto instruction : block->instructions) {
+	    for (auto operand : instruction->operands)
+		if (operand->opcode == Instruction::FRAME)
+		    addressed.insert(operand->symbol);
+
+	    if (instruction->opcode == Instruction::GET ||
+		    instruction->opcode == Instruction::SET)
+		accesses.push_back(instruction);
+	}
+
+    for (auto instruction : accesses)
+	if (addressed.count(instruction->symbol) > 0)
+	    demote(proc, instruction);
+	else if (instruction->opcode == Instruction::SET)
+	    definitions[instruction->symbol].insert(instruction->block);
+	else
+	    definitions[instruction->symbol];
+
+
+    /* Compute the dominance frontiers and the dominator tree. */
+
+    for (auto block : proc->blocks) {
+	if (block->dominator != nullptr)
+	    renaming.children[block->dominator].push_back(block);
+
+	if (block->predecessors.size() < 2)
+	    continue;
+
+	for (auto pred : block->predecessors)
+	    for (runner = pred; runner != block->dominator;
+		    runner = runner->dominator)
+		frontiers[runner].insert(block);
+    }
+
+
+    /* Place phi instructions on the iterated dominance frontiers. */
+
+    for (auto &element : definitions) {
+	const Symbol *symbol = element.first;
+	vector<BasicBlock *> work(element.second.begin(), element.second.end());
+	set<BasicBlock *> placed;
+	Instruction *initial;
+	Type type = symbol->type();
+
+	while (!work.empty()) {
+	    BasicBlock *block = work.back();
+	    work.pop_back();
+
+	    for (auto frontier : frontiers[block])
+		if (placed.insert(frontier).second) {
+		    Instruction *phi = proc->create(Instruction::PHI, kind(type));
+		    phi->symbol = symbol;
+		    phi->block = frontier;
+		    frontier->instructions.insert(frontier->instructions.begin(), phi);
+		    work.push_back(frontier);
+		}
+	}
+
+	if (find(proc->parameters.begin(), proc->parameters.end(), symbol)
+		!= proc->parameters.end()) {
+	    initial = proc->create(Instruction::LOAD, kind(type));
+	    initial->operands = {proc->create(Instruction::FRAME, Instruction::PTR)};
+	    initial->operands[0]->symbol = symbol;
+	    initial->size = type.size();
+	    initial->block = entry;
+	    entry->instructions.insert(entry->instructions.begin(), initial);
+
+	} else if (type.isReal()) {
+	    initial = proc->create(Instruction::FCONST, Instruction::REAL);
+	    initial->real = 0;
+
+	} else
+	    initial = proc->constant(0, kind(type));
+
+	renaming.initial[symbol] = initial;
+    }
+
+
+    /* Rename the reads and remove the reads and writes. */
+
+    rename(entry, renaming);
+    proc->replace(renaming.replacements);
+
+    for (auto block : proc->blocks) {
+	vector<Instruction *> kept;
+
+	for (auto instruction : block->instructions)
+	    if (instruction->opcode != Instruction::SET)
+		kept.push_back(instruction);
+
+	block->instructions = kept;
+    }
+
+    prune(proc);
+}
+
+
+/*
+ * Function:	Function::lower
+ *
+ * Description:	Lower this function to a procedure in SSA form.  Storage
+ *		is allocated as for generating code directly, so variables
+ *		left in memory live where they otherwise would.
+ */
+
+Procedure *Function::lower()
+{
+    const Symbols &symbols = _body->declarations()->symbols();
+    unsigned count = _id->type().parameters()->types.size();
+    Builder state;
+    int offset;
+
+
+    Label::begin(_id->name().str());
+    offset = target->sizeofRegister * 2;
+    allocate(offset);
+
+    state.proc = new Procedure(_id, Symbols(symbols.begin(),
+	symbols.begin() + count), offset);
+    builder = &state;
+
+    start(state.proc->block());
+    _body->lower();
+    emit(Instruction::RETURN, Instruction::NONE, {});
+    builder = nullptr;
+
+    promote(state.proc);
+    return state.proc;
+}
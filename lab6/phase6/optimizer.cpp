@@ -0,0 +1,1598 @@
+/*
+ * File:	optimizer.cpp
+ *
+ * Description:	This file contains the public and private function
+ *		definitions for the optimizer for Simple C.
+ *
+ *		The optimizer is a list of passes over the intermediate
+ *		code of a procedure, each enabled at some optimization
+ *		level.  The enabled passes are run in order, and the whole
+ *		list is run again while any pass changes the procedure,
+ *		since one pass often exposes work for another: folding a
+ *		branch removes blocks, which makes phi instructions
+ *		trivial, which makes more values constant.
+ *
+ *		Each pass keeps the procedure in SSA form and leaves its
+ *		blocks analyzed, so the next pass may rely on the order,
+ *		predecessors, and dominators of the blocks.
+ */
+
+# include <algorithm>
+# include <climits>
+# include <cstring>
+# include <iostream>
+# include <map>
+# include <set>
+# include <sstream>
+# include "optimizer.h"
+# include "Timer.h"
+
+using namespace std;
+
+struct Pass {
+    const char *name;
+    unsigned level;
+    bool (*run)(Procedure &proc);
+};
+
+static const unsigned MAX_ROUNDS = 8;
+
+static set<string> disabled;
+
+unsigned optimization = 0;
+bool dumpIR = false;
+
+
+/*
+ * Function:	evaluate (private)
+ *
+ * Description:	Return whether the given condition holds between two
+ *		values.
+ */
+
+template<class T>
+static bool evaluate(Instruction::Condition condition, T left, T right)
+{
+    switch (condition) {
+    case Instruction::EQ: return left == right;
+    case Instruction::NE: return left != right;
+    case Instruction::LT: return left < right;
+    case Instruction::GT: return left > right;
+    case Instruction::LE: return left <= right;
+    case Instruction::GE: return left >= right;
+    }
+
+    return false;
+}
+
+
+/*
+ * Function:	decide (private)
+ *
+ * Description:	Decide a comparison of two constants, returning one if it
+ *		holds, zero if it does not, and -1 if the operands are not
+ *		both constants of the same sort.
+ */
+
+static int decide(Instruction::Condition condition, const Instruction *left,
+		  const Instruction *right)
+{
+    if (left->opcode == Instruction::CONST &&
+	    right->opcode == Instruction::CONST)
+	return evaluate(condition, left->value, right->value);
+
+    if (left->opcode == Instruction::FCONST &&
+	    right->opcode == Instruction::FCONST)
+	return evaluate(condition, left->real, right->real);
+
+    return -1;
+}
+
+
+/*
+ * Function:	simplify (private)
+ *
+ * Description:	Simplify the control-flow graph of a procedure.  Branches
+ *		that always go the same way become jumps, a block that is
+ *		the only successor of its only predecessor is merged into
+ *		it, and jumps to blocks that do nothing but jump are sent
+ *		straight to the final target.
+ */
+
+static bool simplify(Procedure &proc)
+{
+    Replacements replacements;
+    bool changed = false;
+    int outcome;
+
+
+    /* Turn branches that always go the same way into jumps. */
+
+    for (auto block : proc.blocks) {
+	Instruction *last = block->terminator();
+
+	if (last == nullptr || last->opcode != Instruction::BRANCH)
+	    continue;
+
+	outcome = decide(last->condition, last->operands[0], last->operands[1]);
+
+	if (outcome == -1 && last->blocks[0] != last->blocks[1])
+	    continue;
+
+	last->opcode = Instruction::JUMP;
+	last->operands.clear();
+	last->blocks = {last->blocks[outcome == 0 ? 1 : 0]};
+	changed = true;
+    }
+
+    proc.analyze();
+
+
+    /* Merge each block into its only predecessor if it is the only
+       successor of that predecessor. */
+
+    for (auto block : proc.blocks) {
+	Instruction *last;
+	BasicBlock *next;
+
+	while ((last = block->terminator()) != nullptr &&
+		last->opcode == Instruction::JUMP) {
+	    next = last->blocks[0];
+
+	    if (next == block || next == proc.blocks[0] ||
+		    next->predecessors.size() != 1)
+		break;
+
+	    block->instructions.pop_back();
+
+	    for (auto instruction : next->instructions)
+		if (instruction->opcode == Instruction::PHI)
+		    replacements[instruction] = instruction->operands[0];
+		else {
+		    instruction->block = block;
+		    block->instructions.push_back(instruction);
+		}
+
+	    for (auto successor : next->successors()) {
+		for (auto &pred : successor->predecessors)
+		    if (pred == next)
+			pred = block;
+
+		for (auto phi : successor->instructions)
+		    if (phi->opcode == Instruction::PHI)
+			for (auto &from : phi->blocks)
+			    if (from == next)
+				from = block;
+	    }
+
+	    next->instructions.clear();
+	    next->predecessors.clear();
+	    changed = true;
+	}
+    }
+
+    proc.replace(replacements);
+
+
+    /* Thread jumps through blocks that only jump. */
+
+    for (unsigned i = 1; i < proc.blocks.size(); i ++) {
+	BasicBlock *block = proc.blocks[i], *next;
+	vector<BasicBlock *> preds;
+
+	if (block->instructions.size() != 1 ||
+		block->instructions[0]->opcode != Instruction::JUMP)
+	    continue;
+
+	next = block->instructions[0]->blocks[0];
+
+	if (next == block)
+	    continue;
+
+	preds = block->predecessors;
+
+	for (auto pred : preds) {
+	    bool merges = false, known = false;
+
+	    for (auto phi : next->instructions)
+		if (phi->opcode == Instruction::PHI)
+		    merges = true;
+
+	    for (auto other : next->predecessors)
+		if (other == pred)
+		    known = true;
+
+	    if (merges && known)
+		continue;
+
+	    pred->retarget(block, next);
+
+	    for (auto phi : next->instructions) {
+		if (phi->opcode != Instruction::PHI)
+		    break;
+
+		for (unsigned j = 0; j < phi->blocks.size(); j ++)
+		    if (phi->blocks[j] == block) {
+			phi->operands.push_back(phi->operands[j]);
+			phi->blocks.push_back(pred);
+			break;
+		    }
+	    }
+
+	    if (!known)
+		next->predecessors.push_back(pred);
+
+	    block->predecessors.erase(find(block->predecessors.begin(),
+					   block->predecessors.end(), pred));
+	    changed = true;
+	}
+    }
+
+    if (changed)
+	proc.analyze();
+
+    return changed;
+}
+
+
+/*
+ * Function:	is (private)
+ *
+ * Description:	Return whether an instruction is the given integer
+ *		constant.
+ */
+
+static bool is(const Instruction *instruction, int value)
+{
+    return instruction->opcode == Instruction::CONST &&
+	instruction->value == value;
+}
+
+
+/*
+ * Function:	same (private)
+ *
+ * Description:	Return whether two instructions are known to have the same
+ *		value.  Constants are created wherever they are used, so
+ *		two constants are the same if they are equal.
+ */
+
+static bool same(const Instruction *left, const Instruction *right)
+{
+    if (left == right)
+	return true;
+
+    if (left == nullptr || right == nullptr || left->opcode != right->opcode)
+	return false;
+
+    switch (left->opcode) {
+    case Instruction::CONST:
+	return left->value == right->value;
+
+    case Instruction::FCONST:
+	return memcmp(&left->real, &right->real, sizeof(double)) == 0;
+
+    case Instruction::STRING:
+	return left->text == right->text;
+
+    case Instruction::GLOBAL:
+    case Instruction::FRAME:
+	return left->symbol == right->symbol;
+
+    default:
+	return false;
+    }
+}
+
+
+/*
+ * Function:	fold (private)
+ *
+ * Description:	Return the value of an instruction if it can be found
+ *		without executing it, or null otherwise.  A copy has the
+ *		value it copies, a phi whose operands are all the same
+ *		(except for itself) has that value, pure operations on
+ *		constants are computed, and some arithmetic identities
+ *		are applied.  Operations whose result is undefined or that
+ *		trap are left alone.
+ */
+
+static Instruction *fold(Procedure &proc, Instruction *instruction)
+{
+    Instruction *left, *right, *unique, *result;
+    int a, b, c;
+    double x, y, z;
+
+
+    if (instruction->opcode == Instruction::COPY)
+	return instruction->operands[0];
+
+    if (instruction->opcode == Instruction::PHI) {
+	unique = nullptr;
+
+	for (auto operand : instruction->operands)
+	    if (operand != instruction && !same(operand, unique)) {
+		if (unique != nullptr)
+		    return nullptr;
+
+		unique = operand;
+	    }
+
+	return unique;
+    }
+
+    if (!instruction->pure() || instruction->constant() ||
+	    instruction->operands.empty())
+	return nullptr;
+
+    left = instruction->operands[0];
+    right = instruction->operands.size() > 1 ? instruction->operands[1] : left;
+
+
+    /* Comparisons of constants. */
+
+    if (instruction->opcode == Instruction::CMP) {
+	if ((c = decide(instruction->condition, left, right)) != -1)
+	    return proc.constant(c);
+
+	return nullptr;
+    }
+
+
+    /* Conversions of constants. */
+
+    if (instruction->opcode == Instruction::ITOF) {
+	if (left->opcode != Instruction::CONST)
+	    return nullptr;
+
+	result = proc.create(Instruction::FCONST, Instruction::REAL);
+	result->real = left->value;
+	return result;
+    }
+
+    if (instruction->opcode == Instruction::FTOI) {
+	if (left->opcode != Instruction::FCONST || !(left->real > INT_MIN - 1.0)
+		|| !(left->real < INT_MAX + 1.0))
+	    return nullptr;
+
+	return proc.constant((int) left->real);
+    }
+
+
+    /* Arithmetic on floating-point constants. */
+
+    if (instruction->kind == Instruction::REAL) {
+	if (left->opcode != Instruction::FCONST ||
+		right->opcode != Instruction::FCONST)
+	    return nullptr;
+
+	x = left->real;
+	y = right->real;
+
+	switch (instruction->opcode) {
+	case Instruction::ADD: z = x + y; break;
+	case Instruction::SUB: z = x - y; break;
+	case Instruction::MUL: z = x * y; break;
+	case Instruction::DIV: z = x / y; break;
+	case Instruction::NEG: z = -x; break;
+	default: return nullptr;
+	}
+
+	result = proc.create(Instruction::FCONST, Instruction::REAL);
+	result->real = z;
+	return result;
+    }
+
+
+    /* Arithmetic on integer constants, which wraps around. */
+
+    if (left->opcode == Instruction::CONST &&
+	    right->opcode == Instruction::CONST) {
+	a = left->value;
+	b = right->value;
+
+	switch (instruction->opcode) {
+	case Instruction::ADD: c = (unsigned) a + (unsigned) b; break;
+	case Instruction::SUB: c = (unsigned) a - (unsigned) b; break;
+	case Instruction::MUL: c = (unsigned) a * (unsigned) b; break;
+	case Instruction::NEG: c = - (unsigned) a; break;
+	case Instruction::SHL: c = (unsigned) a << (b & 31); break;
+	case Instruction::SAR: c = a >> (b & 31); break;
+	case Instruction::EXTEND: c = (signed char) a; break;
+
+	case Instruction::DIV:
+	case Instruction::REM:
+	    if (b == 0 || (a == INT_MIN && b == -1))
+		return nullptr;
+
+	    c = instruction->opcode == Instruction::DIV ? a / b : a % b;
+	    break;
+
+	default:
+	    return nullptr;
+	}
+
+	return proc.constant(c, instruction->kind);
+    }
+
+
+    /* Integer identities. */
+
+    switch (instruction->opcode) {
+    case Instruction::ADD:
+	if (is(right, 0))
+	    return left;
+
+	if (is(left, 0))
+	    return right;
+
+	break;
+
+    case Instruction::SUB:
+	if (is(right, 0))
+	    return left;
+
+	if (same(left, right))
+	    return proc.constant(0);
+
+	break;
+
+    case Instruction::MUL:
+	if (is(right, 1))
+	    return left;
+
+	if (is(left, 1))
+	    return right;
+
+	if (is(left, 0) || is(right, 0))
+	    return proc.constant(0, instruction->kind);
+
+	break;
+
+    case Instruction::DIV:
+	if (is(right, 1))
+	    return left;
+
+	break;
+
+    case Instruction::REM:
+	if (is(right, 1) || is(right, -1))
+	    return proc.constant(0);
+
+	break;
+
+    case Instruction::SHL:
+    case Instruction::SAR:
+	if (is(right, 0))
+	    return left;
+
+	break;
+
+    case Instruction::EXTEND:
+	if (left->opcode == Instruction::EXTEND ||
+		(left->opcode == Instruction::LOAD && left->size == 1))
+	    return left;
+
+	break;
+
+    default:
+	break;
+    }
+
+    return nullptr;
+}
+
+
+/*
+ * Function:	propagate (private)
+ *
+ * Description:	Propagate copies and constants through a procedure,
+ *		replacing each instruction whose value is known with that
+ *		value.  The blocks are visited in reverse postorder, so an
+ *		instruction is folded only after its operands have been,
+ *		except for the values carried around loops.
+ */
+
+static bool propagate(Procedure &proc)
+{
+    Replacements replacements;
+    Replacements::iterator it;
+    Instruction *value;
+
+
+    for (auto block : proc.blocks)
+	for (auto instruction : block->instructions) {
+	    for (auto &operand : instruction->operands)
+		while ((it = replacements.find(operand)) != replacements.end())
+		    operand = it->second;
+
+	    if ((value = fold(proc, instruction)) != nullptr)
+		replacements[instruction] = value;
+	}
+
+    proc.replace(replacements);
+    return !replacements.empty();
+}
+
+
+/*
+ * Function:	eliminate (private)
+ *
+ * Description:	Remove the instructions whose values are never used.  The
+ *		instructions with effects are live, as is everything they
+ *		use, directly or not, and the rest are removed.  A load has
+ *		no effect, and neither does a phi, so values carried around
+ *		a loop but never used are removed too.
+ */
+
+static bool eliminate(Procedure &proc)
+{
+    vector<Instruction *> work;
+    set<Instruction *> live;
+    bool changed = false;
+
+
+    for (auto block : proc.blocks)
+	for (auto instruction : block->instructions)
+	    if (!instruction->pure() && instruction->opcode != Instruction::LOAD
+		    && instruction->opcode != Instruction::PHI)
+		if (live.insert(instruction).second)
+		    work.push_back(instruction);
+
+    while (!work.empty()) {
+	Instruction *instruction = work.back();
+	work.pop_back();
+
+	for (auto operand : instruction->operands)
+	    if (!operand->constant() && live.insert(operand).second)
+		work.push_back(operand);
+    }
+
+    for (auto block : proc.blocks) {
+	vector<Instruction *> kept;
+
+	for (auto instruction : block->instructions)
+	    if (live.count(instruction) > 0)
+		kept.push_back(instruction);
+	    else
+		changed = true;
+
+	block->instructions = kept;
+    }
+
+    return changed;
+}
+
+
+/*
+ * Function:	identify (private)
+ *
+ * Description:	Return a string that identifies the value of an operand.
+ *		Constants are identified by what they are, and any other
+ *		instruction by its number.
+ */
+
+static string identify(const Instruction *operand)
+{
+    unsigned long long bits;
+    stringstream ss;
+
+
+    switch (operand->opcode) {
+    case Instruction::CONST:
+	ss << "$" << operand->value;
+	break;
+
+    case Instruction::FCONST:
+	memcpy(&bits, &operand->real, sizeof(bits));
+	ss << "#" << hex << bits;
+	break;
+
+    case Instruction::STRING:
+	ss << "\"" << operand->text;
+	break;
+
+    case Instruction::GLOBAL:
+    case Instruction::FRAME:
+	ss << (operand->opcode == Instruction::GLOBAL ? "@" : "&");
+	ss << (const void *) operand->symbol;
+	break;
+
+    default:
+	ss << "%" << operand->number;
+    }
+
+    return ss.str();
+}
+
+
+/*
+ * Function:	express (private)
+ *
+ * Description:	Return a string that identifies the value computed by a
+ *		pure instruction, so that two instructions with the same
+ *		expression compute the same value.  The operands of a
+ *		commutative operation are put in a standard order.
+ */
+
+static string express(const Instruction *instruction)
+{
+    vector<string> operands;
+    stringstream ss;
+
+
+    for (auto operand : instruction->operands)
+	operands.push_back(identify(operand));
+
+    if (instruction->opcode == Instruction::ADD ||
+	    instruction->opcode == Instruction::MUL)
+	sort(operands.begin(), operands.end());
+
+    ss << instruction->opcode << ":" << instruction->kind << ":";
+    ss << instruction->size << ":" << instruction->condition;
+
+    for (auto &operand : operands)
+	ss << " " << operand;
+
+    return ss.str();
+}
+
+
+/*
+ * Function:	locate (private)
+ *
+ * Description:	Find the base and the constant offset of an address.  The
+ *		base is a variable, or failing that, the instruction to
+ *		which the offset is added.
+ */
+
+static const Instruction *locate(const Instruction *address, int &offset)
+{
+    offset = 0;
+
+    while (address->opcode == Instruction::ADD &&
+	    address->kind == Instruction::PTR) {
+	if (address->operands[1]->opcode == Instruction::CONST) {
+	    offset += address->operands[1]->value;
+	    address = address->operands[0];
+	} else if (address->operands[0]->opcode == Instruction::CONST) {
+	    offset += address->operands[0]->value;
+	    address = address->operands[1];
+	} else
+	    break;
+    }
+
+    return address;
+}
+
+
+/*
+ * The variables into which addresses point, and the variables whose
+ * addresses escape.  The address of a local variable escapes unless it
+ * is only used to load, to store, or to compute other addresses, and
+ * only then can we know that no other pointer, and no function called,
+ * reaches the variable.  Every global variable escapes.
+ */
+
+struct Aliases {
+    map<const Instruction *, const Symbol *> roots;
+    set<const Symbol *> escaped;
+};
+
+
+/*
+ * Function:	trace (private)
+ *
+ * Description:	Find the aliases of a procedure.  The blocks are visited
+ *		in reverse postorder, so an address is traced before it is
+ *		used, except by a phi, from which the variable escapes.
+ */
+
+static void trace(Procedure &proc, Aliases &aliases)
+{
+    const Symbol *symbol;
+    Instruction *operand;
+
+
+    for (auto block : proc.blocks)
+	for (auto instruction : block->instructions)
+	    for (unsigned i = 0; i < instruction->operands.size(); i ++) {
+		operand = instruction->operands[i];
+
+		if (operand->opcode == Instruction::GLOBAL) {
+		    aliases.escaped.insert(operand->symbol);
+		    symbol = operand->symbol;
+		} else if (operand->opcode == Instruction::FRAME)
+		    symbol = operand->symbol;
+		else if (aliases.roots.count(operand) > 0)
+		    symbol = aliases.roots[operand];
+		else
+		    continue;
+
+		if (i == 0 && (instruction->opcode == Instruction::LOAD ||
+			instruction->opcode == Instruction::STORE))
+		    continue;
+
+		if ((instruction->opcode == Instruction::ADD ||
+			instruction->opcode == Instruction::SUB) &&
+			instruction->kind == Instruction::PTR)
+		    aliases.roots[instruction] = symbol;
+		else
+		    aliases.escaped.insert(symbol);
+	    }
+}
+
+
+/*
+ * Function:	root (private)
+ *
+ * Description:	Return the variable into which an access to memory
+ *		points, or null if it is unknown.
+ */
+
+static const Symbol *root(const Aliases &aliases, const Instruction *access)
+{
+    const Instruction *address = access->operands[0];
+    auto it = aliases.roots.find(address);
+
+
+    if (address->opcode == Instruction::GLOBAL ||
+	    address->opcode == Instruction::FRAME)
+	return address->symbol;
+
+    return it != aliases.roots.end() ? it->second : nullptr;
+}
+
+
+/*
+ * Function:	clobbered (private)
+ *
+ * Description:	Return whether a function called may change the memory
+ *		accessed.
+ */
+
+static bool clobbered(const Aliases &aliases, const Instruction *access)
+{
+    const Symbol *symbol = root(aliases, access);
+
+    return symbol == nullptr || aliases.escaped.count(symbol) > 0;
+}
+
+
+/*
+ * Function:	disjoint (private)
+ *
+ * Description:	Return whether two accesses to memory are known not to
+ *		overlap.  They do not if they are to different bytes from
+ *		the same base, or into different variables, or if one is
+ *		into a variable whose address does not escape and the
+ *		other is not into that variable.
+ */
+
+static bool disjoint(const Aliases &aliases, const Instruction *first,
+		     const Instruction *second)
+{
+    const Symbol *left, *right;
+    int x, y;
+
+
+    if (identify(locate(first->operands[0], x)) ==
+	    identify(locate(second->operands[0], y)))
+	return x + (int) first->size <= y || y + (int) second->size <= x;
+
+    left = root(aliases, first);
+    right = root(aliases, second);
+
+    if (left != nullptr && right != nullptr)
+	return left != right;
+
+    if (left != nullptr)
+	return aliases.escaped.count(left) == 0;
+
+    if (right != nullptr)
+	return aliases.escaped.count(right) == 0;
+
+    return false;
+}
+
+
+/*
+ * Function:	number (private)
+ *
+ * Description:	Number the values in a block and the blocks it dominates,
+ *		recording in the replacements each instruction that
+ *		computes a value already available.  The values of pure
+ *		instructions in a block are available in every block it
+ *		dominates.  The contents of memory, as known from loads
+ *		and stores, are only carried into a block whose only
+ *		predecessor is this block; a store forgets the contents it
+ *		may overwrite, and a call those it may change.  A load of a
+ *		location just stored to has the stored value, if the whole
+ *		value is loaded.
+ */
+
+typedef map<BasicBlock *, vector<BasicBlock *>> Children;
+
+static void number(BasicBlock *block, const Children &children,
+		   const Aliases &aliases, map<string, Instruction *> &values,
+		   vector<Instruction *> memory, Replacements &replacements)
+{
+    map<string, Instruction *>::iterator it;
+    Children::const_iterator kt;
+    Replacements::iterator jt;
+    vector<string> added;
+    Instruction *value;
+    string key;
+
+
+    for (auto instruction : block->instructions) {
+	for (auto &operand : instruction->operands)
+	    while ((jt = replacements.find(operand)) != replacements.end())
+		operand = jt->second;
+
+	if (instruction->opcode == Instruction::CALL) {
+	    vector<Instruction *> kept;
+
+	    for (auto access : memory)
+		if (!clobbered(aliases, access))
+		    kept.push_back(access);
+
+	    memory = kept;
+
+	} else if (instruction->opcode == Instruction::STORE) {
+	    vector<Instruction *> kept;
+
+	    for (auto access : memory)
+		if (disjoint(aliases, access, instruction))
+		    kept.push_back(access);
+
+	    kept.push_back(instruction);
+	    memory = kept;
+
+	} else if (instruction->opcode == Instruction::LOAD) {
+	    key = identify(instruction->operands[0]);
+	    value = nullptr;
+
+	    for (auto access : memory) {
+		if (identify(access->operands[0]) != key ||
+			access->size != instruction->size)
+		    continue;
+
+		if (access->opcode == Instruction::LOAD) {
+		    if (access->kind == instruction->kind)
+			value = access;
+
+		} else {
+		    Instruction *stored = access->operands[1];
+
+		    if (stored->kind == instruction->kind &&
+			    access->size == (stored->kind == Instruction::REAL ? 8 : 4))
+			value = stored;
+		}
+	    }
+
+	    if (value != nullptr)
+		replacements[instruction] = value;
+	    else
+		memory.push_back(instruction);
+
+	} else if (instruction->pure() && instruction->opcode != Instruction::COPY) {
+	    key = express(instruction);
+
+	    if ((it = values.find(key)) != values.end())
+		replacements[instruction] = it->second;
+	    else {
+		values[key] = instruction;
+		added.push_back(key);
+	    }
+	}
+    }
+
+    if ((kt = children.find(block)) != children.end())
+	for (auto child : kt->second) {
+	    if (child->predecessors.size() == 1)
+		number(child, children, aliases, values, memory, replacements);
+	    else
+		number(child, children, aliases, values, {}, replacements);
+	}
+
+    for (auto &key : added)
+	values.erase(key);
+}
+
+
+/*
+ * Function:	gvn (private)
+ *
+ * Description:	Remove the redundant computations of a procedure by value
+ *		numbering over its dominator tree.  An instruction that
+ *		computes a value already computed in a dominating block,
+ *		or that loads what is known to be in memory, is replaced.
+ */
+
+static bool gvn(Procedure &proc)
+{
+    map<string, Instruction *> values;
+    Replacements replacements;
+    Children children;
+    Aliases aliases;
+
+
+    trace(proc, aliases);
+
+    for (auto block : proc.blocks)
+	if (block->dominator != nullptr)
+	    children[block->dominator].push_back(block);
+
+    number(proc.blocks[0], children, aliases, values, {}, replacements);
+    proc.replace(replacements);
+    return !replacements.empty();
+}
+
+
+/*
+ * Function:	reduce (private)
+ *
+ * Description:	Reduce the strength of integer multiplications by
+ *		constants, which are mostly the scaling of indices into
+ *		arrays.  The constant is put on the right, and a
+ *		multiplication by a power of two, or by its negation,
+ *		becomes a shift.
+ */
+
+static bool reduce(Procedure &proc)
+{
+    Instruction *instruction, *shifted;
+    unsigned shift, magnitude;
+    bool changed = false;
+    int factor;
+
+
+    for (auto block : proc.blocks)
+	for (unsigned i = 0; i < block->instructions.size(); i ++) {
+	    instruction = block->instructions[i];
+
+	    if (instruction->opcode != Instruction::MUL ||
+		    instruction->kind == Instruction::REAL)
+		continue;
+
+	    if (instruction->operands[0]->opcode == Instruction::CONST &&
+		    instruction->operands[1]->opcode != Instruction::CONST) {
+		swap(instruction->operands[0], instruction->operands[1]);
+		changed = true;
+	    }
+
+	    if (instruction->operands[1]->opcode != Instruction::CONST)
+		continue;
+
+	    factor = instruction->operands[1]->value;
+	    magnitude = factor < 0 ? -(unsigned) factor : factor;
+
+	    if (magnitude < 2 || (magnitude & (magnitude - 1)) != 0)
+		continue;
+
+	    for (shift = 0; (1u << shift) != magnitude; shift ++)
+		;
+
+	    if (factor > 0) {
+		instruction->opcode = Instruction::SHL;
+		instruction->operands[1] = proc.constant(shift);
+	    } else {
+		shifted = proc.create(Instruction::SHL, instruction->kind);
+		shifted->operands = {instruction->operands[0], proc.constant(shift)};
+		shifted->block = block;
+		block->instructions.insert(block->instructions.begin() + i, shifted);
+
+		instruction->opcode = Instruction::NEG;
+		instruction->operands = {shifted};
+	    }
+
+	    changed = true;
+	}
+
+    return changed;
+}
+
+
+/*
+ * Function:	safe (private)
+ *
+ * Description:	Return whether a load cannot fault, and so may be done
+ *		even where it would not have been: it is from within a
+ *		variable.
+ */
+
+static bool safe(const Instruction *load)
+{
+    const Instruction *base;
+    int offset;
+
+
+    base = locate(load->operands[0], offset);
+
+    if (base->opcode != Instruction::GLOBAL &&
+	    base->opcode != Instruction::FRAME)
+	return false;
+
+    if (base->symbol->type().isFunction())
+	return false;
+
+    return offset >= 0 && offset + load->size <= base->symbol->type().size();
+}
+
+
+/*
+ * Function:	invariant (private)
+ *
+ * Description:	Return whether the operands of an instruction in a loop
+ *		are the same on every iteration: they are computed outside
+ *		the loop or by instructions already found to be invariant.
+ */
+
+static bool invariant(const Instruction *instruction,
+		      const set<BasicBlock *> &loop,
+		      const set<Instruction *> &invariants)
+{
+    for (auto operand : instruction->operands)
+	if (!operand->constant() && loop.count(operand->block) > 0 &&
+		invariants.count(operand) == 0)
+	    return false;
+
+    return true;
+}
+
+
+/*
+ * Function:	headers (private)
+ *
+ * Description:	Return the headers of the loops of a procedure, which are
+ *		the targets of back edges, with inner loops first.
+ */
+
+static vector<BasicBlock *> headers(Procedure &proc)
+{
+    vector<BasicBlock *> result;
+
+
+    for (auto it = proc.blocks.rbegin(); it != proc.blocks.rend(); ++ it)
+	for (auto pred : (*it)->predecessors)
+	    if ((*it)->dominates(pred)) {
+		result.push_back(*it);
+		break;
+	    }
+
+    return result;
+}
+
+
+/*
+ * Function:	enclose (private)
+ *
+ * Description:	Find the blocks of the loop with the given header, and
+ *		return the only block outside the loop that enters it, or
+ *		null if there is more than one.
+ */
+
+static BasicBlock *enclose(BasicBlock *header, set<BasicBlock *> &loop)
+{
+    vector<BasicBlock *> work, outside;
+
+
+    loop.insert(header);
+
+    for (auto pred : header->predecessors)
+	if (header->dominates(pred))
+	    work.push_back(pred);
+	else
+	    outside.push_back(pred);
+
+    while (!work.empty()) {
+	BasicBlock *block = work.back();
+	work.pop_back();
+
+	if (loop.insert(block).second)
+	    for (auto pred : block->predecessors)
+		work.push_back(pred);
+    }
+
+    return outside.size() == 1 ? outside[0] : nullptr;
+}
+
+
+/*
+ * Function:	licm (private)
+ *
+ * Description:	Hoist the computations that are the same on every
+ *		iteration of a loop into its preheader, the only block
+ *		outside the loop that enters it, which is created if that
+ *		block may go elsewhere.  Each loop is found from the back
+ *		edges to its header, and inner loops are visited first so
+ *		that what is hoisted from one may be hoisted again from the
+ *		loop around it.  A pure instruction is hoisted unless it
+ *		might trap.  A load is hoisted if nothing in the loop may
+ *		change what it loads, and if it is in the header, which
+ *		runs whenever the preheader does, or cannot fault.
+ */
+
+static bool licm(Procedure &proc)
+{
+    bool changed = false;
+    Aliases aliases;
+
+
+    trace(proc, aliases);
+
+    for (auto header : headers(proc)) {
+	vector<Instruction *> stores, hoisted;
+	set<Instruction *> invariants;
+	set<BasicBlock *> loop;
+	BasicBlock *entry, *preheader;
+	Instruction *jump;
+	bool calls = false;
+
+
+	/* Find the blocks of the loop and the block that enters it. */
+
+	if ((entry = enclose(header, loop)) == nullptr)
+	    continue;
+
+	for (auto block : proc.blocks)
+	    if (loop.count(block) > 0)
+		for (auto instruction : block->instructions) {
+		    if (instruction->opcode == Instruction::CALL)
+			calls = true;
+		    else if (instruction->opcode == Instruction::STORE)
+			stores.push_back(instruction);
+		}
+
+
+	/* Find the invariant instructions, in an order in which they
+	   may be computed. */
+
+	for (auto block : proc.blocks) {
+	    if (loop.count(block) == 0)
+		continue;
+
+	    for (auto instruction : block->instructions) {
+		if (!invariant(instruction, loop, invariants))
+		    continue;
+
+		if (instruction->pure()) {
+		    if ((instruction->opcode == Instruction::DIV ||
+			    instruction->opcode == Instruction::REM) &&
+			    (instruction->operands[1]->opcode != Instruction::CONST ||
+			    is(instruction->operands[1], 0) ||
+			    is(instruction->operands[1], -1)))
+			continue;
+
+		} else if (instruction->opcode == Instruction::LOAD) {
+		    if (block != header && !safe(instruction))
+			continue;
+
+		    if (calls && clobbered(aliases, instruction))
+			continue;
+
+		    if (any_of(stores.begin(), stores.end(),
+			    [&](const Instruction *store) {
+				return !disjoint(aliases, instruction, store);
+			    }))
+			continue;
+
+		} else
+		    continue;
+
+		invariants.insert(instruction);
+		hoisted.push_back(instruction);
+	    }
+	}
+
+	if (hoisted.empty())
+	    continue;
+
+
+	/* Move them into the preheader. */
+
+	for (auto block : loop) {
+	    vector<Instruction *> kept;
+
+	    for (auto instruction : block->instructions)
+		if (invariants.count(instruction) == 0)
+		    kept.push_back(instruction);
+
+	    block->instructions = kept;
+	}
+
+	preheader = entry;
+
+	if (preheader->successors().size() != 1) {
+	    preheader = proc.block();
+	    jump = proc.create(Instruction::JUMP, Instruction::NONE);
+	    jump->blocks = {header};
+	    jump->block = preheader;
+	    preheader->instructions.push_back(jump);
+	    entry->retarget(header, preheader);
+
+	    for (auto phi : header->instructions)
+		if (phi->opcode == Instruction::PHI)
+		    for (auto &from : phi->blocks)
+			if (from == entry)
+			    from = preheader;
+
+	    proc.analyze();
+	}
+
+	for (auto instruction : hoisted)
+	    instruction->block = preheader;
+
+	preheader->instructions.insert(preheader->instructions.end() - 1,
+				       hoisted.begin(), hoisted.end());
+	changed = true;
+    }
+
+    return changed;
+}
+
+
+/*
+ * Function:	linear (private)
+ *
+ * Description:	Find the factor by which a value in a loop changes when an
+ *		induction variable changes by one, if the value is computed
+ *		from the variable and invariants by additions, subtractions,
+ *		negations, and multiplications and shifts by constants.
+ *		The arithmetic wraps, so the value is always the same
+ *		linear function of the variable.
+ */
+
+static bool linear(const Instruction *value, const Instruction *variable,
+		   const set<BasicBlock *> &loop, unsigned &factor)
+{
+    const vector<Instruction *> &operands = value->operands;
+    unsigned left, right;
+
+
+    if (value == variable) {
+	factor = 1;
+	return true;
+    }
+
+    if (value->constant() || loop.count(value->block) == 0) {
+	factor = 0;
+	return true;
+    }
+
+    switch (value->opcode) {
+    case Instruction::ADD:
+    case Instruction::SUB:
+	if (!linear(operands[0], variable, loop, left) ||
+		!linear(operands[1], variable, loop, right))
+	    return false;
+
+	factor = value->opcode == Instruction::ADD ? left + right : left - right;
+	return true;
+
+    case Instruction::NEG:
+	if (!linear(operands[0], variable, loop, left))
+	    return false;
+
+	factor = -left;
+	return true;
+
+    case Instruction::SHL:
+    case Instruction::MUL:
+	if (operands[1]->opcode != Instruction::CONST ||
+		!linear(operands[0], variable, loop, left))
+	    return false;
+
+	if (value->opcode == Instruction::SHL)
+	    factor = left << (operands[1]->value & 31);
+	else
+	    factor = left * operands[1]->value;
+
+	return true;
+
+    default:
+	return false;
+    }
+}
+
+
+/*
+ * Function:	clone (private)
+ *
+ * Description:	Compute a linear function of an induction variable at the
+ *		end of a block outside its loop, for the given value of the
+ *		variable, by copying the instructions that compute it.
+ */
+
+static Instruction *clone(Procedure &proc, Instruction *value,
+			  const Instruction *variable, Instruction *start,
+			  const set<BasicBlock *> &loop, BasicBlock *block,
+			  map<Instruction *, Instruction *> &clones)
+{
+    Instruction *copy;
+
+
+    if (value == variable)
+	return start;
+
+    if (value->constant() || loop.count(value->block) == 0)
+	return value;
+
+    if (clones.count(value) > 0)
+	return clones[value];
+
+    copy = proc.create(value->opcode, value->kind);
+    copy->size = value->size;
+    copy->condition = value->condition;
+
+    for (auto operand : value->operands)
+	copy->operands.push_back(clone(proc, operand, variable, start, loop, block, clones));
+
+    copy->block = block;
+    block->instructions.insert(block->instructions.end() - 1, copy);
+    return clones[value] = copy;
+}
+
+
+/*
+ * Function:	dead (private)
+ *
+ * Description:	Return whether an instruction will be unused once the
+ *		given addresses and the replaced instructions are gone: it
+ *		is one of them, or is pure and only used by such
+ *		instructions.
+ */
+
+static bool dead(Instruction *instruction, const vector<Instruction *> &derived,
+		 const Replacements &replacements,
+		 map<Instruction *, vector<Instruction *>> &users)
+{
+    if (find(derived.begin(), derived.end(), instruction) != derived.end() ||
+	    replacements.count(instruction) > 0)
+	return true;
+
+    if (!instruction->pure())
+	return false;
+
+    for (auto user : users[instruction])
+	if (!dead(user, derived, replacements, users))
+	    return false;
+
+    return true;
+}
+
+
+/*
+ * Function:	near (private)
+ *
+ * Description:	Return whether an offset is small enough that adding it to
+ *		an address cannot wrap.
+ */
+
+static bool near(long long offset)
+{
+    return offset > -(1 << 28) && offset < 1 << 28;
+}
+
+
+/*
+ * Function:	ivsr (private)
+ *
+ * Description:	Reduce the strength of the addresses computed from the
+ *		induction variables of loops.  An induction variable is
+ *		an integer phi in the header that is incremented or
+ *		decremented by a constant on the back edge.  An address that is a linear
+ *		function of it becomes a pointer of its own, started at
+ *		the function of the initial value and incremented by the
+ *		factor times the step, so that indexing an array becomes a
+ *		pointer increment.  If the variable is then only used to
+ *		decide whether to leave the loop, by comparing it with a
+ *		constant, the test is replaced by one of the pointer, and
+ *		the variable is left for elimination.  The constants keep
+ *		the pointer from wrapping where the variable did not.
+ */
+
+static bool ivsr(Procedure &proc)
+{
+    Replacements replacements;
+    bool changed = false;
+
+
+    for (auto header : headers(proc)) {
+	map<Instruction *, vector<Instruction *>> users;
+	set<BasicBlock *> loop;
+	BasicBlock *entry;
+
+	if ((entry = enclose(header, loop)) == nullptr ||
+		header->predecessors.size() != 2)
+	    continue;
+
+	for (auto block : proc.blocks)
+	    for (auto instruction : block->instructions)
+		for (auto operand : instruction->operands)
+		    users[operand].push_back(instruction);
+
+	for (unsigned i = 0; i < header->instructions.size(); i ++) {
+	    Instruction *variable = header->instructions[i];
+	    Instruction *start, *next, *test, *bound = nullptr, *pointer;
+	    map<Instruction *, Instruction *> starts, bounds;
+	    vector<Instruction *> derived;
+	    unsigned inside, factor;
+	    bool replaceable;
+	    int step;
+
+
+	    /* Find an induction variable. */
+
+	    if (variable->opcode != Instruction::PHI)
+		break;
+
+	    if (variable->kind != Instruction::INT)
+		continue;
+
+	    inside = variable->blocks[0] == entry ? 1 : 0;
+	    start = variable->operands[1 - inside];
+	    next = variable->operands[inside];
+
+	    if (next->opcode == Instruction::ADD &&
+		    next->operands[0]->opcode == Instruction::CONST)
+		swap(next->operands[0], next->operands[1]);
+
+	    if ((next->opcode != Instruction::ADD &&
+		    next->opcode != Instruction::SUB) ||
+		    next->operands[0] != variable ||
+		    next->operands[1]->opcode != Instruction::CONST)
+		continue;
+
+	    step = next->operands[1]->value;
+
+	    if (next->opcode == Instruction::SUB)
+		step = -(unsigned) step;
+	    test = header->terminator();
+
+	    if (test->opcode == Instruction::BRANCH &&
+		    test->operands[1] == variable) {
+		swap(test->operands[0], test->operands[1]);
+		test->condition = Instruction::swap(test->condition);
+	    }
+
+	    if (test->opcode == Instruction::BRANCH &&
+		    test->operands[0] == variable &&
+		    test->operands[1]->opcode == Instruction::CONST &&
+		    start->opcode == Instruction::CONST)
+		bound = test->operands[1];
+
+
+	    /* Find the addresses derived from it. */
+
+	    for (auto block : proc.blocks)
+		if (loop.count(block) > 0)
+		    for (auto instruction : block->instructions)
+			if (instruction->opcode == Instruction::ADD &&
+				instruction->kind == Instruction::PTR &&
+				replacements.count(instruction) == 0 &&
+				linear(instruction, variable, loop, factor) &&
+				factor != 0)
+			    derived.push_back(instruction);
+
+	    replaceable = bound != nullptr;
+
+	    for (auto user : users[variable])
+		if (user != next && user != test && !dead(user, derived, replacements, users))
+		    replaceable = false;
+
+	    for (auto user : users[next])
+		if (user != variable && !dead(user, derived, replacements, users))
+		    replaceable = false;
+
+
+	    /* Replace each by a pointer of its own. */
+
+	    for (auto address : derived) {
+		linear(address, variable, loop, factor);
+
+		pointer = proc.create(Instruction::PHI, address->kind);
+		pointer->block = header;
+		pointer->blocks = variable->blocks;
+		pointer->operands.resize(2);
+		pointer->operands[1 - inside] =
+		    clone(proc, address, variable, start, loop, entry, starts);
+
+		pointer->operands[inside] = proc.create(Instruction::ADD, address->kind);
+		pointer->operands[inside]->operands = {pointer, proc.constant(factor * step)};
+		pointer->operands[inside]->block = next->block;
+		next->block->instructions.insert(find(next->block->instructions.begin(),
+			next->block->instructions.end(), next) + 1, pointer->operands[inside]);
+
+		header->instructions.insert(header->instructions.begin(), pointer);
+		replacements[address] = pointer;
+		changed = true;
+		i ++;
+
+
+		/* Test the first pointer instead of the variable if the
+		   variable has no other use, and neither the pointer nor
+		   its bound can be far from its base. */
+
+		if (!replaceable || test->operands[0] != variable ||
+			(int) factor <= 0 ||
+			!near((long long) start->value * (int) factor) ||
+			!near(((long long) bound->value + step) * (int) factor))
+		    continue;
+
+		test->operands[0] = pointer;
+		test->operands[1] = clone(proc, address, variable, bound, loop, entry, bounds);
+	    }
+	}
+    }
+
+    proc.replace(replacements);
+    return changed;
+}
+
+
+/*
+ * The passes, in the order they are run, and the lowest optimization
+ * level at which each is enabled.
+ */
+
+static const Pass passes[] = {
+    {"simplify", 1, simplify},
+    {"propagate", 1, propagate},
+    {"gvn", 1, gvn},
+    {"reduce", 1, reduce},
+    {"licm", 1, licm},
+    {"ivsr", 1, ivsr},
+    {"dce", 1, eliminate},
+};
+
+
+/*
+ * Function:	disablePass
+ *
+ * Description:	Disable the pass with the given name, returning whether
+ *		there is such a pass.
+ */
+
+bool disablePass(const string &name)
+{
+    for (auto &pass : passes)
+	if (name == pass.name) {
+	    disabled.insert(name);
+	    return true;
+	}
+
+    return false;
+}
+
+
+/*
+ * Function:	optimizeProcedure
+ *
+ * Description:	Optimize a procedure by running the enabled passes until
+ *		none of them changes it, up to a limit.
+ */
+
+void optimizeProcedure(Procedure &proc)
+{
+    Timer::Scope timer(Timer::OPTIMIZE, &proc.function->name().str());
+    bool changed = true;
+    unsigned round;
+
+
+    for (round = 0; changed && round < MAX_ROUNDS; round ++) {
+	changed = false;
+
+	for (auto &pass : passes)
+	    if (pass.level <= optimization && !disabled.count(pass.name))
+		changed = pass.run(proc) || changed;
+    }
+
+    if (dumpIR) {
+	stringstream ss;
+
+	proc.write(ss);
+	cerr << ss.str();
+    }
+}
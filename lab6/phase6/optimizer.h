@@ -0,0 +1,22 @@
+/*
+ * File:	optimizer.h
+ *
+ * Description:	This file contains the function declarations for the
+ *		optimizer for Simple C, which transforms the intermediate
+ *		code of each function when the optimization level is
+ *		greater than zero.  Each pass may be disabled by name, and
+ *		the optimized code may be dumped to the standard error.
+ */
+
+# ifndef OPTIMIZER_H
+# define OPTIMIZER_H
+# include <string>
+# include "IR.h"
+
+extern unsigned optimization;
+extern bool dumpIR;
+
+bool disablePass(const std::string &name);
+void optimizeProcedure(Procedure &proc);
+
+# endif /* OPTIMIZER_H */
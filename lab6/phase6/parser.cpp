@@ -6,24 +6,37 @@
  *		Simple C.
  */
 
+# include <cctype>
 # include <cstdlib>
+# include <cstring>
 # include <iostream>
+# include <sstream>
+# include <thread>
 # include "generator.h"
 # include "checker.h"
 # include "string.h"
 # include "tokens.h"
 # include "lexer.h"
+# include "optimizer.h"
+# include "peephole.h"
+# include "Target.h"
+# include "Timer.h"
 # include "Tree.h"
 
 using namespace std;
 
 static Expression *expression();
 static Statement *statement();
-static int lookahead, nexttoken;
-static string lexbuf, nextbuf;
+static int lookahead;
 
 static Type returnType;
 static unsigned loopDepth;
+static Arena *locals = new Arena();
+
+static Digest context;
+static bool hashing;
+static Mentions mentions;
+static string trees;
 
 
 /*
@@ -37,7 +50,7 @@ static void error()
     if (lookahead == DONE)
 	report("syntax error at end of file");
     else
-	report("syntax error at '%s'", yytext);
+	report("syntax error at '%s'", string(yytext, yyleng));
 
     exit(EXIT_FAILURE);
 }
@@ -51,12 +64,7 @@ static void error()
 
 static int peek()
 {
-    if (nexttoken == 0) {
-	nexttoken = yylex();
-	nextbuf = yytext;
-    }
-
-    return nexttoken;
+    return lookAhead(1).kind;
 }
 
 
@@ -65,7 +73,9 @@ static int peek()
  *
  * Description:	Match the next token against the specified token.  A
  *		failure indicates a syntax error and will terminate the
- *		program since our parser does not do error recovery.
+ *		program since our parser does not do error recovery.  While
+ *		caching, each token outside of a function body is added to
+ *		the context in which functions are compiled.
  */
 
 static void match(int t)
@@ -73,14 +83,11 @@ static void match(int t)
     if (lookahead != t)
 	error();
 
-    if (nexttoken != 0) {
-	lookahead = nexttoken;
-	lexbuf = nextbuf;
-	nexttoken = 0;
-    } else {
-	lookahead = yylex();
-	lexbuf = yytext;
-    }
+    if (hashing)
+	context.add(t).add(lookAhead().text, lookAhead().length);
+
+    consume();
+    lookahead = lookAhead().kind;
 }
 
 
@@ -92,10 +99,10 @@ static void match(int t)
 
 static unsigned integer()
 {
-    string buf;
+    const Token &token = lookAhead();
+    string buf(token.text, token.length);
 
 
-    buf = lexbuf;
     match(INTEGER);
     return strtoul(buf.c_str(), NULL, 0);
 }
@@ -107,14 +114,30 @@ static unsigned integer()
  * Description:	Match the next token as an identifier and return its name.
  */
 
-static string identifier()
+static Name identifier()
 {
-    string buf;
+    Name name;
 
 
-    buf = lexbuf;
+    name = lookAhead().name;
     match(ID);
-    return buf;
+    mentions.insert(name);
+    return name;
+}
+
+
+/*
+ * Function:	closeFunction
+ *
+ * Description:	Release everything allocated for a function, which begins
+ *		with its parameter scope, and resume allocating from the
+ *		global arena.
+ */
+
+static void closeFunction()
+{
+    Arena::current = &Arena::global;
+    locals->reset();
 }
 
 
@@ -124,21 +147,14 @@ static string identifier()
  * Description:	Close the current scope, which should be the parameter
  *		scope of a function declaration.  Only the types, and not
  *		the symbols, need to saved as part of the declaration, so
- *		when the scope is closed, we can safely delete the scope
+ *		when the scope is closed, we can safely release the scope
  *		and its symbols.
  */
 
 static void closeParamScope()
 {
-    Scope *scope;
-
-
-    scope = closeScope();
-
-    for (auto symbol : scope->symbols())
-	delete symbol;
-
-    delete scope;
+    closeScope();
+    closeFunction();
 }
 
 
@@ -219,7 +235,7 @@ static unsigned pointers()
 static void declarator(int typespec)
 {
     unsigned indirection;
-    string name;
+    Name name;
 
 
     indirection = pointers();
@@ -315,21 +331,21 @@ static Expression *primaryExpression()
 	match(')');
 
     } else if (lookahead == CHARACTER) {
-	lexbuf = lexbuf.substr(1, lexbuf.size() - 2);
-	expr = new Integer(parseString(lexbuf)[0]);
+	const Token &token = lookAhead();
+	expr = new Integer(parseString(string(token.text + 1, token.length - 2))[0]);
 	match(CHARACTER);
 
     } else if (lookahead == STRING) {
-	lexbuf = lexbuf.substr(1, lexbuf.size() - 2);
-	expr = new String(parseString(lexbuf));
+	const Token &token = lookAhead();
+	expr = new String(parseString(string(token.text + 1, token.length - 2)));
 	match(STRING);
 
     } else if (lookahead == INTEGER) {
-	expr = new Integer(lexbuf);
-	match(INTEGER);
+	expr = new Integer(integer());
 
     } else if (lookahead == REAL) {
-	expr = new Real(lexbuf);
+	const Token &token = lookAhead();
+	expr = new Real(strtod(string(token.text, token.length).c_str(), NULL));
 	match(REAL);
 
     } else if (lookahead == ID) {
@@ -877,7 +893,7 @@ static Type parameter()
 {
     int typespec;
     unsigned indirection;
-    string name;
+    Name name;
     Type type;
 
 
@@ -895,7 +911,11 @@ static Type parameter()
  * Function:	parameters
  *
  * Description:	Parse the parameters of a function, but not the opening or
- *		closing parentheses.
+ *		closing parentheses.  The parameter scope, and anything
+ *		allocated after it until the function is closed, comes
+ *		from the arena for function bodies.  The parameter list
+ *		itself is returned by value, and is copied into the table
+ *		of types only if the function type is new.
  *
  *		parameters:
  *		  void
@@ -903,31 +923,31 @@ static Type parameter()
  *		  parameter-list , ...
  */
 
-static Parameters *parameters()
+static Parameters parameters()
 {
-    Parameters *params;
+    Parameters params;
 
 
+    Arena::current = locals;
     openScope();
-    params = new Parameters;
-    params->variadic = false;
+    params.variadic = false;
 
     if (lookahead == VOID)
 	match(VOID);
 
     else {
-	params->types.push_back(parameter());
+	params.types.push_back(parameter());
 
 	while (lookahead == ',') {
 	    match(',');
 
 	    if (lookahead == ELLIPSIS) {
-		params->variadic = true;
+		params.variadic = true;
 		match(ELLIPSIS);
 		break;
 	    }
 
-	    params->types.push_back(parameter());
+	    params.types.push_back(parameter());
 	}
     }
 
@@ -951,7 +971,7 @@ static Parameters *parameters()
 static void globalDeclarator(int typespec)
 {
     unsigned indirection;
-    string name;
+    Name name;
 
 
     indirection = pointers();
@@ -994,6 +1014,99 @@ static void remainingDeclarators(int typespec)
 }
 
 
+/*
+ * Function:	writeTree
+ *
+ * Description:	Write the tree of a function to the standard error, and
+ *		keep it for the cache so that a cached compilation writes
+ *		the same trees.
+ */
+
+static void writeTree(const string &tree)
+{
+    cerr << tree;
+
+    if (cache.enabled())
+	trees += tree;
+}
+
+
+/*
+ * Function:	cachedBody
+ *
+ * Description:	Try to use the cached code for the body of the function
+ *		being defined, whose key combines every token outside of a
+ *		function body so far with the tokens of the body.  If the
+ *		code is cached, the body is skipped without being checked,
+ *		and the tree stored with the code is written instead.
+ *		Otherwise, the key is left for storing the code once the
+ *		function has been generated.  Any errors in the tokens of
+ *		the body are only reported as the body is parsed.
+ */
+
+static bool cachedBody(const Name &name, Digest &key)
+{
+    unsigned n = 0, depth = 0;
+    string tree;
+
+
+    key = context;
+
+    do {
+	const Token &token = scanAhead(n ++);
+
+	if (token.kind == DONE)
+	    return false;
+
+	key.add(token.kind).add(token.text, token.length);
+	depth += (token.kind == '{') - (token.kind == '}');
+
+	if (token.kind == ID)
+	    mentions.insert(token.name);
+    } while (depth > 0);
+
+    if (numerrors > 0 || !cache.fetch(Digest(key).add("tree"), tree))
+	return false;
+
+    if (!generateCached(name, mentions, key))
+	return false;
+
+    while (n -- > 0)
+	consume();
+
+    writeTree(tree);
+
+    lookahead = lookAhead().kind;
+    closeParamScope();
+    return true;
+}
+
+
+/*
+ * Function:	functionBody
+ *
+ * Description:	Parse the body of the function being defined, and return
+ *		the function.  The time spent is charged to the function.
+ */
+
+static Function *functionBody(Symbol *symbol)
+{
+    Timer::Scope timer(Timer::PARSE, &symbol->name().str());
+    Statements stmts;
+    Function *function;
+    Scope *decls;
+
+
+    match('{');
+    declarations();
+    stmts = statements();
+    decls = closeScope();
+    function = new Function(symbol, new Block(decls, stmts));
+    match('}');
+    return function;
+}
+
+
 /*
  * Function:	topLevelDeclaration
  *
@@ -1010,12 +1123,11 @@ static void topLevelDeclaration()
 {
     int typespec;
     unsigned indirection;
-    Parameters *params;
-    string name;
-    Statements stmts;
+    Parameters params;
+    Name name;
     Function *function;
     Symbol *symbol;
-    Scope *decls;
+    Digest key;
 
 
     typespec = specifier();
@@ -1036,17 +1148,30 @@ static void topLevelDeclaration()
 	if (lookahead == '{') {
 	    returnType = Type(typespec, indirection);
 	    symbol = defineFunction(name, Type(typespec, indirection, params));
-	    match('{');
-	    declarations();
-	    stmts = statements();
-	    decls = closeScope();
-	    function = new Function(symbol, new Block(decls, stmts));
-	    match('}');
-
-	    if (numerrors == 0){
-      function->write(cerr);
-      function->generate();
-  }
+	    mentions.clear();
+
+	    if (hashing && cachedBody(name, key))
+		return;
+
+	    hashing = false;
+	    function = functionBody(symbol);
+	    hashing = cache.enabled();
+
+	    if (numerrors == 0) {
+		ostringstream tree;
+
+		function->write(tree);
+		writeTree(tree.str());
+
+		if (hashing)
+		    cache.store(Digest(key).add("tree"), tree.str());
+
+		Arena::current = &Arena::global;
+		generateFunction(function, name, mentions, locals,
+				 hashing ? &key : nullptr);
+		locals = new Arena();
+	    } else
+		closeFunction();
 
 	} else {
 	    closeParamScope();
@@ -1062,19 +1187,179 @@ static void topLevelDeclaration()
 
 
 /*
- * Function:	main
+ * Function:	translationUnit
  *
- * Description:	Analyze the standard input stream.
+ * Description:	Parse the entire input, and return the global scope.
  */
 
-int main()
+static Scope *translationUnit()
 {
+    Timer::Scope timer(Timer::PARSE);
+
+
     openScope();
-    lookahead = yylex();
+    lookahead = lookAhead().kind;
 
     while (lookahead != DONE)
 	topLevelDeclaration();
 
-    generateGlobals(closeScope());
+    return closeScope();
+}
+
+
+/*
+ * Function:	main
+ *
+ * Description:	Analyze the standard input stream.  The -fno-regalloc
+ *		option keeps every expression temporary in its own stack
+ *		slot instead of in a register, the -fverbose-asm option
+ *		annotates the generated code with debugging comments, and
+ *		the -jN option generates N functions at once (by default,
+ *		one for each processor).  The -fcache=DIR option caches the
+ *		code for the whole input, and for each function, in DIR;
+ *		it is ignored with -fpeephole-stats or -fdump-ir, whose
+ *		output is only written as the code is generated.  The
+ *		-ftime-report option writes the time spent in each
+ *		phase of the compiler to the standard error, and the
+ *		-ftrace=FILE option writes the phases of each function as
+ *		trace events to FILE.  The -m64 option generates code for
+ *		x86-64 instead of i386 (-m32).  The -mfpmath=sse option does
+ *		floating-point arithmetic with SSE2 instead of on the x87
+ *		stack (-mfpmath=387); SSE2 is the default on x86-64.  The
+ *		-fno-peephole option turns off the peephole optimizer, and
+ *		-fpeephole-stats writes how often each of its rules was
+ *		applied to the standard error.  The -O option (or -O1)
+ *		generates i386 code through the optimizer, -O0 (the
+ *		default) does not, -fdisable=PASS turns off one of its
+ *		passes, and -fdump-ir writes the optimized intermediate
+ *		code to the standard error.  The optimizer only selects
+ *		i386 instructions, so -O1 is rejected with -m64.  The
+ *		-fwhole-program option drops the functions and variables
+ *		that main never uses.
+ */
+
+int main(int argc, char *argv[])
+{
+    string directory, disabled, fpmath, options, text, trace;
+    bool report = false, stats = false;
+    Digest key;
+
+
+    jobs = thread::hardware_concurrency();
+
+    for (int i = 1; i < argc; i ++)
+	if (strcmp(argv[i], "-fno-regalloc") == 0)
+	    regalloc = false;
+	else if (strcmp(argv[i], "-fno-peephole") == 0)
+	    peephole = false;
+	else if (strcmp(argv[i], "-fpeephole-stats") == 0)
+	    stats = true;
+	else if (strcmp(argv[i], "-O") == 0)
+	    optimization = 1;
+	else if (strncmp(argv[i], "-O", 2) == 0 && isdigit(argv[i][2])
+		&& argv[i][3] == '\0')
+	    optimization = argv[i][2] - '0';
+	else if (strncmp(argv[i], "-fdisable=", 10) == 0 &&
+		disablePass(argv[i] + 10))
+	    disabled += string(" no-") + (argv[i] + 10);
+	else if (strcmp(argv[i], "-fdump-ir") == 0)
+	    dumpIR = true;
+	else if (strcmp(argv[i], "-fwhole-program") == 0)
+	    wholeProgram = true;
+	else if (strcmp(argv[i], "-fverbose-asm") == 0)
+	    output.comments(true);
+	else if (strncmp(argv[i], "-fcache=", 8) == 0 && argv[i][8] != '\0')
+	    directory = argv[i] + 8;
+	else if (strcmp(argv[i], "-ftime-report") == 0)
+	    report = true;
+	else if (strncmp(argv[i], "-ftrace=", 8) == 0 && argv[i][8] != '\0')
+	    trace = argv[i] + 8;
+	else if (strncmp(argv[i], "-j", 2) == 0 && atoi(argv[i] + 2) > 0)
+	    jobs = atoi(argv[i] + 2);
+	else if (strcmp(argv[i], "-m32") == 0)
+	    target = &Target::i386;
+	else if (strcmp(argv[i], "-m64") == 0)
+	    target = &Target::x86_64;
+	else if (strcmp(argv[i], "-mfpmath=sse") == 0)
+	    fpmath = "sse";
+	else if (strcmp(argv[i], "-mfpmath=387") == 0)
+	    fpmath = "387";
+	else {
+	    cerr << "usage: " << argv[0];
+	    cerr << " [-fno-regalloc] [-fno-peephole] [-fpeephole-stats]";
+	    cerr << " [-O0|-O|-O1 (-m32 only)] [-fdisable=PASS] [-fdump-ir]";
+	    cerr << " [-fwhole-program]";
+	    cerr << " [-fverbose-asm] [-fcache=DIR]";
+	    cerr << " [-ftime-report] [-ftrace=FILE] [-jN] [-m32|-m64]";
+	    cerr << " [-mfpmath=sse|387]" << endl;
+	    exit(EXIT_FAILURE);
+	}
+
+    if (jobs == 0)
+	jobs = 1;
+
+    if (optimization > 0 && target == &Target::x86_64) {
+	cerr << argv[0] << ": -O" << optimization;
+	cerr << " is not supported with -m64" << endl;
+	exit(EXIT_FAILURE);
+    }
+
+    if (fpmath.empty())
+	sse = target == &Target::x86_64;
+    else
+	sse = fpmath == "sse";
+
+    Timer::start(report, trace);
+
+    if (!directory.empty() && !stats && !dumpIR) {
+	options = regalloc ? "regalloc" : "no-regalloc";
+	options += output.comments() ? " verbose-asm" : "";
+	options += string(" ") + target->name;
+	options += sse ? " sse" : " 387";
+	options += peephole ? " peephole" : "";
+	options += " O" + to_string(optimization) + disabled;
+	options += wholeProgram ? " whole-program" : "";
+	cache.open(directory, options);
+    }
+
+    if (cache.enabled()) {
+	fingerprint(key);
+
+	if (cache.fetch(key, text) &&
+		cache.fetch(Digest(key).add("trees"), trees)) {
+	    cerr << trees;
+	    output << text;
+	    Timer::finish();
+
+	    if (stats)
+		reportRules(cerr);
+
+	    exit(EXIT_SUCCESS);
+	}
+
+	trees.clear();
+	output.hold();
+	hashing = true;
+    }
+
+    generateGlobals(translationUnit());
+
+    if (cache.enabled()) {
+	text = output.take();
+
+	if (numerrors == 0) {
+	    cache.store(Digest(key).add("trees"), trees);
+	    cache.store(key, text);
+	}
+
+	output << text;
+	output.release();
+    }
+
+    Timer::finish();
+
+    if (stats)
+	reportRules(cerr);
+
     exit(EXIT_SUCCESS);
 }
@@ -0,0 +1,880 @@
+/*
+ * File:	peephole.cpp
+ *
+ * Description:	This file contains the public and private function
+ *		definitions for the peephole optimizer for Simple C.
+ *
+ *		The code of a function is split into a list of lines, and
+ *		each line that is an instruction into its opcode and
+ *		operands.  Every rule in the table is then tried at every
+ *		instruction, and the whole list is swept again until no
+ *		rule applies.  A rule looks at an instruction and those
+ *		that follow it in the same straight-line code; comments
+ *		are skipped over, but labels and directives end it.  Lines
+ *		that no rule changes are written back exactly as they were.
+ *
+ *		Some rules replace an instruction with a shorter one that
+ *		sets the flags differently, and are only applied if the
+ *		flags are written again before anything reads them.  The
+ *		generator never leaves the flags live across a label, but
+ *		the optimizer does not rely on it and follows jumps.
+ *
+ *		The number of times each rule is applied is counted for
+ *		all functions, which may be optimized on several threads.
+ */
+
+# include <atomic>
+# include <cctype>
+# include <iomanip>
+# include <map>
+# include <set>
+# include <sstream>
+# include <vector>
+# include "peephole.h"
+# include "Timer.h"
+
+using namespace std;
+
+enum Kind {
+    INSTRUCTION, LABEL, DIRECTIVE, COMMENT
+};
+
+struct Line {
+    Kind kind;
+    string text;
+    string opcode;
+    vector<string> operands;
+    bool deleted, changed;
+};
+
+struct Code {
+    vector<Line> lines;
+    map<string, size_t> labels;
+    map<string, unsigned> uses;
+};
+
+struct Rule {
+    const char *name;
+    bool (*apply)(Code &code, size_t i);
+};
+
+static const unsigned MAX_PASSES = 16;
+static const unsigned MAX_JUMPS = 4;
+
+
+/*
+ * Function:	trim (private)
+ *
+ * Description:	Return the given text without leading and trailing blanks.
+ */
+
+static string trim(const string &text)
+{
+    size_t first, last;
+
+
+    first = text.find_first_not_of(" \t");
+
+    if (first == string::npos)
+	return "";
+
+    last = text.find_last_not_of(" \t");
+    return text.substr(first, last - first + 1);
+}
+
+
+/*
+ * Function:	parse (private)
+ *
+ * Description:	Classify a line of code, splitting an instruction into its
+ *		opcode and its operands.  Commas within parentheses do not
+ *		separate operands.
+ */
+
+static Line parse(const string &text)
+{
+    Line line;
+    string rest, operand;
+    size_t end;
+    int depth;
+
+
+    line.text = text;
+    line.deleted = line.changed = false;
+
+    if (trim(text).empty() || trim(text)[0] == '#')
+	line.kind = COMMENT;
+
+    else if (text[0] != '\t') {
+	line.kind = trim(text).back() == ':' ? LABEL : DIRECTIVE;
+	line.opcode = trim(text);
+
+	if (line.kind == LABEL)
+	    line.opcode.pop_back();
+
+    } else if (text[1] == '.')
+	line.kind = DIRECTIVE;
+
+    else {
+	line.kind = INSTRUCTION;
+	end = text.find_first_of(" \t", 1);
+	line.opcode = text.substr(1, end - 1);
+	rest = end == string::npos ? "" : trim(text.substr(end));
+	depth = 0;
+
+	for (auto c : rest) {
+	    if (c == ',' && depth == 0) {
+		line.operands.push_back(trim(operand));
+		operand.clear();
+		continue;
+	    }
+
+	    depth += (c == '(') - (c == ')');
+	    operand += c;
+	}
+
+	if (!trim(operand).empty())
+	    line.operands.push_back(trim(operand));
+    }
+
+    return line;
+}
+
+
+/*
+ * Function:	write (private)
+ *
+ * Description:	Return the text of a line, rebuilding it if it has been
+ *		changed.
+ */
+
+static string write(const Line &line)
+{
+    string text;
+
+
+    if (!line.changed)
+	return line.text;
+
+    text = "\t" + line.opcode;
+
+    for (unsigned i = 0; i < line.operands.size(); i ++)
+	text += (i == 0 ? "\t" : ", ") + line.operands[i];
+
+    return text;
+}
+
+
+/*
+ * Function:	erase (private)
+ *
+ * Description:	Delete a line.
+ */
+
+static void erase(Line &line)
+{
+    line.deleted = true;
+}
+
+
+/*
+ * Function:	rewrite (private)
+ *
+ * Description:	Replace an instruction with another.
+ */
+
+static void rewrite(Line &line, const string &opcode,
+		    const vector<string> &operands)
+{
+    line.opcode = opcode;
+    line.operands = operands;
+    line.changed = true;
+}
+
+
+/*
+ * Function:	next (private)
+ *
+ * Description:	Return the index of the line that follows the given one,
+ *		skipping deleted lines and comments.
+ */
+
+static size_t next(const Code &code, size_t i)
+{
+    for (i ++; i < code.lines.size(); i ++)
+	if (!code.lines[i].deleted && code.lines[i].kind != COMMENT)
+	    break;
+
+    return i;
+}
+
+
+/*
+ * Function:	instruction (private)
+ *
+ * Description:	Return the index of the first instruction at or after the
+ *		given line, skipping labels, or the end if a directive
+ *		comes first.
+ */
+
+static size_t instruction(const Code &code, size_t i)
+{
+    if (i < code.lines.size() && (code.lines[i].deleted
+	    || code.lines[i].kind == COMMENT || code.lines[i].kind == LABEL))
+	i = next(code, i);
+
+    while (i < code.lines.size() && code.lines[i].kind == LABEL)
+	i = next(code, i);
+
+    if (i < code.lines.size() && code.lines[i].kind != INSTRUCTION)
+	return code.lines.size();
+
+    return i;
+}
+
+
+/*
+ * Function:	is (private)
+ *
+ * Description:	Return whether a line is an undeleted instruction with the
+ *		given opcode and number of operands.
+ */
+
+static bool is(const Code &code, size_t i, const string &opcode,
+	       unsigned count)
+{
+    if (i >= code.lines.size())
+	return false;
+
+    const Line &line = code.lines[i];
+    return line.kind == INSTRUCTION && line.opcode == opcode
+	&& line.operands.size() == count;
+}
+
+
+/*
+ * Function:	isRegister (private)
+ *
+ * Description:	Return whether an operand is a register.
+ */
+
+static bool isRegister(const string &operand)
+{
+    return !operand.empty() && operand[0] == '%';
+}
+
+
+/*
+ * Function:	family (private)
+ *
+ * Description:	Return the name of the widest register that includes the
+ *		given one, without the leading %, so that %eax and %rax, or
+ *		%r8d and %r8, are recognized as the same register.
+ */
+
+static string family(const string &reg)
+{
+    string name = reg.substr(1);
+
+
+    if (name.size() > 1 && name[0] == 'r' && isdigit(name[1])) {
+	while (!isdigit(name.back()))
+	    name.pop_back();
+
+	return name;
+    }
+
+    if (name.size() == 3 && (name[0] == 'e' || name[0] == 'r'))
+	return name.substr(1);
+
+    return name;
+}
+
+
+/*
+ * Function:	mentions (private)
+ *
+ * Description:	Return whether an operand uses the given register, either
+ *		as itself or in an address.
+ */
+
+static bool mentions(const string &operand, const string &reg)
+{
+    size_t start, end;
+
+
+    for (start = operand.find('%'); start != string::npos;
+	    start = operand.find('%', end)) {
+	end = operand.find_first_not_of("abcdefghijklmnopqrstuvwxyz0123456789",
+					start + 1);
+
+	if (family(operand.substr(start, end - start)) == family(reg))
+	    return true;
+    }
+
+    return false;
+}
+
+
+/*
+ * Function:	isJump (private)
+ *
+ * Description:	Return whether an opcode is a jump, and optionally whether
+ *		it is a conditional one.
+ */
+
+static bool isJump(const string &opcode, bool conditional = false)
+{
+    if (opcode.empty() || opcode[0] != 'j')
+	return false;
+
+    return !conditional || opcode != "jmp";
+}
+
+
+/*
+ * Function:	isMove (private)
+ *
+ * Description:	Return whether an opcode copies its first operand to its
+ *		second unchanged.
+ */
+
+static bool isMove(const string &opcode)
+{
+    return opcode == "movl" || opcode == "movq" || opcode == "movsd"
+	|| opcode == "movapd";
+}
+
+
+/*
+ * Function:	readsFlags (private)
+ *
+ * Description:	Return whether an instruction reads the flags.
+ */
+
+static bool readsFlags(const string &opcode)
+{
+    return isJump(opcode, true) || opcode.compare(0, 3, "set") == 0
+	|| opcode.compare(0, 4, "cmov") == 0 || opcode.compare(0, 3, "adc") == 0
+	|| opcode.compare(0, 3, "sbb") == 0 || opcode == "lahf";
+}
+
+
+/*
+ * Function:	writesFlags (private)
+ *
+ * Description:	Return whether an instruction sets all of the flags that
+ *		any instruction we generate might read, without reading
+ *		them first.
+ */
+
+static bool writesFlags(const string &opcode)
+{
+    static const set<string> writers = {
+	"addb", "addl", "addq", "andl", "andq", "cmpb", "cmpl", "cmpq",
+	"comisd", "idivl", "idivq", "imull", "imulq", "negl", "negq",
+	"orl", "orq", "sahf", "sall", "salq", "sarl", "sarq", "shll",
+	"shlq", "shrl", "shrq", "subl", "subq", "testl", "testq",
+	"ucomisd", "xorl", "xorq",
+    };
+
+    return writers.count(opcode) > 0;
+}
+
+
+/*
+ * Function:	flagsDead (private)
+ *
+ * Description:	Return whether the flags after the given line are written
+ *		before they are read on every path, following a few jumps.
+ */
+
+static bool flagsDead(const Code &code, size_t i, unsigned jumps = 0)
+{
+    map<string, size_t>::const_iterator target;
+
+
+    for (i = next(code, i); i < code.lines.size(); i = next(code, i)) {
+	const Line &line = code.lines[i];
+
+	if (line.kind == LABEL)
+	    continue;
+
+	if (line.kind == DIRECTIVE || readsFlags(line.opcode))
+	    return false;
+
+	if (writesFlags(line.opcode) || line.opcode == "call"
+		|| line.opcode == "ret")
+	    return true;
+
+	if (line.opcode == "jmp") {
+	    target = code.labels.find(line.operands[0]);
+
+	    if (jumps == MAX_JUMPS || target == code.labels.end())
+		return false;
+
+	    return flagsDead(code, target->second, jumps + 1);
+	}
+    }
+
+    return false;
+}
+
+
+/*
+ * Function:	forward (private)
+ *
+ * Description:	Rule: a move that reads back what the previous move wrote
+ *		is deleted if it would copy a value onto itself, and
+ *		otherwise reads the original register or immediate.  A
+ *		value is not copied onto itself if its address used the
+ *		register that the first move wrote.
+ *
+ *		movl %ecx, -8(%ebp)		movl %ecx, -8(%ebp)
+ *		movl -8(%ebp), %ecx	=>
+ */
+
+static bool forward(Code &code, size_t i)
+{
+    Line &first = code.lines[i];
+    size_t j = next(code, i);
+    string source;
+
+
+    if (!isMove(first.opcode) || !is(code, j, first.opcode, 2))
+	return false;
+
+    Line &second = code.lines[j];
+
+    if (first.operands.size() != 2 || second.operands[0] != first.operands[1])
+	return false;
+
+    source = first.operands[0];
+
+    if (second.operands[1] == source) {
+	if (!isRegister(source) && mentions(source, first.operands[1]))
+	    return false;
+
+	erase(second);
+	return true;
+    }
+
+    if (!isRegister(source) && (source[0] != '$' || !isRegister(first.operands[1])))
+	return false;
+
+    if (source[0] == '$' && !isRegister(second.operands[1]))
+	return false;
+
+    rewrite(second, second.opcode, {source, second.operands[1]});
+    return true;
+}
+
+
+/*
+ * Function:	redundant (private)
+ *
+ * Description:	Rule: a move of a register to itself is deleted.
+ *
+ *		movl %ecx, %ecx		=>
+ */
+
+static bool redundant(Code &code, size_t i)
+{
+    Line &line = code.lines[i];
+
+
+    if (!isMove(line.opcode) || line.operands.size() != 2)
+	return false;
+
+    if (!isRegister(line.operands[0]) || line.operands[0] != line.operands[1])
+	return false;
+
+    erase(line);
+    return true;
+}
+
+
+/*
+ * Function:	fallthrough (private)
+ *
+ * Description:	Rule: a jump to a label that immediately follows it is
+ *		deleted.
+ *
+ *		jmp .L1			=>
+ *	    .L1:			    .L1:
+ */
+
+static bool fallthrough(Code &code, size_t i)
+{
+    Line &line = code.lines[i];
+    size_t j;
+
+
+    if (!isJump(line.opcode) || line.operands.size() != 1)
+	return false;
+
+    for (j = next(code, i); j < code.lines.size(); j = next(code, j)) {
+	if (code.lines[j].kind != LABEL)
+	    return false;
+
+	if (code.lines[j].opcode == line.operands[0]) {
+	    erase(line);
+	    return true;
+	}
+    }
+
+    return false;
+}
+
+
+/*
+ * Function:	thread (private)
+ *
+ * Description:	Rule: a jump to an unconditional jump goes straight to its
+ *		target.
+ *
+ *		jl .L1			jl .L2
+ *		...		=>	...
+ *	    .L1:			    .L1:
+ *		jmp .L2			jmp .L2
+ */
+
+static bool thread(Code &code, size_t i)
+{
+    map<string, size_t>::const_iterator target;
+    Line &line = code.lines[i];
+    size_t j;
+
+
+    if (!isJump(line.opcode) || line.operands.size() != 1)
+	return false;
+
+    target = code.labels.find(line.operands[0]);
+
+    if (target == code.labels.end())
+	return false;
+
+    j = instruction(code, target->second);
+
+    if (j == i || !is(code, j, "jmp", 1))
+	return false;
+
+    if (code.lines[j].operands[0] == line.operands[0])
+	return false;
+
+    rewrite(line, line.opcode, code.lines[j].operands);
+    return true;
+}
+
+
+/*
+ * Function:	invert (private)
+ *
+ * Description:	Rule: a conditional jump over an unconditional jump is
+ *		replaced by the opposite conditional jump.
+ *
+ *		jl .L1			jge .L2
+ *		jmp .L2		=>
+ *	    .L1:			    .L1:
+ */
+
+static bool invert(Code &code, size_t i)
+{
+    static const map<string, string> opposites = {
+	{"je", "jne"}, {"jne", "je"}, {"jl", "jge"}, {"jge", "jl"},
+	{"jg", "jle"}, {"jle", "jg"}, {"jb", "jae"}, {"jae", "jb"},
+	{"ja", "jbe"}, {"jbe", "ja"},
+    };
+
+    map<string, string>::const_iterator opposite;
+    Line &line = code.lines[i];
+    size_t j, k;
+
+
+    opposite = opposites.find(line.opcode);
+
+    if (opposite == opposites.end() || line.operands.size() != 1)
+	return false;
+
+    j = next(code, i);
+
+    if (!is(code, j, "jmp", 1))
+	return false;
+
+    for (k = next(code, j); k < code.lines.size(); k = next(code, k)) {
+	if (code.lines[k].kind != LABEL)
+	    return false;
+
+	if (code.lines[k].opcode == line.operands[0]) {
+	    rewrite(line, opposite->second, code.lines[j].operands);
+	    erase(code.lines[j]);
+	    return true;
+	}
+    }
+
+    return false;
+}
+
+
+/*
+ * Function:	unreachable (private)
+ *
+ * Description:	Rule: instructions after an unconditional jump or a return
+ *		and before the next label are deleted.
+ *
+ *		jmp .L1			jmp .L1
+ *		movl %ecx, %eax	=>
+ */
+
+static bool unreachable(Code &code, size_t i)
+{
+    bool deleted = false;
+    size_t j;
+
+
+    if (code.lines[i].opcode != "jmp" && code.lines[i].opcode != "ret")
+	return false;
+
+    for (j = next(code, i); j < code.lines.size(); j = next(code, j)) {
+	if (code.lines[j].kind != INSTRUCTION)
+	    break;
+
+	erase(code.lines[j]);
+	deleted = true;
+    }
+
+    return deleted;
+}
+
+
+/*
+ * Function:	unused (private)
+ *
+ * Description:	Rule: a local label that nothing refers to is deleted, so
+ *		the code around it becomes straight-line code.
+ */
+
+static bool unused(Code &code, size_t i)
+{
+    Line &line = code.lines[i];
+
+
+    if (line.kind != LABEL || line.opcode.compare(0, 2, ".L") != 0)
+	return false;
+
+    if (code.uses.count(line.opcode) > 0)
+	return false;
+
+    erase(line);
+    return true;
+}
+
+
+/*
+ * Function:	increment (private)
+ *
+ * Description:	Rule: adding or subtracting one is done by incrementing or
+ *		decrementing, which leaves the carry flag alone.
+ *
+ *		addl $1, %ecx	=>	incl %ecx
+ */
+
+static bool increment(Code &code, size_t i)
+{
+    Line &line = code.lines[i];
+    string opcode, suffix;
+    int delta;
+
+
+    if (line.kind != INSTRUCTION || line.operands.size() != 2)
+	return false;
+
+    opcode = line.opcode.substr(0, 3);
+    suffix = line.opcode.substr(3);
+
+    if ((opcode != "add" && opcode != "sub") || (suffix != "l" && suffix != "q"))
+	return false;
+
+    if (line.operands[0] == "$1")
+	delta = 1;
+    else if (line.operands[0] == "$-1")
+	delta = -1;
+    else
+	return false;
+
+    if (opcode == "sub")
+	delta = -delta;
+
+    if (!flagsDead(code, i))
+	return false;
+
+    rewrite(line, (delta > 0 ? "inc" : "dec") + suffix, {line.operands[1]});
+    return true;
+}
+
+
+/*
+ * Function:	zero (private)
+ *
+ * Description:	Rule: a register is cleared by exclusive-oring it with
+ *		itself, which is shorter than moving a zero into it.
+ *
+ *		movl $0, %ecx	=>	xorl %ecx, %ecx
+ */
+
+static bool zero(Code &code, size_t i)
+{
+    Line &line = code.lines[i];
+
+
+    if (!is(code, i, "movl", 2) || line.operands[0] != "$0")
+	return false;
+
+    if (!isRegister(line.operands[1]) || !flagsDead(code, i))
+	return false;
+
+    rewrite(line, "xorl", {line.operands[1], line.operands[1]});
+    return true;
+}
+
+
+/*
+ * Function:	identity (private)
+ *
+ * Description:	Rule: multiplying by one is deleted.
+ *
+ *		imull $1, %ecx	=>
+ */
+
+static bool identity(Code &code, size_t i)
+{
+    Line &line = code.lines[i];
+
+
+    if (line.opcode != "imull" && line.opcode != "imulq")
+	return false;
+
+    if (line.operands.size() != 2 || line.operands[0] != "$1")
+	return false;
+
+    if (!flagsDead(code, i))
+	return false;
+
+    erase(line);
+    return true;
+}
+
+
+static const Rule rules[] = {
+    {"store-load forwarding", forward},
+    {"redundant move", redundant},
+    {"jump to next label", fallthrough},
+    {"jump threading", thread},
+    {"branch inversion", invert},
+    {"unreachable code", unreachable},
+    {"unused label", unused},
+    {"add one to inc", increment},
+    {"move zero to xor", zero},
+    {"multiply by one", identity},
+};
+
+static const unsigned RULES = sizeof(rules) / sizeof(rules[0]);
+static atomic<unsigned long> hits[RULES];
+
+
+/*
+ * Function:	index (private)
+ *
+ * Description:	Record where each label is and how often each label is
+ *		referred to by an instruction.  A reference may be to the
+ *		address of a label, as in .L1(%rip).
+ */
+
+static void index(Code &code)
+{
+    code.labels.clear();
+    code.uses.clear();
+
+    for (size_t i = 0; i < code.lines.size(); i ++) {
+	const Line &line = code.lines[i];
+
+	if (line.deleted)
+	    continue;
+
+	if (line.kind == LABEL)
+	    code.labels[line.opcode] = i;
+
+	for (auto &operand : line.operands)
+	    code.uses[operand.substr(0, operand.find('('))] ++;
+    }
+}
+
+
+/*
+ * Function:	optimize
+ *
+ * Description:	Apply the rules to the given code until none applies, and
+ *		return the rewritten code.  The time spent is charged to
+ *		the given function, if any.
+ */
+
+string optimize(const string &text, const string *function)
+{
+    Timer::Scope timer(Timer::PEEPHOLE, function);
+    istringstream istr(text);
+    ostringstream ostr;
+    string line;
+    unsigned pass;
+    bool changed;
+    Code code;
+
+
+    while (getline(istr, line))
+	code.lines.push_back(parse(line));
+
+    for (pass = 0, changed = true; changed && pass < MAX_PASSES; pass ++) {
+	changed = false;
+	index(code);
+
+	for (size_t i = 0; i < code.lines.size(); i ++)
+	    for (unsigned r = 0; r < RULES; r ++) {
+		if (code.lines[i].deleted || code.lines[i].kind == COMMENT)
+		    break;
+
+		if (rules[r].apply(code, i)) {
+		    hits[r] ++;
+		    changed = true;
+		}
+	    }
+    }
+
+    for (auto &line : code.lines)
+	if (!line.deleted)
+	    ostr << write(line) << '\n';
+
+    return ostr.str();
+}
+
+
+/*
+ * Function:	reportRules
+ *
+ * Description:	Write the number of times each rule has been applied.
+ */
+
+void reportRules(ostream &ostr)
+{
+    unsigned long total = 0;
+
+
+    ostr << left << setw(24) << "peephole rule" << right << setw(10);
+    ostr << "hits" << endl;
+
+    for (unsigned r = 0; r < RULES; r ++) {
+	ostr << left << setw(24) << rules[r].name << right << setw(10);
+	ostr << hits[r] << endl;
+	total += hits[r];
+    }
+
+    ostr << left << setw(24) << "total" << right << setw(10) << total << endl;
+}
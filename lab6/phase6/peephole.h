@@ -0,0 +1,18 @@
+/*
+ * File:	peephole.h
+ *
+ * Description:	This file contains the function declarations for the
+ *		peephole optimizer for Simple C, which rewrites the code of
+ *		each function after it is generated.
+ */
+
+# ifndef PEEPHOLE_H
+# define PEEPHOLE_H
+# include <ostream>
+# include <string>
+
+std::string optimize(const std::string &code,
+		     const std::string *function = nullptr);
+void reportRules(std::ostream &ostr);
+
+# endif /* PEEPHOLE_H */
@@ -0,0 +1,141 @@
+/*
+ * File:	scopebench.cpp
+ *
+ * Description:	This file contains a microbenchmark for scopes.  For
+ *		scopes of 10, 1000, and 100000 symbols, it reports the
+ *		average cost of inserting a symbol, of finding a symbol
+ *		that is present, and of failing to find one that is not.
+ *		For comparison, the cost of a linear search of the
+ *		symbols is also reported.
+ *
+ *		Build and run with "make scopebench && ./scopebench".
+ */
+
+# include <chrono>
+# include <cstdio>
+# include <vector>
+# include "Scope.h"
+# include "tokens.h"
+
+using namespace std;
+
+static const unsigned OPERATIONS = 2000000;
+static volatile unsigned long sink;
+
+
+/*
+ * Function:	elapsed
+ *
+ * Description:	Return the number of nanoseconds since the given time.
+ */
+
+static double elapsed(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+}
+
+
+/*
+ * Function:	linear
+ *
+ * Description:	Find a symbol by searching the symbols of a scope in
+ *		order, as Scope::find once did.
+ */
+
+static Symbol *linear(const Scope *scope, const Name &name)
+{
+    for (auto symbol : scope->symbols())
+	if (name == symbol->name())
+	    return symbol;
+
+    return nullptr;
+}
+
+
+/*
+ * Function:	measure
+ *
+ * Description:	Measure and report the costs for a scope of the given size.
+ */
+
+static void measure(unsigned size)
+{
+    vector<Name> names, missing;
+    unsigned reps, sample, i, j;
+    double insert, hit, miss, scan;
+    Arena arena;
+    Scope *scope;
+
+
+    for (i = 0; i < size; i ++) {
+	names.push_back(Name("x" + to_string(i)));
+	missing.push_back(Name("y" + to_string(i)));
+    }
+
+    Arena::current = &arena;
+    reps = OPERATIONS / size > 0 ? OPERATIONS / size : 1;
+
+    /* Inserting includes allocating the symbols, as in the checker. */
+
+    auto start = chrono::steady_clock::now();
+
+    for (j = 0; j < reps; j ++) {
+	arena.reset();
+	scope = new Scope();
+
+	for (i = 0; i < size; i ++)
+	    scope->insert(new Symbol(names[i], Type(INT)));
+    }
+
+    insert = elapsed(start) / reps / size;
+
+    start = chrono::steady_clock::now();
+
+    for (j = 0; j < reps; j ++)
+	for (i = 0; i < size; i ++)
+	    sink += scope->find(names[i]) != nullptr;
+
+    hit = elapsed(start) / reps / size;
+
+    start = chrono::steady_clock::now();
+
+    for (j = 0; j < reps; j ++)
+	for (i = 0; i < size; i ++)
+	    sink += scope->find(missing[i]) != nullptr;
+
+    miss = elapsed(start) / reps / size;
+
+    /* A linear search of a large scope is too slow to do completely. */
+
+    sample = size < 1000 ? size : 1000;
+    reps = OPERATIONS / size / sample > 0 ? OPERATIONS / size / sample : 1;
+    start = chrono::steady_clock::now();
+
+    for (j = 0; j < reps; j ++)
+	for (i = 0; i < sample; i ++)
+	    sink += linear(scope, names[i * (size / sample)]) != nullptr;
+
+    scan = elapsed(start) / reps / sample;
+
+    printf("%8u %12.1f %12.1f %12.1f %12.1f\n", size, insert, hit, miss, scan);
+
+    Arena::current = &Arena::global;
+}
+
+
+/*
+ * Function:	main
+ *
+ * Description:	Run the benchmark.  Times are in nanoseconds.
+ */
+
+int main()
+{
+    printf("%8s %12s %12s %12s %12s\n", "symbols", "insert", "find", "miss", "linear");
+
+    measure(10);
+    measure(1000);
+    measure(100000);
+
+    return 0;
+}
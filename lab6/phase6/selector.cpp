@@ -0,0 +1,1334 @@
+/*
+ * File:	selector.cpp
+ *
+ * Description:	This file contains the public and private function
+ *		definitions for the instruction selector for Simple C,
+ *		which translates a procedure in SSA form into i386 code.
+ *
+ *		The procedure is first taken out of SSA form.  Each phi
+ *		instruction becomes a copy at the end of each predecessor
+ *		of its block, after an edge from a block with several
+ *		successors has been split so that the copies are only
+ *		executed along that edge.  The copies into the phis of a
+ *		block happen at once, so they are ordered such that no
+ *		value is overwritten before it is read, and a cycle of
+ *		copies is broken with a temporary.
+ *
+ *		Registers are then allocated to the integer and pointer
+ *		values by a linear scan over the blocks in reverse
+ *		postorder.  The live range of each value is found by
+ *		dataflow analysis and approximated by a single interval
+ *		from its first definition or use to its last.  A value
+ *		live across a call is given a callee-saved register, and
+ *		when no register is free, the value whose interval ends
+ *		last is spilled to the frame.  A copy is given the
+ *		register of its source if possible.  The %eax and %edx
+ *		registers are never allocated, since they are needed for
+ *		division, return values, and as scratch registers for a
+ *		single instruction.  Doubles always live in the frame,
+ *		and are computed on the x87 stack or in %xmm0.
+ *
+ *		The function is laid out with its blocks in reverse
+ *		postorder, so a jump or branch to the next block falls
+ *		through.  The prologue and epilogue are those of the code
+ *		generated directly from the tree.
+ */
+
+# include <algorithm>
+# include <cassert>
+# include <climits>
+# include <cstdlib>
+# include <set>
+# include <sstream>
+# include "generator.h"
+# include "selector.h"
+# include "Target.h"
+
+using namespace std;
+
+static const unsigned REGISTERS = 4;
+
+static const char *names[] = {"%ecx", "%ebx", "%esi", "%edi"};
+static const char *bytes[] = {"%cl", "%bl", nullptr, nullptr};
+static const bool callee[] = {false, true, true, true};
+
+static const char *integers[] = {"e", "ne", "l", "g", "le", "ge"};
+static const char *reals[] = {"e", "ne", nullptr, "a", nullptr, "ae"};
+static const char *unreals[] = {"ne", "e", nullptr, "be", nullptr, "b"};
+
+typedef vector<pair<Instruction *, Instruction *>> Copies;
+
+
+/*
+ * The state of selecting the instructions of a single procedure: where
+ * each virtual register lives, how many times it is used, the layout
+ * of the frame, and the block that follows the one being written.
+ */
+
+struct Selection {
+    Procedure &proc;
+    ostream &out;
+    vector<int> registers;
+    vector<int> slots;
+    vector<unsigned> uses;
+    bool saved[REGISTERS];
+    int offset, conversion;
+    unsigned args;
+    Label exit;
+    BasicBlock *next;
+
+    Selection(Procedure &proc, ostream &out)
+	: proc(proc), out(out), saved(), offset(proc.frame), conversion(0),
+	  args(0), next(nullptr) {}
+};
+
+
+/*
+ * Function:	integer (private)
+ *
+ * Description:	Return whether an instruction defines an integer or
+ *		pointer virtual register, which may be given a register.
+ */
+
+static bool integer(const Instruction *instruction)
+{
+    return !instruction->constant() &&
+	(instruction->kind == Instruction::INT ||
+	 instruction->kind == Instruction::PTR);
+}
+
+
+/*
+ * Function:	immediate (private)
+ *
+ * Description:	Return whether an integer or pointer value may be written
+ *		as an immediate operand.
+ */
+
+static bool immediate(const Instruction *instruction)
+{
+    return instruction->opcode == Instruction::CONST ||
+	instruction->opcode == Instruction::STRING ||
+	instruction->opcode == Instruction::GLOBAL;
+}
+
+
+/*
+ * Function:	split (private)
+ *
+ * Description:	Split each edge from a block with several successors to a
+ *		block with phi instructions by putting a new block on it.
+ */
+
+static void split(Procedure &proc)
+{
+    vector<BasicBlock *> blocks = proc.blocks;
+    BasicBlock *middle;
+    Instruction *jump;
+
+
+    for (auto block : blocks) {
+	vector<BasicBlock *> successors = block->successors();
+
+	if (successors.size() < 2)
+	    continue;
+
+	for (auto successor : successors) {
+	    if (successor->instructions[0]->opcode != Instruction::PHI)
+		continue;
+
+	    middle = proc.block();
+	    jump = proc.create(Instruction::JUMP, Instruction::NONE);
+	    jump->blocks = {successor};
+	    jump->block = middle;
+	    middle->instructions.push_back(jump);
+	    block->retarget(successor, middle);
+
+	    for (auto phi : successor->instructions)
+		if (phi->opcode == Instruction::PHI)
+		    for (auto &from : phi->blocks)
+			if (from == block)
+			    from = middle;
+	}
+    }
+
+    proc.analyze();
+}
+
+
+/*
+ * Function:	sequentialize (private)
+ *
+ * Description:	Add copies that happen at once to the end of a block,
+ *		before its terminator.  A copy is made only once no other
+ *		copy still needs the value it overwrites.  When every
+ *		remaining copy overwrites a value another needs, they form
+ *		cycles, and one value is first saved in a temporary.
+ */
+
+static void sequentialize(Procedure &proc, BasicBlock *block, Copies copies)
+{
+    vector<Instruction *> sequence;
+    Instruction *copy;
+    unsigned i, j;
+
+
+    for (i = copies.size(); i -- > 0; )
+	if (copies[i].first == copies[i].second)
+	    copies.erase(copies.begin() + i);
+
+    while (!copies.empty()) {
+	for (i = 0; i < copies.size(); i ++) {
+	    for (j = 0; j < copies.size(); j ++)
+		if (copies[j].second == copies[i].first)
+		    break;
+
+	    if (j == copies.size())
+		break;
+	}
+
+	if (i < copies.size()) {
+	    copy = proc.create(Instruction::COPY, copies[i].first->kind);
+	    copy->number = copies[i].first->number;
+	    copy->operands = {copies[i].second};
+	    copies.erase(copies.begin() + i);
+
+	} else {
+	    copy = proc.create(Instruction::COPY, copies[0].first->kind);
+	    copy->operands = {copies[0].first};
+
+	    for (auto &element : copies)
+		if (element.second == copies[0].first)
+		    element.second = copy;
+	}
+
+	copy->block = block;
+	sequence.push_back(copy);
+    }
+
+    block->instructions.insert(block->instructions.end() - 1,
+			       sequence.begin(), sequence.end());
+}
+
+
+/*
+ * Function:	destruct (private)
+ *
+ * Description:	Take a procedure out of SSA form by replacing its phi
+ *		instructions with copies.  A copy defines the same virtual
+ *		register as the phi it replaces.
+ */
+
+static void destruct(Procedure &proc)
+{
+    split(proc);
+
+    for (auto block : proc.blocks) {
+	map<BasicBlock *, Copies> copies;
+
+	while (block->instructions[0]->opcode == Instruction::PHI) {
+	    Instruction *phi = block->instructions[0];
+
+	    for (unsigned i = 0; i < phi->operands.size(); i ++)
+		copies[phi->blocks[i]].push_back({phi, phi->operands[i]});
+
+	    block->instructions.erase(block->instructions.begin());
+	}
+
+	for (auto &element : copies)
+	    sequentialize(proc, element.first, element.second);
+    }
+}
+
+
+/*
+ * Function:	align (private)
+ *
+ * Description:	Return the number of bytes necessary to align the given
+ *		offset on the stack.
+ */
+
+static int align(int offset)
+{
+    if (offset % target->stackAlignment == 0)
+	return 0;
+
+    return target->stackAlignment - (abs(offset) % target->stackAlignment);
+}
+
+
+/*
+ * Function:	allocate (private)
+ *
+ * Description:	Allocate registers and frame slots to the virtual
+ *		registers of a procedure, and lay out its frame.
+ */
+
+static void allocate(Selection &s)
+{
+    Procedure &proc = s.proc;
+    unsigned count = proc.count(), n = proc.blocks.size();
+    vector<set<unsigned>> uses(n), defs(n), in(n), out(n);
+    vector<unsigned> first(n), last(n), start(count, UINT_MAX), end(count, 0);
+    vector<Instruction *> linear, sources(count, nullptr);
+    vector<unsigned> calls, order;
+    vector<int> owners(REGISTERS, -1);
+    bool changed, convert = false;
+
+
+    /* Number the instructions and find the uses and definitions. */
+
+    s.registers.assign(count, -1);
+    s.slots.assign(count, 0);
+    s.uses.assign(count, 0);
+
+    for (unsigned b = 0; b < n; b ++) {
+	first[b] = linear.size();
+
+	for (auto instruction : proc.blocks[b]->instructions) {
+	    for (auto operand : instruction->operands) {
+		if (operand->constant())
+		    continue;
+
+		s.uses[operand->number] ++;
+
+		if (integer(operand) && !defs[b].count(operand->number))
+		    uses[b].insert(operand->number);
+	    }
+
+	    if (integer(instruction))
+		defs[b].insert(instruction->number);
+
+	    linear.push_back(instruction);
+	}
+
+	last[b] = linear.size() - 1;
+    }
+
+
+    /* Find the registers live into and out of each block. */
+
+    do {
+	changed = false;
+
+	for (unsigned b = n; b -- > 0; ) {
+	    set<unsigned> live;
+
+	    for (auto successor : proc.blocks[b]->successors())
+		live.insert(in[successor->number].begin(),
+			    in[successor->number].end());
+
+	    out[b] = live;
+
+	    for (auto reg : defs[b])
+		live.erase(reg);
+
+	    live.insert(uses[b].begin(), uses[b].end());
+
+	    if (live != in[b]) {
+		in[b] = live;
+		changed = true;
+	    }
+	}
+    } while (changed);
+
+
+    /* Compute the interval of each register. */
+
+    auto extend = [&](unsigned reg, unsigned position) {
+	start[reg] = min(start[reg], position);
+	end[reg] = max(end[reg], position);
+    };
+
+    for (unsigned b = 0; b < n; b ++) {
+	for (auto reg : in[b])
+	    extend(reg, 2 * first[b]);
+
+	for (auto reg : out[b])
+	    extend(reg, 2 * last[b] + 1);
+    }
+
+    for (unsigned i = 0; i < linear.size(); i ++) {
+	Instruction *instruction = linear[i];
+
+	for (auto operand : instruction->operands)
+	    if (integer(operand))
+		extend(operand->number, 2 * i);
+
+	if (integer(instruction)) {
+	    extend(instruction->number, 2 * i + 1);
+
+	    if (instruction->opcode == Instruction::COPY &&
+		    integer(instruction->operands[0]))
+		sources[instruction->number] = instruction->operands[0];
+
+	}
+
+	if (instruction->opcode == Instruction::CALL)
+	    calls.push_back(i);
+
+	if (instruction->opcode == Instruction::ITOF ||
+		instruction->opcode == Instruction::FTOI)
+	    convert = true;
+    }
+
+    for (unsigned reg = 0; reg < count; reg ++)
+	if (start[reg] != UINT_MAX)
+	    order.push_back(reg);
+
+    sort(order.begin(), order.end(), [&](unsigned a, unsigned b) {
+	return start[a] < start[b] || (start[a] == start[b] && a < b);
+    });
+
+
+    /* Allocate the registers in order of their intervals. */
+
+    for (auto reg : order) {
+	bool crosses = false;
+	int chosen = -1, victim = -1;
+
+	for (unsigned r = 0; r < REGISTERS; r ++)
+	    if (owners[r] != -1 && end[owners[r]] < start[reg])
+		owners[r] = -1;
+
+	for (auto call : calls)
+	    if (start[reg] < 2 * call && end[reg] > 2 * call + 1)
+		crosses = true;
+
+	if (sources[reg] != nullptr) {
+	    int hint = s.registers[sources[reg]->number];
+
+	    if (hint != -1 && owners[hint] == -1 && (!crosses || callee[hint]))
+		chosen = hint;
+	}
+
+	for (unsigned r = 0; r < REGISTERS && chosen == -1; r ++)
+	    if (owners[r] == -1 && (!crosses || callee[r]))
+		chosen = r;
+
+	if (chosen == -1) {
+	    for (unsigned r = 0; r < REGISTERS; r ++)
+		if ((!crosses || callee[r]) &&
+			(victim == -1 || end[owners[r]] > end[owners[victim]]))
+		    victim = r;
+
+	    if (victim == -1 || end[owners[victim]] <= end[reg])
+		continue;
+
+	    s.registers[owners[victim]] = -1;
+	    chosen = victim;
+	}
+
+	owners[chosen] = reg;
+	s.registers[reg] = chosen;
+	s.saved[chosen] = s.saved[chosen] || callee[chosen];
+    }
+
+
+    /* Lay out the frame. */
+
+    for (auto instruction : linear)
+	if (!instruction->constant() && instruction->kind != Instruction::NONE
+		&& s.registers[instruction->number] == -1
+		&& s.slots[instruction->number] == 0) {
+	    if (instruction->kind == Instruction::REAL)
+		s.offset -= target->sizeofDouble;
+	    else
+		s.offset -= target->sizeofRegister;
+
+	    s.slots[instruction->number] = s.offset;
+	}
+
+    if (convert) {
+	s.offset -= target->sizeofRegister;
+	s.conversion = s.offset;
+    }
+
+    for (auto instruction : linear)
+	if (instruction->opcode == Instruction::CALL) {
+	    unsigned size = 0;
+
+	    for (auto arg : instruction->operands)
+		size += arg->kind == Instruction::REAL ? target->sizeofDouble
+		    : target->sizeofRegister;
+
+	    s.args = max(s.args, size);
+	}
+}
+
+
+/*
+ * Function:	location (private)
+ *
+ * Description:	Return where a virtual register lives.
+ */
+
+static string location(Selection &s, const Instruction *instruction)
+{
+    stringstream ss;
+
+
+    if (s.registers[instruction->number] != -1)
+	return names[s.registers[instruction->number]];
+
+    ss << s.slots[instruction->number] << "(%ebp)";
+    return ss.str();
+}
+
+
+/*
+ * Function:	enregistered (private)
+ *
+ * Description:	Return whether a value lives in a register.
+ */
+
+static bool enregistered(Selection &s, const Instruction *instruction)
+{
+    return !instruction->constant() && s.registers[instruction->number] != -1;
+}
+
+
+/*
+ * Function:	operand (private)
+ *
+ * Description:	Return the operand for reading a value.  Integer and
+ *		pointer constants are immediates, and a double is in
+ *		memory.  The address of a local is not an operand.
+ */
+
+static string operand(Selection &s, const Instruction *instruction)
+{
+    stringstream ss;
+
+
+    switch (instruction->opcode) {
+    case Instruction::CONST:
+	ss << "$" << instruction->value;
+	break;
+
+    case Instruction::FCONST:
+	constant(ss, instruction->real);
+	break;
+
+    case Instruction::STRING:
+	ss << "$";
+	constant(ss, instruction->text);
+	break;
+
+    case Instruction::GLOBAL:
+	ss << "$" << target->globalPrefix << instruction->symbol->name();
+	break;
+
+    default:
+	assert(instruction->opcode != Instruction::FRAME);
+	return location(s, instruction);
+    }
+
+    return ss.str();
+}
+
+
+/*
+ * Function:	load (private)
+ *
+ * Description:	Load an integer or pointer value into a register.
+ */
+
+static void load(Selection &s, const Instruction *instruction,
+		 const string &reg)
+{
+    string source;
+
+
+    if (instruction->opcode == Instruction::FRAME)
+	s.out << "\tleal\t" << instruction->symbol->offset << "(%ebp), " << reg << '\n';
+    else if ((source = operand(s, instruction)) != reg)
+	s.out << "\tmovl\t" << source << ", " << reg << '\n';
+}
+
+
+/*
+ * Function:	source (private)
+ *
+ * Description:	Return the operand for reading an integer or pointer
+ *		value, computing the address of a local into the given
+ *		scratch register.
+ */
+
+static string source(Selection &s, const Instruction *instruction,
+		     const string &scratch)
+{
+    if (instruction->opcode != Instruction::FRAME)
+	return operand(s, instruction);
+
+    load(s, instruction, scratch);
+    return scratch;
+}
+
+
+/*
+ * Function:	store (private)
+ *
+ * Description:	Store the value in a register into a virtual register.
+ */
+
+static void store(Selection &s, const Instruction *instruction,
+		  const string &reg)
+{
+    string dest = location(s, instruction);
+
+
+    if (dest != reg)
+	s.out << "\tmovl\t" << reg << ", " << dest << '\n';
+}
+
+
+/*
+ * Function:	assign (private)
+ *
+ * Description:	Copy an integer or pointer value into a virtual register.
+ */
+
+static void assign(Selection &s, const Instruction *dest,
+		   const Instruction *value)
+{
+    string to = location(s, dest);
+
+
+    if (enregistered(s, dest))
+	load(s, value, to);
+    else if (immediate(value) || enregistered(s, value))
+	s.out << "\tmovl\t" << operand(s, value) << ", " << to << '\n';
+    else if (value->opcode == Instruction::FRAME || location(s, value) != to) {
+	load(s, value, "%eax");
+	store(s, dest, "%eax");
+    }
+}
+
+
+/*
+ * Function:	address (private)
+ *
+ * Description:	Return the memory operand at the given address, loading a
+ *		spilled pointer into the given scratch register.
+ */
+
+static string address(Selection &s, const Instruction *pointer,
+		      const string &scratch)
+{
+    stringstream ss;
+
+
+    switch (pointer->opcode) {
+    case Instruction::CONST:
+	ss << pointer->value;
+	break;
+
+    case Instruction::STRING:
+	constant(ss, pointer->text);
+	break;
+
+    case Instruction::GLOBAL:
+	ss << target->globalPrefix << pointer->symbol->name();
+	break;
+
+    case Instruction::FRAME:
+	ss << pointer->symbol->offset << "(%ebp)";
+	break;
+
+    default:
+	if (!enregistered(s, pointer)) {
+	    load(s, pointer, scratch);
+	    ss << "(" << scratch << ")";
+	} else
+	    ss << "(" << location(s, pointer) << ")";
+    }
+
+    return ss.str();
+}
+
+
+/*
+ * Function:	fload (private)
+ *
+ * Description:	Load a double onto the x87 stack or into %xmm0.
+ */
+
+static void fload(Selection &s, const Instruction *instruction)
+{
+    if (sse)
+	s.out << "\tmovsd\t" << operand(s, instruction) << ", %xmm0\n";
+    else
+	s.out << "\tfldl\t" << operand(s, instruction) << '\n';
+}
+
+
+/*
+ * Function:	fstore (private)
+ *
+ * Description:	Store the double on the x87 stack or in %xmm0.
+ */
+
+static void fstore(Selection &s, const string &dest)
+{
+    if (sse)
+	s.out << "\tmovsd\t%xmm0, " << dest << '\n';
+    else
+	s.out << "\tfstpl\t" << dest << '\n';
+}
+
+
+/*
+ * Function:	compare (private)
+ *
+ * Description:	Compare the operands of a comparison or branch and return
+ *		the suffix of the jump or set instruction that tests the
+ *		condition, or the opposite condition if negated.  Doubles
+ *		are compared as the tree code generator compares them: an
+ *		unordered result sets the zero, parity, and carry flags,
+ *		so less-than and less-or-equal are tested with the
+ *		operands swapped, the opposite of a condition is taken on
+ *		the flags rather than on the condition, and equality of
+ *		doubles must also test the parity flag.
+ */
+
+static string compare(Selection &s, const Instruction *instruction,
+		      bool negated)
+{
+    Instruction::Condition condition = instruction->condition;
+    const Instruction *left = instruction->operands[0];
+    const Instruction *right = instruction->operands[1];
+    string first, second;
+
+
+    if (left->kind == Instruction::REAL) {
+	if (condition == Instruction::LT || condition == Instruction::LE) {
+	    swap(left, right);
+	    condition = Instruction::swap(condition);
+	}
+
+	fload(s, left);
+
+	if (sse)
+	    s.out << "\tucomisd\t" << operand(s, right) << ", %xmm0\n";
+	else {
+	    s.out << "\tfcompl\t" << operand(s, right) << '\n';
+	    s.out << "\tfnstsw\t%ax\n";
+	    s.out << "\tsahf\t\n";
+	}
+
+	return negated ? unreals[condition] : reals[condition];
+    }
+
+    if (negated)
+	condition = Instruction::negate(condition);
+
+    if (left->constant() && !right->constant()) {
+	swap(left, right);
+	condition = Instruction::swap(condition);
+    }
+
+    second = source(s, right, "%edx");
+
+    if (enregistered(s, left) ||
+	    (!left->constant() && (immediate(right) || enregistered(s, right))))
+	first = location(s, left);
+    else {
+	load(s, left, "%eax");
+	first = "%eax";
+    }
+
+    s.out << "\tcmpl\t" << second << ", " << first << '\n';
+    return integers[condition];
+}
+
+
+/*
+ * Function:	test (private)
+ *
+ * Description:	Set %al to the value of a comparison or its opposite.  An
+ *		unordered comparison of doubles is unequal.
+ */
+
+static void test(Selection &s, const Instruction *instruction, bool negated)
+{
+    bool real = instruction->operands[0]->kind == Instruction::REAL;
+    string value = compare(s, instruction, negated);
+
+
+    s.out << "\tset" << value << "\t%al\n";
+
+    if (real && value == "e")
+	s.out << "\tsetnp\t%ah\n\tandb\t%ah, %al\n";
+    else if (real && value == "ne")
+	s.out << "\tsetp\t%ah\n\torb\t%ah, %al\n";
+}
+
+
+/*
+ * Function:	branch (private)
+ *
+ * Description:	Jump to the given block if a comparison, or its opposite,
+ *		holds, and otherwise go on to the other block.  An
+ *		unordered comparison of doubles is unequal.
+ */
+
+static void branch(Selection &s, const Instruction *instruction, bool negated,
+		   const BasicBlock *target, const BasicBlock *other)
+{
+    bool real = instruction->operands[0]->kind == Instruction::REAL;
+    string value = compare(s, instruction, negated);
+
+
+    if (real && value == "e")
+	s.out << "\tjp\t" << other->label << '\n';
+
+    s.out << "\tj" << value << "\t" << target->label << '\n';
+
+    if (real && value == "ne")
+	s.out << "\tjp\t" << target->label << '\n';
+}
+
+
+/*
+ * Function:	arithmetic (private)
+ *
+ * Description:	Select the instructions for integer addition, subtraction,
+ *		and multiplication.  The result is computed in its own
+ *		register if it has one and it does not hold the right
+ *		operand, and in %eax otherwise.
+ */
+
+static void arithmetic(Selection &s, const Instruction *instruction,
+		       const char *opcode, bool commutative)
+{
+    const Instruction *left = instruction->operands[0];
+    const Instruction *right = instruction->operands[1];
+    string dest = location(s, instruction), other;
+
+
+    if (enregistered(s, instruction) && enregistered(s, right) &&
+	    location(s, right) == dest && commutative) {
+	other = source(s, left, "%edx");
+	s.out << "\t" << opcode << "\t" << other << ", " << dest << '\n';
+
+    } else if (enregistered(s, instruction) && (!enregistered(s, right) ||
+	    location(s, right) != dest)) {
+	load(s, left, dest);
+	other = source(s, right, "%edx");
+	s.out << "\t" << opcode << "\t" << other << ", " << dest << '\n';
+
+    } else {
+	load(s, left, "%eax");
+	other = source(s, right, "%edx");
+	s.out << "\t" << opcode << "\t" << other << ", %eax\n";
+	store(s, instruction, "%eax");
+    }
+}
+
+
+/*
+ * Function:	multiply (private)
+ *
+ * Description:	Select the instructions for an integer multiplication by a
+ *		constant.  A power of two times three, five, or nine is an
+ *		lea and perhaps a shift, and any other constant is left to
+ *		imull, whose three-operand form needs no copy.
+ */
+
+static void multiply(Selection &s, const Instruction *instruction)
+{
+    const Instruction *left = instruction->operands[0];
+    int factor = instruction->operands[1]->value, odd = factor;
+    string dest = enregistered(s, instruction) ? location(s, instruction) : "%eax";
+    unsigned shift = 0;
+
+
+    while (odd > 0 && (odd & 1) == 0) {
+	odd >>= 1;
+	shift ++;
+    }
+
+    if (odd == 3 || odd == 5 || odd == 9) {
+	load(s, left, dest);
+	s.out << "\tleal\t(" << dest << "," << dest << "," << odd - 1 << "), " << dest << '\n';
+
+	if (shift > 0)
+	    s.out << "\tsall\t$" << shift << ", " << dest << '\n';
+    } else
+	s.out << "\timull\t$" << factor << ", " << location(s, left) << ", " << dest << '\n';
+
+    store(s, instruction, dest);
+}
+
+
+/*
+ * Function:	shift (private)
+ *
+ * Description:	Select the instructions for a shift.  A shift by a
+ *		variable amount needs the amount in %cl, so %ecx is saved
+ *		in %edx while it is used.
+ */
+
+static void shift(Selection &s, const Instruction *instruction,
+		  const char *opcode)
+{
+    const Instruction *left = instruction->operands[0];
+    const Instruction *right = instruction->operands[1];
+    string dest = location(s, instruction);
+
+
+    if (right->opcode == Instruction::CONST) {
+	if (enregistered(s, instruction)) {
+	    load(s, left, dest);
+	    s.out << "\t" << opcode << "\t$" << (right->value & 31) << ", " << dest << '\n';
+	} else {
+	    load(s, left, "%eax");
+	    s.out << "\t" << opcode << "\t$" << (right->value & 31) << ", %eax\n";
+	    store(s, instruction, "%eax");
+	}
+
+    } else {
+	load(s, left, "%eax");
+	s.out << "\tmovl\t%ecx, %edx\n";
+	load(s, right, "%ecx");
+	s.out << "\t" << opcode << "\t%cl, %eax\n";
+	s.out << "\tmovl\t%edx, %ecx\n";
+	store(s, instruction, "%eax");
+    }
+}
+
+
+/*
+ * Function:	divide (private)
+ *
+ * Description:	Select the instructions for a division or remainder.  A
+ *		division by a constant is done without idiv.  Otherwise
+ *		the divisor cannot be an immediate, so a constant one is
+ *		pushed on the stack.
+ */
+
+static void divide(Selection &s, const Instruction *instruction,
+		   const char *result)
+{
+    const Instruction *left = instruction->operands[0];
+    const Instruction *right = instruction->operands[1];
+
+
+    if (right->opcode == Instruction::CONST && right->value != 0 &&
+	    !left->constant()) {
+	divide(s.out, location(s, left), right->value,
+	       instruction->opcode == Instruction::REM);
+	store(s, instruction, result);
+	return;
+    }
+
+    load(s, left, "%eax");
+    s.out << "\tcltd\t\n";
+
+    if (immediate(right)) {
+	s.out << "\tpushl\t" << operand(s, right) << '\n';
+	s.out << "\tidivl\t(%esp)\n";
+	s.out << "\taddl\t$4, %esp\n";
+    } else
+	s.out << "\tidivl\t" << location(s, right) << '\n';
+
+    store(s, instruction, result);
+}
+
+
+/*
+ * Function:	real (private)
+ *
+ * Description:	Select the instructions for arithmetic on doubles.
+ */
+
+static void real(Selection &s, const Instruction *instruction,
+		 const char *opcode)
+{
+    fload(s, instruction->operands[0]);
+
+    if (sse)
+	s.out << "\t" << opcode << "sd\t" << operand(s, instruction->operands[1]) << ", %xmm0\n";
+    else
+	s.out << "\tf" << opcode << "l\t" << operand(s, instruction->operands[1]) << '\n';
+
+    fstore(s, location(s, instruction));
+}
+
+
+/*
+ * Function:	extend (private)
+ *
+ * Description:	Sign-extend the low byte of a value into a virtual
+ *		register.
+ */
+
+static void extend(Selection &s, const Instruction *instruction,
+		   const Instruction *value)
+{
+    int reg = enregistered(s, value) ? s.registers[value->number] : -1;
+    string dest = location(s, instruction);
+
+
+    if (reg != -1 && bytes[reg] != nullptr && enregistered(s, instruction))
+	s.out << "\tmovsbl\t" << bytes[reg] << ", " << dest << '\n';
+    else {
+	load(s, value, "%eax");
+
+	if (enregistered(s, instruction))
+	    s.out << "\tmovsbl\t%al, " << dest << '\n';
+	else {
+	    s.out << "\tmovsbl\t%al, %eax\n";
+	    store(s, instruction, "%eax");
+	}
+    }
+}
+
+
+/*
+ * Function:	call (private)
+ *
+ * Description:	Select the instructions for a function call.  The
+ *		arguments are written to the bottom of the frame, and a
+ *		double result is returned on the x87 stack.
+ */
+
+static void call(Selection &s, const Instruction *instruction)
+{
+    unsigned offset = 0;
+
+
+    for (auto arg : instruction->operands) {
+	if (arg->kind == Instruction::REAL) {
+	    fload(s, arg);
+	    s.out << "\t" << (sse ? "movsd\t%xmm0, " : "fstpl\t");
+	    s.out << offset << "(%esp)\n";
+	    offset += target->sizeofDouble;
+	    continue;
+	}
+
+	if (immediate(arg) || enregistered(s, arg))
+	    s.out << "\tmovl\t" << operand(s, arg) << ", " << offset << "(%esp)\n";
+	else {
+	    load(s, arg, "%eax");
+	    s.out << "\tmovl\t%eax, " << offset << "(%esp)\n";
+	}
+
+	offset += target->sizeofRegister;
+    }
+
+    s.out << "\tcall\t" << target->globalPrefix << instruction->symbol->name() << '\n';
+
+    if (instruction->kind == Instruction::REAL)
+	s.out << "\tfstpl\t" << location(s, instruction) << '\n';
+    else if (s.uses[instruction->number] == 0)
+	return;
+    else if (instruction->size == 1 && enregistered(s, instruction))
+	s.out << "\tmovsbl\t%al, " << location(s, instruction) << '\n';
+    else if (instruction->size == 1) {
+	s.out << "\tmovsbl\t%al, %eax\n";
+	store(s, instruction, "%eax");
+    } else
+	store(s, instruction, "%eax");
+}
+
+
+/*
+ * Function:	translate (private)
+ *
+ * Description:	Select the instructions for a single instruction.
+ */
+
+static void translate(Selection &s, const Instruction *instruction)
+{
+    const vector<Instruction *> &operands = instruction->operands;
+    string dest, from, to, value;
+    int reg;
+
+
+    switch (instruction->opcode) {
+    case Instruction::ADD:
+	if (instruction->kind == Instruction::REAL)
+	    real(s, instruction, "add");
+	else
+	    arithmetic(s, instruction, "addl", true);
+
+	break;
+
+    case Instruction::SUB:
+	if (instruction->kind == Instruction::REAL)
+	    real(s, instruction, "sub");
+	else
+	    arithmetic(s, instruction, "subl", false);
+
+	break;
+
+    case Instruction::MUL:
+	if (instruction->kind == Instruction::REAL)
+	    real(s, instruction, "mul");
+	else if (operands[1]->opcode == Instruction::CONST && !operands[0]->constant())
+	    multiply(s, instruction);
+	else
+	    arithmetic(s, instruction, "imull", true);
+
+	break;
+
+    case Instruction::DIV:
+	if (instruction->kind == Instruction::REAL)
+	    real(s, instruction, "div");
+	else
+	    divide(s, instruction, "%eax");
+
+	break;
+
+    case Instruction::REM:
+	divide(s, instruction, "%edx");
+	break;
+
+    case Instruction::NEG:
+	if (instruction->kind == Instruction::REAL) {
+	    fload(s, operands[0]);
+
+	    if (sse) {
+		s.out << "\tmulsd\t";
+		constant(s.out, -1);
+		s.out << ", %xmm0\n";
+	    } else
+		s.out << "\tfchs\t\n";
+
+	    fstore(s, location(s, instruction));
+
+	} else if (enregistered(s, instruction)) {
+	    dest = location(s, instruction);
+	    load(s, operands[0], dest);
+	    s.out << "\tnegl\t" << dest << '\n';
+
+	} else {
+	    load(s, operands[0], "%eax");
+	    s.out << "\tnegl\t%eax\n";
+	    store(s, instruction, "%eax");
+	}
+
+	break;
+
+    case Instruction::SHL:
+	shift(s, instruction, "sall");
+	break;
+
+    case Instruction::SAR:
+	shift(s, instruction, "sarl");
+	break;
+
+    case Instruction::CMP:
+	test(s, instruction, false);
+	s.out << "\tmovzbl\t%al, %eax\n";
+	store(s, instruction, "%eax");
+	break;
+
+    case Instruction::EXTEND:
+	extend(s, instruction, operands[0]);
+	break;
+
+    case Instruction::ITOF:
+	if (sse) {
+	    if (immediate(operands[0])) {
+		load(s, operands[0], "%eax");
+		s.out << "\tcvtsi2sdl\t%eax, %xmm0\n";
+	    } else
+		s.out << "\tcvtsi2sdl\t" << location(s, operands[0]) << ", %xmm0\n";
+
+	} else if (enregistered(s, operands[0]) || immediate(operands[0])) {
+	    s.out << "\tmovl\t" << operand(s, operands[0]) << ", " << s.conversion << "(%ebp)\n";
+	    s.out << "\tfildl\t" << s.conversion << "(%ebp)\n";
+
+	} else
+	    s.out << "\tfildl\t" << location(s, operands[0]) << '\n';
+
+	fstore(s, location(s, instruction));
+	break;
+
+    case Instruction::FTOI:
+	dest = enregistered(s, instruction) ? location(s, instruction) : "%eax";
+
+	if (sse)
+	    s.out << "\tcvttsd2si\t" << operand(s, operands[0]) << ", " << dest << '\n';
+	else {
+	    fload(s, operands[0]);
+	    s.out << "\tfisttpl\t" << s.conversion << "(%ebp)\n";
+	    s.out << "\tmovl\t" << s.conversion << "(%ebp), " << dest << '\n';
+	}
+
+	store(s, instruction, dest);
+	break;
+
+    case Instruction::LOAD:
+	if (instruction->kind == Instruction::REAL) {
+	    from = address(s, operands[0], "%edx");
+	    s.out << "\t" << (sse ? "movsd\t" : "fldl\t") << from;
+	    s.out << (sse ? ", %xmm0\n" : "\n");
+	    fstore(s, location(s, instruction));
+	    break;
+	}
+
+	dest = enregistered(s, instruction) ? location(s, instruction) : "%eax";
+	from = address(s, operands[0], "%edx");
+	s.out << "\t" << (instruction->size == 1 ? "movsbl" : "movl") << "\t";
+	s.out << from << ", " << dest << '\n';
+	store(s, instruction, dest);
+	break;
+
+    case Instruction::STORE:
+	if (operands[1]->kind == Instruction::REAL) {
+	    fload(s, operands[1]);
+	    to = address(s, operands[0], "%edx");
+	    fstore(s, to);
+
+	} else if (instruction->size == 1) {
+	    reg = enregistered(s, operands[1]) ? s.registers[operands[1]->number] : -1;
+
+	    if (operands[1]->opcode == Instruction::CONST) {
+		stringstream ss;
+		ss << "$" << (int) (signed char) operands[1]->value;
+		value = ss.str();
+	    } else if (reg != -1 && bytes[reg] != nullptr)
+		value = bytes[reg];
+	    else {
+		load(s, operands[1], "%eax");
+		value = "%al";
+	    }
+
+	    to = address(s, operands[0], "%edx");
+	    s.out << "\tmovb\t" << value << ", " << to << '\n';
+
+	} else {
+	    if (immediate(operands[1]) || enregistered(s, operands[1]))
+		value = operand(s, operands[1]);
+	    else {
+		load(s, operands[1], "%eax");
+		value = "%eax";
+	    }
+
+	    to = address(s, operands[0], "%edx");
+	    s.out << "\tmovl\t" << value << ", " << to << '\n';
+	}
+
+	break;
+
+    case Instruction::CALL:
+	call(s, instruction);
+	break;
+
+    case Instruction::COPY:
+	if (instruction->kind != Instruction::REAL)
+	    assign(s, instruction, operands[0]);
+	else if (operand(s, operands[0]) != location(s, instruction)) {
+	    fload(s, operands[0]);
+	    fstore(s, location(s, instruction));
+	}
+
+	break;
+
+    case Instruction::JUMP:
+	if (instruction->blocks[0] != s.next)
+	    s.out << "\tjmp\t" << instruction->blocks[0]->label << '\n';
+
+	break;
+
+    case Instruction::BRANCH:
+	if (instruction->blocks[0] == s.next)
+	    branch(s, instruction, true, instruction->blocks[1], instruction->blocks[0]);
+	else {
+	    branch(s, instruction, false, instruction->blocks[0], instruction->blocks[1]);
+
+	    if (instruction->blocks[1] != s.next)
+		s.out << "\tjmp\t" << instruction->blocks[1]->label << '\n';
+	}
+
+	break;
+
+    case Instruction::RETURN:
+	if (!operands.empty()) {
+	    if (operands[0]->kind == Instruction::REAL)
+		s.out << "\tfldl\t" << operand(s, operands[0]) << '\n';
+	    else
+		load(s, operands[0], "%eax");
+	}
+
+	if (s.next != nullptr)
+	    s.out << "\tjmp\t" << s.exit << '\n';
+
+	break;
+
+    default:
+	assert(false);
+    }
+}
+
+
+/*
+ * Function:	selectInstructions
+ *
+ * Description:	Translate a procedure into i386 code, writing it to the
+ *		given stream.  The procedure is taken out of SSA form in
+ *		the process.
+ */
+
+void selectInstructions(Procedure &proc, ostream &out)
+{
+    Selection s(proc, out);
+    const string &name = proc.function->name().str();
+    vector<int> slots(REGISTERS);
+
+
+    destruct(proc);
+    allocate(s);
+
+    for (unsigned r = 0; r < REGISTERS; r ++)
+	if (s.saved[r]) {
+	    s.offset -= target->sizeofRegister;
+	    slots[r] = s.offset;
+	}
+
+    s.offset -= s.args;
+    s.offset -= align(s.offset - target->sizeofRegister * 2);
+
+
+    /* Write the prologue. */
+
+    out << target->globalPrefix << name << ":\n";
+    out << "\tpushl\t%ebp\n";
+    out << "\tmovl\t%esp, %ebp\n";
+    out << "\tsubl\t$" << name << ".size, %esp\n";
+
+    for (unsigned r = 0; r < REGISTERS; r ++)
+	if (s.saved[r])
+	    out << "\tmovl\t" << names[r] << ", " << slots[r] << "(%ebp)\n";
+
+
+    /* Write the body. */
+
+    for (unsigned b = 0; b < proc.blocks.size(); b ++) {
+	s.next = b + 1 < proc.blocks.size() ? proc.blocks[b + 1] : nullptr;
+	out << proc.blocks[b]->label << ":\n";
+
+	for (auto instruction : proc.blocks[b]->instructions)
+	    translate(s, instruction);
+    }
+
+
+    /* Write the epilogue. */
+
+    out << s.exit << ": \n";
+
+    for (unsigned r = 0; r < REGISTERS; r ++)
+	if (s.saved[r])
+	    out << "\tmovl\t" << slots[r] << "(%ebp), " << names[r] << '\n';
+
+    out << "\tmovl\t%ebp, %esp\n";
+    out << "\tpopl\t%ebp\n";
+    out << "\tret\n\n";
+
+    out << "\t.set\t" << name << ".size, " << -s.offset << '\n';
+    out << "\t.globl\t" << target->globalPrefix << name << "\n\n";
+}
@@ -0,0 +1,16 @@
+/*
+ * File:	selector.h
+ *
+ * Description:	This file contains the function declarations for the
+ *		instruction selector for Simple C, which translates the
+ *		intermediate code of a function into i386 assembly code.
+ */
+
+# ifndef SELECTOR_H
+# define SELECTOR_H
+# include <ostream>
+# include "IR.h"
+
+void selectInstructions(Procedure &proc, std::ostream &out);
+
+# endif /* SELECTOR_H */